@@ -33,6 +33,9 @@ public:
 
 	UPROPERTY(AssetRegistrySearchable)
 	int32 AssetVersion;
+
+	/** Seconds spent in each compile phase of the last compile, in order. Not serialized. */
+	TArray<TPair<FString, double>> LastCompilePhaseTimings;
 };
 
 
@@ -21,6 +21,7 @@
 #include "Graph/Nodes/SMGraphNode_ConduitNode.h"
 #include "Graph/Nodes/SMGraphNode_StateMachineParentNode.h"
 #include "Utilities/SMVersionUtils.h"
+#include "SMInstance.h"
 
 
 #define LOCTEXT_NAMESPACE "SMEditor"
@@ -28,12 +29,14 @@
 
 FSMBlueprintEditor::FOnCreateGraphEditorCommands FSMBlueprintEditor::OnCreateGraphEditorCommandsEvent;
 
-FSMBlueprintEditor::FSMBlueprintEditor(): SelectedPropertyNode(nullptr)
+FSMBlueprintEditor::FSMBlueprintEditor(): SelectedPropertyNode(nullptr), RuntimeGuidNodesGeneration(0)
 {
 }
 
 FSMBlueprintEditor::~FSMBlueprintEditor()
 {
+	StopRecordingDebugEvents();
+
 	if (LoadedBlueprint.IsValid() && OnDebugObjectSetHandle.IsValid())
 	{
 		LoadedBlueprint->OnSetObjectBeingDebugged().Remove(OnDebugObjectSetHandle);
@@ -304,6 +307,7 @@ void FSMBlueprintEditor::OnDebugObjectSet(UObject* Object)
 		return;
 	}
 
+	USMGraphNode_Base::InvalidateDebugNodeCaches();
 	ResetBlueprintDebugStates();
 }
 
@@ -320,6 +324,95 @@ void FSMBlueprintEditor::ResetBlueprintDebugStates()
 	}
 }
 
+void FSMBlueprintEditor::Tick(float DeltaTime)
+{
+	FBlueprintEditor::Tick(DeltaTime);
+
+	DrainDebugEvents();
+}
+
+void FSMBlueprintEditor::DrainDebugEvents()
+{
+	USMInstance* DebugInstance = LoadedBlueprint.IsValid() ? Cast<USMInstance>(LoadedBlueprint->GetObjectBeingDebugged()) : nullptr;
+	if (DebugInstance != DebugEventInstance.Get())
+	{
+		StopRecordingDebugEvents();
+
+		// Other editors may be consuming events from the same instance, such as when debugging a parent graph.
+		if (DebugInstance && DebugInstance->StartRecordingDebugEvents(this))
+		{
+			DebugEventInstance = DebugInstance;
+			ResetBlueprintDebugStates();
+		}
+	}
+
+	if (!DebugEventInstance.IsValid())
+	{
+		return;
+	}
+
+	DebugEventInstance->GetDebugEventBuffer().Drain(this, [&](const FSMDebugEvent& Event)
+	{
+		USMGraphNode_Base* GraphNode = FindGraphNodeByRuntimeGuid(Event.NodeGuid);
+		if (GraphNode && !GraphNode->IsDisplayingTrace())
+		{
+			GraphNode->OnDebugEvent(Event);
+		}
+	});
+}
+
+USMGraphNode_Base* FSMBlueprintEditor::FindGraphNodeByRuntimeGuid(const FGuid& NodeGuid)
+{
+	if (!LoadedBlueprint.IsValid())
+	{
+		return nullptr;
+	}
+
+	if (RuntimeGuidNodesGeneration != USMGraphNode_Base::GetDebugNodeCacheGeneration() || RuntimeGuidNodes.Num() == 0)
+	{
+		RuntimeGuidNodes.Reset();
+		RuntimeGuidNodesGeneration = USMGraphNode_Base::GetDebugNodeCacheGeneration();
+
+		TArray<USMGraphNode_Base*> GraphNodes;
+		FSMBlueprintEditorUtils::GetAllNodesOfClassNested<USMGraphNode_Base>(LoadedBlueprint.Get(), GraphNodes);
+		for (USMGraphNode_Base* GraphNode : GraphNodes)
+		{
+			if (const FSMNode_Base* RuntimeNode = GraphNode->FindRuntimeNode())
+			{
+				RuntimeGuidNodes.Add(RuntimeNode->GetNodeGuid(), GraphNode);
+			}
+		}
+	}
+
+	const TWeakObjectPtr<USMGraphNode_Base>* GraphNode = RuntimeGuidNodes.Find(NodeGuid);
+	return GraphNode ? GraphNode->Get() : nullptr;
+}
+
+void FSMBlueprintEditor::ClearTraceDisplay()
+{
+	if (!LoadedBlueprint.IsValid())
+	{
+		return;
+	}
+
+	TArray<USMGraphNode_Base*> GraphNodes;
+	FSMBlueprintEditorUtils::GetAllNodesOfClassNested<USMGraphNode_Base>(LoadedBlueprint.Get(), GraphNodes);
+	for (USMGraphNode_Base* GraphNode : GraphNodes)
+	{
+		GraphNode->ClearTraceDisplayState();
+	}
+}
+
+void FSMBlueprintEditor::StopRecordingDebugEvents()
+{
+	if (USMInstance* Instance = DebugEventInstance.Get())
+	{
+		Instance->StopRecordingDebugEvents(this);
+	}
+
+	DebugEventInstance.Reset();
+}
+
 void FSMBlueprintEditor::OnActiveTabChanged(TSharedPtr<SDockTab> PreviouslyActive, TSharedPtr<SDockTab> NewlyActivated)
 {
 	if (!NewlyActivated.IsValid())
@@ -29,8 +29,18 @@ public:
 	virtual void RefreshEditors(ERefreshBlueprintEditorReason::Type Reason /** = ERefreshBlueprintEditorReason::UnknownReason */) override;
 	// ~FBlueprintEditor
 
+	// FTickableEditorObject
+	virtual void Tick(float DeltaTime) override;
+	// ~FTickableEditorObject
+
 	void CloseInvalidTabs();
 
+	/** The graph node representing a runtime node. Only nodes which have been compiled can be found. */
+	class USMGraphNode_Base* FindGraphNodeByRuntimeGuid(const FGuid& NodeGuid);
+
+	/** Return all graph nodes to displaying the debug object. */
+	void ClearTraceDisplay();
+
 	/** Set by property node. This isn't guaranteed to be valid unless used in a selected property command. */
 	TWeakObjectPtr<class USMGraphK2Node_PropertyNode_Base> SelectedPropertyNode;
 	/** Set when right clicking on a node. */
@@ -58,6 +68,12 @@ protected:
 
 	/** Find all nodes for the blueprint and reset their debug state. */
 	void ResetBlueprintDebugStates();
+
+	/** Pass activity recorded by the debug object to the graph nodes. */
+	void DrainDebugEvents();
+
+	/** Stop recording debug events on the current debug instance. */
+	void StopRecordingDebugEvents();
 	
 	/** FBlueprintEditor interface */
 	virtual void OnActiveTabChanged(TSharedPtr<SDockTab> PreviouslyActive, TSharedPtr<SDockTab> NewlyActivated) override;
@@ -126,6 +142,15 @@ private:
 
 	/** When the user sets a debug object. */
 	FDelegateHandle OnDebugObjectSetHandle;
+
+	/** The instance debug events are being drained from. */
+	TWeakObjectPtr<class USMInstance> DebugEventInstance;
+
+	/** Graph nodes by runtime NodeGuid for routing debug events. */
+	TMap<FGuid, TWeakObjectPtr<class USMGraphNode_Base>> RuntimeGuidNodes;
+
+	/** The debug node cache generation RuntimeGuidNodes was built for. */
+	uint32 RuntimeGuidNodesGeneration;
 };
 
 
@@ -3,6 +3,7 @@
 #include "Blueprints/SMBlueprintEditor.h"
 #include "BlueprintEditorTabs.h"
 #include "SBlueprintEditorToolbar.h"
+#include "Blueprints/SSMTraceTimeline.h"
 
 #define LOCTEXT_NAMESPACE "SMEditorModes"
 
@@ -98,6 +99,8 @@ FSMEditorBlueprintMode::FSMEditorBlueprintMode(TSharedPtr<class FSMBlueprintEdit
 		EditorIn->GetToolbarBuilder()->AddDebuggingToolbar(Toolbar);
 	}
 
+	EditorTabFactories.RegisterFactory(MakeShareable(new FSMTraceTimelineSummoner(EditorIn)));
+
 }
 
 FSMEditorBlueprintMode::~FSMEditorBlueprintMode()
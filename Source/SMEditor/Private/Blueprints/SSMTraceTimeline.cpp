@@ -0,0 +1,372 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "SSMTraceTimeline.h"
+#include "Blueprints/SMBlueprintEditor.h"
+#include "Graph/Nodes/SMGraphNode_Base.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SSlider.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Framework/Application/SlateApplication.h"
+#include "DesktopPlatformModule.h"
+#include "IDesktopPlatform.h"
+#include "EditorStyleSet.h"
+#include "Algo/BinarySearch.h"
+
+#define LOCTEXT_NAMESPACE "SMTraceTimeline"
+
+/** Maximum events listed before the current time. */
+static const int32 MaxRecentEvents = 50;
+
+static const TCHAR* GetTraceEventTypeName(ESMTraceEventType Type)
+{
+	switch (Type)
+	{
+	case ESMTraceEventType::StateEntered:
+		return TEXT("Entered");
+	case ESMTraceEventType::StateExited:
+		return TEXT("Exited");
+	case ESMTraceEventType::TransitionTaken:
+		return TEXT("Transition Taken");
+	default:
+		return TEXT("Unknown");
+	}
+}
+
+void SSMTraceTimeline::Construct(const FArguments& InArgs, TSharedPtr<FSMBlueprintEditor> InEditor)
+{
+	Editor = InEditor;
+
+	ChildSlot
+	[
+		SNew(SBorder)
+		.BorderImage(FEditorStyle::GetBrush("ToolPanel.GroupBorder"))
+		[
+			SNew(SVerticalBox)
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(2.f)
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(2.f)
+				[
+					SNew(SButton)
+					.Text(LOCTEXT("LoadTrace", "Load Trace..."))
+					.ToolTipText(LOCTEXT("LoadTraceTooltip", "Load a trace recorded with -SMTrace or sm.Trace.Start."))
+					.OnClicked(this, &SSMTraceTimeline::OnLoadTraceClicked)
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(2.f)
+				[
+					SAssignNew(InstanceComboBox, SComboBox<TSharedPtr<FSMTraceInstance>>)
+					.OptionsSource(&InstanceOptions)
+					.OnGenerateWidget(this, &SSMTraceTimeline::OnGenerateInstanceWidget)
+					.OnSelectionChanged(this, &SSMTraceTimeline::OnInstanceSelectionChanged)
+					[
+						SNew(STextBlock)
+						.Text(this, &SSMTraceTimeline::GetSelectedInstanceText)
+					]
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(2.f)
+				[
+					SNew(SButton)
+					.Text(LOCTEXT("ClearTrace", "Clear"))
+					.ToolTipText(LOCTEXT("ClearTraceTooltip", "Stop displaying the trace in the graph."))
+					.OnClicked(this, &SSMTraceTimeline::OnClearClicked)
+				]
+				+ SHorizontalBox::Slot()
+				.FillWidth(1.f)
+				.VAlign(VAlign_Center)
+				.Padding(4.f, 2.f)
+				[
+					SNew(STextBlock)
+					.Text(this, &SSMTraceTimeline::GetTraceInfoText)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(2.f)
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.FillWidth(1.f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(SSlider)
+					.Value(this, &SSMTraceTimeline::GetSliderValue)
+					.OnValueChanged(this, &SSMTraceTimeline::OnSliderValueChanged)
+				]
+				+ SHorizontalBox::Slot()
+				.AutoWidth()
+				.VAlign(VAlign_Center)
+				.Padding(4.f, 0.f)
+				[
+					SNew(STextBlock)
+					.Text(this, &SSMTraceTimeline::GetTimeText)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.FillHeight(1.f)
+			.Padding(2.f)
+			[
+				SAssignNew(RecentEventsView, SListView<TSharedPtr<FString>>)
+				.ListItemsSource(&RecentEventItems)
+				.OnGenerateRow(this, &SSMTraceTimeline::OnGenerateEventRow)
+				.SelectionMode(ESelectionMode::None)
+			]
+		]
+	];
+}
+
+SSMTraceTimeline::~SSMTraceTimeline()
+{
+	if (TSharedPtr<FSMBlueprintEditor> EditorPtr = Editor.Pin())
+	{
+		EditorPtr->ClearTraceDisplay();
+	}
+}
+
+bool SSMTraceTimeline::LoadTrace(const FString& FilePath)
+{
+	InstanceOptions.Reset();
+	SelectedInstance.Reset();
+	InstanceEvents.Reset();
+	RecentEventItems.Reset();
+	CurrentTime = 0.0;
+
+	if (!Trace.LoadFromFile(FilePath))
+	{
+		TraceFilePath.Reset();
+		InstanceComboBox->RefreshOptions();
+		UpdateGraphDisplay();
+		return false;
+	}
+
+	TraceFilePath = FilePath;
+
+	// Only instances of this blueprint can be displayed on its graph.
+	TSharedPtr<FSMBlueprintEditor> EditorPtr = Editor.Pin();
+	UBlueprint* Blueprint = EditorPtr.IsValid() ? EditorPtr->GetBlueprintObj() : nullptr;
+	const FString ClassPath = Blueprint && Blueprint->GeneratedClass ? Blueprint->GeneratedClass->GetPathName() : FString();
+
+	for (const FSMTraceInstance& Instance : Trace.Instances)
+	{
+		if (Instance.ClassPath == ClassPath)
+		{
+			InstanceOptions.Add(MakeShared<FSMTraceInstance>(Instance));
+		}
+	}
+
+	InstanceComboBox->RefreshOptions();
+	if (InstanceOptions.Num() > 0)
+	{
+		InstanceComboBox->SetSelectedItem(InstanceOptions[0]);
+	}
+
+	return true;
+}
+
+void SSMTraceTimeline::SetCurrentTime(double NewTime)
+{
+	CurrentTime = FMath::Clamp(NewTime, 0.0, Trace.GetDuration());
+	UpdateGraphDisplay();
+}
+
+FReply SSMTraceTimeline::OnLoadTraceClicked()
+{
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (!DesktopPlatform)
+	{
+		return FReply::Handled();
+	}
+
+	TArray<FString> Files;
+	const void* ParentWindowHandle = FSlateApplication::Get().FindBestParentWindowHandleForDialogs(AsShared());
+	if (DesktopPlatform->OpenFileDialog(ParentWindowHandle, LOCTEXT("LoadTraceTitle", "Load State Machine Trace").ToString(),
+		FSMTraceRecorder::GetDefaultTraceDirectory(), TEXT(""), TEXT("State Machine Trace (*.smtrace)|*.smtrace"), EFileDialogFlags::None, Files) && Files.Num() > 0)
+	{
+		LoadTrace(Files[0]);
+	}
+
+	return FReply::Handled();
+}
+
+FReply SSMTraceTimeline::OnClearClicked()
+{
+	if (TSharedPtr<FSMBlueprintEditor> EditorPtr = Editor.Pin())
+	{
+		EditorPtr->ClearTraceDisplay();
+	}
+
+	return FReply::Handled();
+}
+
+TSharedRef<SWidget> SSMTraceTimeline::OnGenerateInstanceWidget(TSharedPtr<FSMTraceInstance> Instance) const
+{
+	return SNew(STextBlock).Text(FText::FromString(Instance.IsValid() ? Instance->Name : FString()));
+}
+
+void SSMTraceTimeline::OnInstanceSelectionChanged(TSharedPtr<FSMTraceInstance> Instance, ESelectInfo::Type SelectInfo)
+{
+	SelectedInstance = Instance;
+	CacheInstanceEvents();
+	UpdateGraphDisplay();
+}
+
+FText SSMTraceTimeline::GetSelectedInstanceText() const
+{
+	if (SelectedInstance.IsValid())
+	{
+		return FText::FromString(SelectedInstance->Name);
+	}
+
+	return TraceFilePath.IsEmpty() ? LOCTEXT("NoTrace", "No trace loaded") : LOCTEXT("NoInstances", "No instances of this blueprint");
+}
+
+TSharedRef<ITableRow> SSMTraceTimeline::OnGenerateEventRow(TSharedPtr<FString> Item, const TSharedRef<STableViewBase>& OwnerTable) const
+{
+	return SNew(STableRow<TSharedPtr<FString>>, OwnerTable)
+	[
+		SNew(STextBlock).Text(FText::FromString(*Item))
+	];
+}
+
+float SSMTraceTimeline::GetSliderValue() const
+{
+	const double Duration = Trace.GetDuration();
+	return Duration > 0.0 ? static_cast<float>(CurrentTime / Duration) : 0.f;
+}
+
+void SSMTraceTimeline::OnSliderValueChanged(float NewValue)
+{
+	SetCurrentTime(NewValue * Trace.GetDuration());
+}
+
+FText SSMTraceTimeline::GetTimeText() const
+{
+	return FText::Format(LOCTEXT("TimeFormat", "{0} / {1} s"), FText::AsNumber(CurrentTime), FText::AsNumber(Trace.GetDuration()));
+}
+
+FText SSMTraceTimeline::GetTraceInfoText() const
+{
+	if (TraceFilePath.IsEmpty())
+	{
+		return FText::GetEmpty();
+	}
+
+	return FText::Format(LOCTEXT("TraceInfoFormat", "{0}: {1} events, {2} instances of this blueprint"), FText::FromString(FPaths::GetCleanFilename(TraceFilePath)),
+		FText::AsNumber(Trace.Events.Num()), FText::AsNumber(InstanceOptions.Num()));
+}
+
+void SSMTraceTimeline::CacheInstanceEvents()
+{
+	InstanceEvents.Reset();
+	if (!SelectedInstance.IsValid())
+	{
+		return;
+	}
+
+	for (int32 Idx = 0; Idx < Trace.Events.Num(); ++Idx)
+	{
+		if (Trace.Events[Idx].InstanceId == SelectedInstance->InstanceId)
+		{
+			InstanceEvents.Add(Idx);
+		}
+	}
+}
+
+void SSMTraceTimeline::UpdateGraphDisplay()
+{
+	RecentEventItems.Reset();
+
+	TSharedPtr<FSMBlueprintEditor> EditorPtr = Editor.Pin();
+	if (!EditorPtr.IsValid())
+	{
+		return;
+	}
+
+	EditorPtr->ClearTraceDisplay();
+
+	if (SelectedInstance.IsValid())
+	{
+		struct FNodeState
+		{
+			bool bActive = false;
+			double LastChangeTime = 0.0;
+		};
+
+		// Replay events up to the current time.
+		const int32 NumEvents = Algo::UpperBoundBy(InstanceEvents, CurrentTime, [&](int32 EventIndex)
+		{
+			return Trace.Events[EventIndex].Time;
+		});
+
+		TMap<uint16, FNodeState> NodeStates;
+		for (int32 Idx = 0; Idx < NumEvents; ++Idx)
+		{
+			const FSMTraceEvent& Event = Trace.Events[InstanceEvents[Idx]];
+			FNodeState& State = NodeStates.FindOrAdd(Event.NodeIndex);
+			State.bActive = Event.Type == ESMTraceEventType::StateEntered;
+			State.LastChangeTime = Event.Time;
+		}
+
+		for (const TPair<uint16, FNodeState>& NodeState : NodeStates)
+		{
+			if (const FSMTraceNode* Node = Trace.FindNode(SelectedInstance->InstanceId, NodeState.Key))
+			{
+				if (USMGraphNode_Base* GraphNode = EditorPtr->FindGraphNodeByRuntimeGuid(Node->NodeGuid))
+				{
+					GraphNode->SetTraceDisplayState(NodeState.Value.bActive, static_cast<float>(CurrentTime - NodeState.Value.LastChangeTime));
+				}
+			}
+		}
+
+		for (int32 Idx = NumEvents - 1; Idx >= FMath::Max(0, NumEvents - MaxRecentEvents); --Idx)
+		{
+			const FSMTraceEvent& Event = Trace.Events[InstanceEvents[Idx]];
+			const FSMTraceNode* Node = Trace.FindNode(Event.InstanceId, Event.NodeIndex);
+
+			FString Description = FString::Printf(TEXT("%.3f  %s  %s"), Event.Time, Node ? *Node->NodeName : TEXT("Unknown"), GetTraceEventTypeName(Event.Type));
+			if (Event.Type == ESMTraceEventType::StateExited)
+			{
+				Description += FString::Printf(TEXT(" after %.3f s"), Event.Duration);
+			}
+
+			RecentEventItems.Add(MakeShared<FString>(MoveTemp(Description)));
+		}
+	}
+
+	if (RecentEventsView.IsValid())
+	{
+		RecentEventsView->RequestListRefresh();
+	}
+}
+
+const FName FSMTraceTimelineSummoner::TabId(TEXT("SMTraceTimeline"));
+
+FSMTraceTimelineSummoner::FSMTraceTimelineSummoner(TSharedPtr<FSMBlueprintEditor> InEditor)
+	: FWorkflowTabFactory(TabId, InEditor), Editor(InEditor)
+{
+	TabLabel = LOCTEXT("TraceTimelineLabel", "Trace Timeline");
+	TabIcon = FSlateIcon(FEditorStyle::GetStyleSetName(), "Kismet.Tabs.BlueprintDebugger");
+	bIsSingleton = true;
+
+	ViewMenuDescription = LOCTEXT("TraceTimelineDescription", "Trace Timeline");
+	ViewMenuTooltip = LOCTEXT("TraceTimelineTooltip", "Replay recorded state machine activity on the graph.");
+}
+
+TSharedRef<SWidget> FSMTraceTimelineSummoner::CreateTabBody(const FWorkflowTabSpawnInfo& Info) const
+{
+	return SNew(SSMTraceTimeline, Editor.Pin());
+}
+
+FText FSMTraceTimelineSummoner::GetTabToolTipText(const FWorkflowTabSpawnInfo& Info) const
+{
+	return LOCTEXT("TraceTimelineTabTooltip", "Load a state machine trace and scrub through it.");
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,86 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Input/SComboBox.h"
+#include "Widgets/Views/SListView.h"
+#include "WorkflowOrientedApp/WorkflowTabFactory.h"
+#include "SMTraceRecorder.h"
+
+class FSMBlueprintEditor;
+
+/**
+ * Loads a recorded state machine trace and scrubs through the activity of one instance, highlighting the graph.
+ */
+class SSMTraceTimeline : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SSMTraceTimeline) {}
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs, TSharedPtr<FSMBlueprintEditor> InEditor);
+	virtual ~SSMTraceTimeline();
+
+	/** Load a trace file and select the first instance of this blueprint. */
+	bool LoadTrace(const FString& FilePath);
+
+	/** Display the selected instance's state at a time in seconds since the trace started. */
+	void SetCurrentTime(double NewTime);
+
+private:
+	FReply OnLoadTraceClicked();
+	FReply OnClearClicked();
+
+	TSharedRef<SWidget> OnGenerateInstanceWidget(TSharedPtr<FSMTraceInstance> Instance) const;
+	void OnInstanceSelectionChanged(TSharedPtr<FSMTraceInstance> Instance, ESelectInfo::Type SelectInfo);
+	FText GetSelectedInstanceText() const;
+
+	TSharedRef<ITableRow> OnGenerateEventRow(TSharedPtr<FString> Item, const TSharedRef<STableViewBase>& OwnerTable) const;
+
+	float GetSliderValue() const;
+	void OnSliderValueChanged(float NewValue);
+	FText GetTimeText() const;
+	FText GetTraceInfoText() const;
+
+	/** Find the events belonging to the selected instance. */
+	void CacheInstanceEvents();
+
+	/** Apply the node states at the current time to the graph. */
+	void UpdateGraphDisplay();
+
+private:
+	TWeakPtr<FSMBlueprintEditor> Editor;
+
+	FSMTrace Trace;
+	FString TraceFilePath;
+
+	TArray<TSharedPtr<FSMTraceInstance>> InstanceOptions;
+	TSharedPtr<FSMTraceInstance> SelectedInstance;
+	TSharedPtr<SComboBox<TSharedPtr<FSMTraceInstance>>> InstanceComboBox;
+
+	/** Indices into Trace.Events for the selected instance, in time order. */
+	TArray<int32> InstanceEvents;
+
+	/** Descriptions of the most recent events before the current time. */
+	TArray<TSharedPtr<FString>> RecentEventItems;
+	TSharedPtr<SListView<TSharedPtr<FString>>> RecentEventsView;
+
+	double CurrentTime = 0.0;
+};
+
+/** Summons the trace timeline tab in the state machine blueprint editor. */
+struct FSMTraceTimelineSummoner : public FWorkflowTabFactory
+{
+	static const FName TabId;
+
+	FSMTraceTimelineSummoner(TSharedPtr<FSMBlueprintEditor> InEditor);
+
+	// FWorkflowTabFactory
+	virtual TSharedRef<SWidget> CreateTabBody(const FWorkflowTabSpawnInfo& Info) const override;
+	virtual FText GetTabToolTipText(const FWorkflowTabSpawnInfo& Info) const override;
+	// ~FWorkflowTabFactory
+
+private:
+	TWeakPtr<FSMBlueprintEditor> Editor;
+};
@@ -0,0 +1,304 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "SMCompileAllCommandlet.h"
+#include "Blueprints/SMBlueprint.h"
+#include "Utilities/SMBlueprintEditorUtils.h"
+#include "Graph/Nodes/SMGraphNode_Base.h"
+#include "Graph/Nodes/SMGraphNode_StateMachineStateNode.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "Kismet2/CompilerResultsLog.h"
+#include "AssetRegistryModule.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSMCompileAll, Log, All);
+
+USMCompileAllCommandlet::USMCompileAllCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USMCompileAllCommandlet::Main(const FString& Params)
+{
+	FString PathsParam;
+	TArray<FString> Paths;
+	if (FParse::Value(*Params, TEXT("Paths="), PathsParam, false))
+	{
+		PathsParam.ParseIntoArray(Paths, TEXT("+"));
+	}
+
+	FString ReportPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Logs"), TEXT("SMCompileAll.json"));
+	FParse::Value(*Params, TEXT("Report="), ReportPath);
+
+	int32 BatchSize = 64;
+	FParse::Value(*Params, TEXT("BatchSize="), BatchSize);
+	BatchSize = FMath::Max(BatchSize, 1);
+
+	const bool bWarningsAsErrors = FParse::Param(*Params, TEXT("WarningsAsErrors"));
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<FCompileEntry> Entries;
+	LoadBlueprints(Paths, Entries);
+	BuildDependencies(Entries);
+
+	TArray<int32> Order;
+	SortTopologically(Entries, Order);
+
+	UE_LOG(LogSMCompileAll, Display, TEXT("Compiling %i state machine blueprints."), Order.Num());
+
+	int32 NumFailed = 0;
+	for (int32 Idx = 0; Idx < Order.Num(); ++Idx)
+	{
+		FCompileEntry& Entry = Entries[Order[Idx]];
+		CompileEntry(Entry);
+
+		if (Entry.NumErrors > 0 || (bWarningsAsErrors && Entry.NumWarnings > 0))
+		{
+			NumFailed++;
+		}
+
+		UE_LOG(LogSMCompileAll, Display, TEXT("[%i/%i] %s: %.2f ms, %i errors, %i warnings."), Idx + 1, Order.Num(),
+			*Entry.Blueprint->GetPathName(), Entry.CompileTime * 1000.0, Entry.NumErrors, Entry.NumWarnings);
+
+		// Each compile still reinstances on its own, but the old classes it leaves behind are collected once per batch.
+		if ((Idx + 1) % BatchSize == 0)
+		{
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+	}
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	const double TotalTime = FPlatformTime::Seconds() - StartTime;
+	if (!WriteReport(ReportPath, Entries, Order, TotalTime))
+	{
+		UE_LOG(LogSMCompileAll, Error, TEXT("Could not write report to %s."), *ReportPath);
+		return 1;
+	}
+
+	UE_LOG(LogSMCompileAll, Display, TEXT("Compiled %i blueprints in %.2f seconds, %i failed. Report written to %s."),
+		Order.Num(), TotalTime, NumFailed, *ReportPath);
+
+	return NumFailed > 0 ? 1 : 0;
+}
+
+void USMCompileAllCommandlet::LoadBlueprints(const TArray<FString>& Paths, TArray<FCompileEntry>& OutEntries) const
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(FName("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassNames.Add(USMBlueprint::StaticClass()->GetFName());
+	Filter.ClassNames.Add(USMNodeBlueprint::StaticClass()->GetFName());
+	Filter.bRecursiveClasses = true;
+	for (const FString& Path : Paths)
+	{
+		Filter.PackagePaths.Add(*Path);
+	}
+	Filter.bRecursivePaths = true;
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	// Keep the order stable between runs so reports can be diffed.
+	Assets.Sort([](const FAssetData& A, const FAssetData& B)
+	{
+		return A.ObjectPath.LexicalLess(B.ObjectPath);
+	});
+
+	for (const FAssetData& Asset : Assets)
+	{
+		if (UBlueprint* Blueprint = Cast<UBlueprint>(Asset.GetAsset()))
+		{
+			FCompileEntry Entry;
+			Entry.Blueprint = Blueprint;
+			OutEntries.Add(MoveTemp(Entry));
+		}
+		else
+		{
+			UE_LOG(LogSMCompileAll, Warning, TEXT("Could not load %s."), *Asset.ObjectPath.ToString());
+		}
+	}
+}
+
+void USMCompileAllCommandlet::BuildDependencies(TArray<FCompileEntry>& Entries) const
+{
+	TMap<const UBlueprint*, int32> EntryIndices;
+	for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
+	{
+		EntryIndices.Add(Entries[Idx].Blueprint, Idx);
+	}
+
+	for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
+	{
+		FCompileEntry& Entry = Entries[Idx];
+
+		auto AddDependency = [&](const UBlueprint* Dependency)
+		{
+			if (Dependency && Dependency != Entry.Blueprint)
+			{
+				if (const int32* DependencyIndex = EntryIndices.Find(Dependency))
+				{
+					Entry.Dependencies.AddUnique(*DependencyIndex);
+				}
+			}
+		};
+
+		AddDependency(UBlueprint::GetBlueprintFromClass(Entry.Blueprint->ParentClass));
+
+		if (!Entry.Blueprint->IsA<USMBlueprint>())
+		{
+			continue;
+		}
+
+		TArray<USMGraphNode_Base*> GraphNodes;
+		FSMBlueprintEditorUtils::GetAllNodesOfClassNested<USMGraphNode_Base>(Entry.Blueprint, GraphNodes);
+		for (USMGraphNode_Base* GraphNode : GraphNodes)
+		{
+			AddDependency(UBlueprint::GetBlueprintFromClass(GraphNode->GetNodeClass()));
+
+			if (USMGraphNode_StateMachineStateNode* StateMachineNode = Cast<USMGraphNode_StateMachineStateNode>(GraphNode))
+			{
+				AddDependency(StateMachineNode->GetStateMachineReference());
+			}
+		}
+	}
+}
+
+void USMCompileAllCommandlet::SortTopologically(TArray<FCompileEntry>& Entries, TArray<int32>& OutOrder) const
+{
+	TArray<int32> RemainingDependencies;
+	TArray<TArray<int32>> Dependents;
+	RemainingDependencies.SetNumZeroed(Entries.Num());
+	Dependents.SetNum(Entries.Num());
+
+	for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
+	{
+		RemainingDependencies[Idx] = Entries[Idx].Dependencies.Num();
+		for (const int32 Dependency : Entries[Idx].Dependencies)
+		{
+			Dependents[Dependency].Add(Idx);
+		}
+	}
+
+	OutOrder.Reset(Entries.Num());
+	for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
+	{
+		if (RemainingDependencies[Idx] == 0)
+		{
+			OutOrder.Add(Idx);
+		}
+	}
+
+	// OutOrder doubles as the queue.
+	for (int32 QueueIdx = 0; QueueIdx < OutOrder.Num(); ++QueueIdx)
+	{
+		for (const int32 Dependent : Dependents[OutOrder[QueueIdx]])
+		{
+			if (--RemainingDependencies[Dependent] == 0)
+			{
+				OutOrder.Add(Dependent);
+			}
+		}
+	}
+
+	// Anything left is part of a cycle. Compile it last, the compiler will report the invalid references.
+	for (int32 Idx = 0; Idx < Entries.Num(); ++Idx)
+	{
+		if (RemainingDependencies[Idx] > 0)
+		{
+			Entries[Idx].bInCycle = true;
+			OutOrder.Add(Idx);
+			UE_LOG(LogSMCompileAll, Warning, TEXT("%s is part of a dependency cycle."), *Entries[Idx].Blueprint->GetPathName());
+		}
+	}
+}
+
+void USMCompileAllCommandlet::CompileEntry(FCompileEntry& Entry) const
+{
+	FCompilerResultsLog Results;
+	Results.SetSourcePath(Entry.Blueprint->GetPathName());
+	Results.BeginEvent(TEXT("Compile"));
+
+	const double StartTime = FPlatformTime::Seconds();
+	FKismetEditorUtilities::CompileBlueprint(Entry.Blueprint, EBlueprintCompileOptions::SkipGarbageCollection | EBlueprintCompileOptions::SkipSave, &Results);
+	Entry.CompileTime = FPlatformTime::Seconds() - StartTime;
+
+	Results.EndEvent();
+
+	Entry.NumErrors = Results.NumErrors;
+	Entry.NumWarnings = Results.NumWarnings;
+	if (Entry.Blueprint->Status == BS_Error && Entry.NumErrors == 0)
+	{
+		Entry.NumErrors = 1;
+	}
+
+	for (const TSharedRef<FTokenizedMessage>& Message : Results.Messages)
+	{
+		if (Message->GetSeverity() <= EMessageSeverity::Warning)
+		{
+			Entry.Messages.Add(Message->ToText().ToString());
+		}
+	}
+}
+
+bool USMCompileAllCommandlet::WriteReport(const FString& ReportPath, const TArray<FCompileEntry>& Entries,
+	const TArray<int32>& Order, double TotalTime) const
+{
+	FString Output;
+	TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Output);
+
+	int32 TotalErrors = 0;
+	int32 TotalWarnings = 0;
+	for (const FCompileEntry& Entry : Entries)
+	{
+		TotalErrors += Entry.NumErrors;
+		TotalWarnings += Entry.NumWarnings;
+	}
+
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("totalSeconds"), TotalTime);
+	Writer->WriteValue(TEXT("blueprints"), Order.Num());
+	Writer->WriteValue(TEXT("errors"), TotalErrors);
+	Writer->WriteValue(TEXT("warnings"), TotalWarnings);
+
+	Writer->WriteArrayStart(TEXT("assets"));
+	for (const int32 Idx : Order)
+	{
+		const FCompileEntry& Entry = Entries[Idx];
+
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("path"), Entry.Blueprint->GetPathName());
+		Writer->WriteValue(TEXT("milliseconds"), Entry.CompileTime * 1000.0);
+		Writer->WriteValue(TEXT("errors"), Entry.NumErrors);
+		Writer->WriteValue(TEXT("warnings"), Entry.NumWarnings);
+		Writer->WriteValue(TEXT("dependencyCycle"), Entry.bInCycle);
+
+		Writer->WriteArrayStart(TEXT("dependencies"));
+		for (const int32 Dependency : Entry.Dependencies)
+		{
+			Writer->WriteValue(Entries[Dependency].Blueprint->GetPathName());
+		}
+		Writer->WriteArrayEnd();
+
+		Writer->WriteArrayStart(TEXT("messages"));
+		for (const FString& Message : Entry.Messages)
+		{
+			Writer->WriteValue(Message);
+		}
+		Writer->WriteArrayEnd();
+
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	return FFileHelper::SaveStringToFile(Output, *ReportPath);
+}
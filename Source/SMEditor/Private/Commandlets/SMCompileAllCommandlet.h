@@ -0,0 +1,63 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "SMCompileAllCommandlet.generated.h"
+
+class UBlueprint;
+
+/**
+ * Compiles every state machine and state machine node class blueprint exactly once, dependencies first.
+ * Parents, referenced state machines, and node classes are compiled before the blueprints using them. Results are written as
+ * a JSON report and the commandlet returns non-zero if any blueprint failed to compile. Does not require a renderer.
+ *
+ * Each blueprint is compiled and reinstanced on its own through FKismetEditorUtilities::CompileBlueprint so its time and
+ * messages can be reported individually. Only the garbage collection of classes left behind by reinstancing is batched.
+ * Compiles run one at a time on the game thread since the blueprint compiler isn't thread safe.
+ *
+ * UE4Editor-Cmd Project.uproject -run=SMCompileAll -nullrhi [-Paths=/Game/A+/Game/B] [-Report=Path.json] [-BatchSize=64] [-WarningsAsErrors]
+ */
+UCLASS()
+class USMCompileAllCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USMCompileAllCommandlet();
+
+	// UCommandlet
+	virtual int32 Main(const FString& Params) override;
+	// ~UCommandlet
+
+protected:
+	struct FCompileEntry
+	{
+		UBlueprint* Blueprint = nullptr;
+
+		/** Indices of entries which must compile before this one. */
+		TArray<int32> Dependencies;
+
+		double CompileTime = 0.0;
+		int32 NumErrors = 0;
+		int32 NumWarnings = 0;
+		TArray<FString> Messages;
+
+		/** Part of a dependency cycle. Compiled in discovery order after everything else. */
+		bool bInCycle = false;
+	};
+
+	/** Load all state machine blueprints found under the given paths. All paths are searched if empty. */
+	void LoadBlueprints(const TArray<FString>& Paths, TArray<FCompileEntry>& OutEntries) const;
+
+	/** Record parent, state machine reference, and node class dependencies between loaded entries. */
+	void BuildDependencies(TArray<FCompileEntry>& Entries) const;
+
+	/** Order entries so every dependency comes before its dependents. */
+	void SortTopologically(TArray<FCompileEntry>& Entries, TArray<int32>& OutOrder) const;
+
+	/** Compile a single entry, recording time and messages. */
+	void CompileEntry(FCompileEntry& Entry) const;
+
+	/** Write the machine readable report. */
+	bool WriteReport(const FString& ReportPath, const TArray<FCompileEntry>& Entries, const TArray<int32>& Order, double TotalTime) const;
+};
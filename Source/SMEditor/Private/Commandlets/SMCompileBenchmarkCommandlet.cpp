@@ -0,0 +1,152 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "SMCompileBenchmarkCommandlet.h"
+#include "Blueprints/SMBlueprint.h"
+#include "Blueprints/SMBlueprintGeneratedClass.h"
+#include "Utilities/SMBlueprintEditorUtils.h"
+#include "Graph/SMGraph.h"
+#include "Graph/SMTransitionGraph.h"
+#include "Graph/Schema/SMGraphSchema.h"
+#include "Graph/Nodes/SMGraphNode_StateNode.h"
+#include "Graph/Nodes/SMGraphNode_TransitionEdge.h"
+#include "Graph/Nodes/SMGraphNode_StateMachineEntryNode.h"
+#include "Graph/Nodes/RootNodes/SMGraphK2Node_TransitionResultNode.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "SMInstance.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSMCompileBenchmark, Log, All);
+
+USMCompileBenchmarkCommandlet::USMCompileBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USMCompileBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 NumNodes = 500;
+	int32 Iterations = 3;
+	FParse::Value(*Params, TEXT("Nodes="), NumNodes);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	NumNodes = FMath::Max(NumNodes, 1);
+	Iterations = FMath::Max(Iterations, 1);
+
+	double TotalCold = 0.0;
+	double TotalUnchanged = 0.0;
+	double TotalSingleEdit = 0.0;
+
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		USMBlueprint* Blueprint = CreateBenchmarkBlueprint(NumNodes, Iteration);
+		if (!Blueprint)
+		{
+			UE_LOG(LogSMCompileBenchmark, Error, TEXT("Could not create a state machine blueprint."));
+			return 1;
+		}
+
+		const double Cold = CompileAndTime(Blueprint);
+		LogPhaseTimings(TEXT("Cold"), Blueprint);
+
+		const double Unchanged = CompileAndTime(Blueprint);
+		LogPhaseTimings(TEXT("Unchanged"), Blueprint);
+
+		EditSingleTransition(Blueprint);
+		const double SingleEdit = CompileAndTime(Blueprint);
+		LogPhaseTimings(TEXT("Single Edit"), Blueprint);
+
+		UE_LOG(LogSMCompileBenchmark, Display, TEXT("Iteration %i: cold %.2f ms, unchanged %.2f ms, single edit %.2f ms."),
+			Iteration, Cold * 1000.0, Unchanged * 1000.0, SingleEdit * 1000.0);
+
+		TotalCold += Cold;
+		TotalUnchanged += Unchanged;
+		TotalSingleEdit += SingleEdit;
+
+		Blueprint->ClearFlags(RF_Standalone | RF_Public);
+		Blueprint->MarkPendingKill();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	UE_LOG(LogSMCompileBenchmark, Display, TEXT("Average over %i iterations of %i nodes: cold %.2f ms, unchanged %.2f ms, single edit %.2f ms."),
+		Iterations, NumNodes, TotalCold / Iterations * 1000.0, TotalUnchanged / Iterations * 1000.0, TotalSingleEdit / Iterations * 1000.0);
+
+	return 0;
+}
+
+USMBlueprint* USMCompileBenchmarkCommandlet::CreateBenchmarkBlueprint(int32 NumNodes, int32 Iteration)
+{
+	const FString PackageName = FString::Printf(TEXT("/Temp/SMCompileBenchmark/BP_SMCompileBenchmark_%i"), Iteration);
+	UPackage* Package = CreatePackage(nullptr, *PackageName);
+
+	USMBlueprint* Blueprint = Cast<USMBlueprint>(FKismetEditorUtilities::CreateBlueprint(USMInstance::StaticClass(), Package, *FPackageName::GetShortName(PackageName),
+		BPTYPE_Normal, USMBlueprint::StaticClass(), USMBlueprintGeneratedClass::StaticClass()));
+	if (!Blueprint)
+	{
+		return nullptr;
+	}
+
+	USMGraph* StateMachineGraph = FSMBlueprintEditorUtils::GetRootStateMachineGraph(Blueprint);
+	if (!StateMachineGraph || !StateMachineGraph->GetEntryNode())
+	{
+		return nullptr;
+	}
+
+	// States and the transitions between them both count as nodes.
+	const int32 NumStates = (NumNodes + 1) / 2;
+	UEdGraphPin* FromPin = StateMachineGraph->GetEntryNode()->GetOutputPin();
+
+	for (int32 Idx = 0; Idx < NumStates; ++Idx)
+	{
+		FSMGraphSchemaAction_NewNode AddNodeAction;
+		AddNodeAction.NodeTemplate = NewObject<USMGraphNode_StateNode>();
+		USMGraphNode_StateNode* StateNode = Cast<USMGraphNode_StateNode>(AddNodeAction.PerformAction(StateMachineGraph, FromPin, FVector2D(Idx * 300.f, 0.f), false));
+		if (!StateNode)
+		{
+			return nullptr;
+		}
+
+		// Placing a state from another state's pin creates the transition.
+		if (StateNode->GetInputPin()->LinkedTo.Num() > 0)
+		{
+			if (USMGraphNode_TransitionEdge* Transition = Cast<USMGraphNode_TransitionEdge>(StateNode->GetInputPin()->LinkedTo[0]->GetOwningNode()))
+			{
+				CastChecked<USMTransitionGraph>(Transition->GetBoundGraph())->ResultNode->GetInputPin()->DefaultValue = TEXT("true");
+			}
+		}
+
+		FromPin = StateNode->GetOutputPin();
+	}
+
+	return Blueprint;
+}
+
+void USMCompileBenchmarkCommandlet::EditSingleTransition(USMBlueprint* Blueprint) const
+{
+	TArray<USMGraphNode_TransitionEdge*> Transitions;
+	FSMBlueprintEditorUtils::GetAllNodesOfClassNested<USMGraphNode_TransitionEdge>(FSMBlueprintEditorUtils::GetRootStateMachineGraph(Blueprint), Transitions);
+	if (Transitions.Num() == 0)
+	{
+		return;
+	}
+
+	UEdGraphPin* ResultPin = CastChecked<USMTransitionGraph>(Transitions[Transitions.Num() / 2]->GetBoundGraph())->ResultNode->GetInputPin();
+	ResultPin->DefaultValue = ResultPin->DefaultValue == TEXT("true") ? TEXT("false") : TEXT("true");
+	FSMBlueprintEditorUtils::MarkBlueprintAsModified(Blueprint);
+}
+
+double USMCompileBenchmarkCommandlet::CompileAndTime(USMBlueprint* Blueprint) const
+{
+	const double StartTime = FPlatformTime::Seconds();
+	FKismetEditorUtilities::CompileBlueprint(Blueprint, EBlueprintCompileOptions::SkipGarbageCollection);
+	return FPlatformTime::Seconds() - StartTime;
+}
+
+void USMCompileBenchmarkCommandlet::LogPhaseTimings(const TCHAR* Label, USMBlueprint* Blueprint) const
+{
+	UE_LOG(LogSMCompileBenchmark, Display, TEXT("%s:"), Label);
+
+	for (const TPair<FString, double>& Timing : Blueprint->LastCompilePhaseTimings)
+	{
+		UE_LOG(LogSMCompileBenchmark, Display, TEXT("    %s: %.2f ms"), *Timing.Key, Timing.Value * 1000.0);
+	}
+}
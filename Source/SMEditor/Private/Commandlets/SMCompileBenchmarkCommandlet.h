@@ -0,0 +1,40 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "SMCompileBenchmarkCommandlet.generated.h"
+
+class USMBlueprint;
+
+/**
+ * Measures state machine blueprint compile times on synthetic linear state machines.
+ * Each iteration compiles a new machine cold, again without changes, and again after editing a single transition.
+ *
+ * UE4Editor-Cmd.exe Project.uproject -run=SMCompileBenchmark -Nodes=500 -Iterations=3 -nullrhi
+ */
+UCLASS()
+class USMCompileBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USMCompileBenchmarkCommandlet();
+
+	// UCommandlet
+	virtual int32 Main(const FString& Params) override;
+	// ~UCommandlet
+
+	/** Create a linear state machine blueprint with states and transitions totaling NumNodes. Every transition can always be taken. */
+	static USMBlueprint* CreateBenchmarkBlueprint(int32 NumNodes, int32 Iteration);
+
+protected:
+
+	/** Flip the result of one transition in the middle of the state machine. */
+	void EditSingleTransition(USMBlueprint* Blueprint) const;
+
+	/** Compile the blueprint and return the seconds taken. */
+	double CompileAndTime(USMBlueprint* Blueprint) const;
+
+	/** Log the phase breakdown recorded by the compiler. */
+	void LogPhaseTimings(const TCHAR* Label, USMBlueprint* Blueprint) const;
+};
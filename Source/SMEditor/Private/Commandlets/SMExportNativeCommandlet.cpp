@@ -0,0 +1,71 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "SMExportNativeCommandlet.h"
+#include "Blueprints/SMBlueprint.h"
+#include "Utilities/SMNativeCodeGenerator.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSMExportNative, Log, All);
+
+USMExportNativeCommandlet::USMExportNativeCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USMExportNativeCommandlet::Main(const FString& Params)
+{
+	FString BlueprintPath;
+	FSMNativeCodeGenerator::FOptions Options;
+	FString OutputDirectory;
+
+	if (!FParse::Value(*Params, TEXT("Blueprint="), BlueprintPath) || !FParse::Value(*Params, TEXT("Class="), Options.ClassName) ||
+		!FParse::Value(*Params, TEXT("Output="), OutputDirectory))
+	{
+		UE_LOG(LogSMExportNative, Error, TEXT("Usage: -run=SMExportNative -Blueprint=/Game/Path -Class=ClassName -Output=Directory [-Api=MODULE_API] [-AllowBlueprintGraphs]"));
+		return 1;
+	}
+
+	FParse::Value(*Params, TEXT("Api="), Options.ApiMacro);
+	Options.bAllowBlueprintImplementedGraphs = FParse::Param(*Params, TEXT("AllowBlueprintGraphs"));
+
+	if (FPaths::IsRelative(OutputDirectory))
+	{
+		OutputDirectory = FPaths::Combine(FPaths::ProjectDir(), OutputDirectory);
+	}
+
+	USMBlueprint* Blueprint = LoadObject<USMBlueprint>(nullptr, *BlueprintPath);
+	if (!Blueprint)
+	{
+		UE_LOG(LogSMExportNative, Error, TEXT("Could not load state machine blueprint %s."), *BlueprintPath);
+		return 1;
+	}
+
+	FKismetEditorUtilities::CompileBlueprint(Blueprint);
+
+	FSMNativeCodeGenerator::FResult Result;
+	FString Error;
+	if (!FSMNativeCodeGenerator::Generate(Blueprint, Options, Result, Error) ||
+		!FSMNativeCodeGenerator::SaveToDirectory(OutputDirectory, Options, Result, Error))
+	{
+		UE_LOG(LogSMExportNative, Error, TEXT("%s"), *Error);
+		return 1;
+	}
+
+	for (const FString& Warning : Result.Warnings)
+	{
+		UE_LOG(LogSMExportNative, Warning, TEXT("%s"), *Warning);
+	}
+
+	for (const FString& Function : Result.BlueprintFunctions)
+	{
+		UE_LOG(LogSMExportNative, Display, TEXT("Left to a blueprint subclass: %s"), *Function);
+	}
+
+	UE_LOG(LogSMExportNative, Display, TEXT("Exported %s to U%s in %s. %d nodes, %d native conditions, %d blueprint functions."),
+		*Blueprint->GetName(), *Options.ClassName, *OutputDirectory, Result.NumNodes, Result.NumNativeConditions, Result.BlueprintFunctions.Num());
+
+	return 0;
+}
@@ -0,0 +1,25 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "SMExportNativeCommandlet.generated.h"
+
+/**
+ * Exports a state machine blueprint as a native C++ USMInstance subclass. See FSMNativeCodeGenerator.
+ * The blueprint is compiled first. Returns non-zero if it can't be exported.
+ * -AllowBlueprintGraphs exports graphs which can't be converted as events of an abstract class to implement in a blueprint subclass.
+ *
+ * UE4Editor-Cmd Project.uproject -run=SMExportNative -nullrhi -Blueprint=/Game/AI/BP_Guard -Class=GuardStateMachine -Output=Source/Game/AI [-Api=GAME_API] [-AllowBlueprintGraphs]
+ */
+UCLASS()
+class USMExportNativeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USMExportNativeCommandlet();
+
+	// UCommandlet
+	virtual int32 Main(const FString& Params) override;
+	// ~UCommandlet
+};
@@ -0,0 +1,108 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "SMStateChangeBenchmarkCommandlet.h"
+#include "SMCompileBenchmarkCommandlet.h"
+#include "Blueprints/SMBlueprint.h"
+#include "SMInstance.h"
+#include "SMTraceRecorder.h"
+#include "SMUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSMStateChangeBenchmark, Log, All);
+
+USMStateChangeBenchmarkCommandlet::USMStateChangeBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USMStateChangeBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 NumEvents = 1000000;
+	FParse::Value(*Params, TEXT("Events="), NumEvents);
+	NumEvents = FMath::Max(NumEvents, 1);
+
+	int32 NumNodes = 64;
+	FParse::Value(*Params, TEXT("Nodes="), NumNodes);
+	NumNodes = FMath::Max(NumNodes, 3);
+
+	USMBlueprint* Blueprint = USMCompileBenchmarkCommandlet::CreateBenchmarkBlueprint(NumNodes, 0);
+	if (!Blueprint)
+	{
+		UE_LOG(LogSMStateChangeBenchmark, Error, TEXT("Could not create a state machine blueprint."));
+		return 1;
+	}
+
+	FKismetEditorUtilities::CompileBlueprint(Blueprint);
+
+	USMInstance* Instance = USMBlueprintUtils::CreateStateMachineInstance(Blueprint->GeneratedClass, this);
+	if (!Instance || Instance->GetRootStateMachine().GetStates().Num() < 2 || Instance->GetRootStateMachine().GetTransitions().Num() == 0)
+	{
+		UE_LOG(LogSMStateChangeBenchmark, Error, TEXT("Could not create a state machine instance."));
+		return 1;
+	}
+
+	// Only notification cost is measured.
+	if (FSMTraceRecorder::IsRecording())
+	{
+		FSMTraceRecorder::Get().StopRecording();
+	}
+
+	const double NoListenersTime = NotifyAndTime(Instance, NumEvents);
+
+	const FDelegateHandle StateChangedHandle = Instance->OnStateMachineStateChangedNative.AddLambda([this](USMInstance*, FSMState_Base*, FSMState_Base*) { NumNotifications++; });
+	const FDelegateHandle TransitionTakenHandle = Instance->OnStateMachineTransitionTakenNative.AddLambda([this](USMInstance*, const FSMTransition&) { NumNotifications++; });
+	const double NativeTime = NotifyAndTime(Instance, NumEvents);
+	Instance->OnStateMachineStateChangedNative.Remove(StateChangedHandle);
+	Instance->OnStateMachineTransitionTakenNative.Remove(TransitionTakenHandle);
+
+	Instance->OnStateMachineStateChangedEvent.AddDynamic(this, &USMStateChangeBenchmarkCommandlet::OnStateChanged);
+	Instance->OnStateMachineTransitionTakenEvent.AddDynamic(this, &USMStateChangeBenchmarkCommandlet::OnTransitionTaken);
+	const double DynamicTime = NotifyAndTime(Instance, NumEvents);
+	Instance->OnStateMachineStateChangedEvent.RemoveAll(this);
+	Instance->OnStateMachineTransitionTakenEvent.RemoveAll(this);
+
+	// Each event is a state change and a transition taken.
+	const double NumNotified = NumEvents * 2.0;
+	UE_LOG(LogSMStateChangeBenchmark, Display, TEXT("%i events over %i states, %i listener calls."), NumEvents, Instance->GetRootStateMachine().GetStates().Num(), NumNotifications);
+	UE_LOG(LogSMStateChangeBenchmark, Display, TEXT("No listeners: %.2f ns/notification."), NoListenersTime * 1e9 / NumNotified);
+	UE_LOG(LogSMStateChangeBenchmark, Display, TEXT("Native delegates: %.2f ns/notification."), NativeTime * 1e9 / NumNotified);
+	UE_LOG(LogSMStateChangeBenchmark, Display, TEXT("Dynamic events: %.2f ns/notification."), DynamicTime * 1e9 / NumNotified);
+
+	if (NativeTime > 0.0)
+	{
+		UE_LOG(LogSMStateChangeBenchmark, Display, TEXT("Native delegates over dynamic events: %.2fx."), DynamicTime / NativeTime);
+	}
+
+	Instance->Shutdown();
+	Blueprint->ClearFlags(RF_Standalone | RF_Public);
+	Blueprint->MarkPendingKill();
+
+	return 0;
+}
+
+void USMStateChangeBenchmarkCommandlet::OnStateChanged(USMInstance* Instance, FSMStateInfo NewState, FSMStateInfo PreviousState)
+{
+	NumNotifications++;
+}
+
+void USMStateChangeBenchmarkCommandlet::OnTransitionTaken(USMInstance* Instance, FSMTransitionInfo Transition)
+{
+	NumNotifications++;
+}
+
+double USMStateChangeBenchmarkCommandlet::NotifyAndTime(USMInstance* Instance, int32 NumEvents) const
+{
+	const TArray<FSMState_Base*>& States = Instance->GetRootStateMachine().GetStates();
+	const TArray<FSMTransition*>& Transitions = Instance->GetRootStateMachine().GetTransitions();
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Idx = 0; Idx < NumEvents; ++Idx)
+	{
+		Instance->NotifyTransitionTaken(*Transitions[Idx % Transitions.Num()]);
+		Instance->NotifyStateChange(States[(Idx + 1) % States.Num()], States[Idx % States.Num()]);
+	}
+
+	return FPlatformTime::Seconds() - StartTime;
+}
@@ -0,0 +1,41 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "SMNode_Info.h"
+#include "SMStateChangeBenchmarkCommandlet.generated.h"
+
+class USMInstance;
+
+/**
+ * Measures state change and transition taken notification throughput with no listeners, with native delegates bound
+ * and with the dynamic events bound. Dynamic events build FSMStateInfo and FSMTransitionInfo on every notification,
+ * which every notification did before the native delegates were added.
+ *
+ * UE4Editor-Cmd Project.uproject -run=SMStateChangeBenchmark -nullrhi [-Events=1000000] [-Nodes=64]
+ */
+UCLASS()
+class USMStateChangeBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USMStateChangeBenchmarkCommandlet();
+
+	// UCommandlet
+	virtual int32 Main(const FString& Params) override;
+	// ~UCommandlet
+
+protected:
+	UFUNCTION()
+	void OnStateChanged(USMInstance* Instance, FSMStateInfo NewState, FSMStateInfo PreviousState);
+
+	UFUNCTION()
+	void OnTransitionTaken(USMInstance* Instance, FSMTransitionInfo Transition);
+
+	/** Notify NumEvents state changes and transitions taken and return the seconds taken. */
+	double NotifyAndTime(USMInstance* Instance, int32 NumEvents) const;
+
+private:
+	int32 NumNotifications = 0;
+};
@@ -0,0 +1,93 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "SMTraceBenchmarkCommandlet.h"
+#include "SMInstance.h"
+#include "SMState.h"
+#include "SMTraceRecorder.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSMTraceBenchmark, Log, All);
+
+USMTraceBenchmarkCommandlet::USMTraceBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USMTraceBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 NumEvents = 1000000;
+	FParse::Value(*Params, TEXT("Events="), NumEvents);
+	NumEvents = FMath::Max(NumEvents, 1);
+
+	int32 NumNodes = 64;
+	FParse::Value(*Params, TEXT("Nodes="), NumNodes);
+	NumNodes = FMath::Clamp(NumNodes, 1, static_cast<int32>(MAX_uint16) - 1);
+
+	USMInstance* Instance = NewObject<USMInstance>(GetTransientPackage());
+	Instance->AddToRoot();
+
+	TArray<FSMState> States;
+	States.SetNum(NumNodes);
+	for (int32 Idx = 0; Idx < NumNodes; ++Idx)
+	{
+		States[Idx].GenerateNewNodeGuid();
+		States[Idx].SetNodeName(FString::Printf(TEXT("State_%i"), Idx));
+		States[Idx].Initialize(Instance);
+	}
+
+	if (FSMTraceRecorder::IsRecording())
+	{
+		FSMTraceRecorder::Get().StopRecording();
+	}
+
+	// Disabled: the only cost at call sites is the recording check.
+	int32 NumChecksPassed = 0;
+	double Start = FPlatformTime::Seconds();
+	for (int32 Idx = 0; Idx < NumEvents; ++Idx)
+	{
+		if (FSMTraceRecorder::IsRecording())
+		{
+			FSMTraceRecorder::Get().RecordEvent(States[Idx % NumNodes], ESMTraceEventType::StateEntered);
+			NumChecksPassed++;
+		}
+	}
+	const double DisabledTime = FPlatformTime::Seconds() - Start;
+
+	const FString TracePath = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("SMTraceBenchmark"), TEXT(".smtrace"));
+
+	int32 Result = 0;
+	if (FSMTraceRecorder::Get().StartRecording(TracePath))
+	{
+		Start = FPlatformTime::Seconds();
+		for (int32 Idx = 0; Idx < NumEvents; ++Idx)
+		{
+			if (FSMTraceRecorder::IsRecording())
+			{
+				FSMTraceRecorder::Get().RecordEvent(States[Idx % NumNodes], Idx & 1 ? ESMTraceEventType::StateExited : ESMTraceEventType::StateEntered);
+			}
+		}
+		const double RecordingTime = FPlatformTime::Seconds() - Start;
+
+		const int64 NumRecorded = FSMTraceRecorder::Get().GetNumEventsRecorded();
+		const int64 NumDropped = FSMTraceRecorder::Get().GetNumEventsDropped();
+		FSMTraceRecorder::Get().StopRecording();
+
+		const int64 FileSize = IFileManager::Get().FileSize(*TracePath);
+		IFileManager::Get().Delete(*TracePath);
+
+		UE_LOG(LogSMTraceBenchmark, Display, TEXT("Disabled: %.2f ns/event (%i recorded)."), DisabledTime * 1e9 / NumEvents, NumChecksPassed);
+		UE_LOG(LogSMTraceBenchmark, Display, TEXT("Recording: %.2f ns/event, %lld recorded, %lld dropped, %lld bytes written (%.2f bytes/event)."),
+			RecordingTime * 1e9 / NumEvents, NumRecorded, NumDropped, FileSize, NumRecorded > 0 ? static_cast<double>(FileSize) / NumRecorded : 0.0);
+	}
+	else
+	{
+		UE_LOG(LogSMTraceBenchmark, Error, TEXT("Could not start recording to %s."), *TracePath);
+		Result = 1;
+	}
+
+	Instance->RemoveFromRoot();
+	return Result;
+}
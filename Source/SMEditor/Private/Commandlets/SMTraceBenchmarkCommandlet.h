@@ -0,0 +1,23 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "SMTraceBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures the cost of the state machine trace recorder, both while disabled and while recording to a temporary file.
+ *
+ * UE4Editor-Cmd Project.uproject -run=SMTraceBenchmark -nullrhi [-Events=1000000] [-Nodes=64]
+ */
+UCLASS()
+class USMTraceBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USMTraceBenchmarkCommandlet();
+
+	// UCommandlet
+	virtual int32 Main(const FString& Params) override;
+	// ~UCommandlet
+};
@@ -5,6 +5,7 @@
 #include "EdGraphUtilities.h"
 #include "ISMEditorModule.h"
 #include "Utilities/SMBlueprintEditorUtils.h"
+#include "Config/SMProjectEditorSettings.h"
 #include "Kismet/KismetArrayLibrary.h"
 #include "Kismet2/KismetReinstanceUtilities.h"
 #include "Framework/Notifications/NotificationManager.h"
@@ -82,7 +83,8 @@ bool FSMKismetCompiler::GetBlueprintTypesForClass(UClass* ParentClass, UClass*&
 
 FSMKismetCompilerContext::FSMKismetCompilerContext(UBlueprint* InBlueprint,
 	FCompilerResultsLog& InMessageLog, const FKismetCompilerOptions& InCompilerOptions) :
-	FKismetCompilerContext(InBlueprint, InMessageLog, InCompilerOptions), NewSMBlueprintClass(nullptr)
+	FKismetCompilerContext(InBlueprint, InMessageLog, InCompilerOptions), NewSMBlueprintClass(nullptr),
+	bRecordPhaseTimings(InCompilerOptions.CompileType != EKismetCompileType::SkeletonOnly), bPhaseTimingsStored(false), bDefaultObjectCopied(false)
 {
 	if (InBlueprint->HasAnyFlags(RF_NeedPostLoad))
 	{
@@ -102,7 +104,10 @@ FSMKismetCompilerContext::FSMKismetCompilerContext(UBlueprint* InBlueprint,
 
 void FSMKismetCompilerContext::MergeUbergraphPagesIn(UEdGraph* Ubergraph)
 {
-	Super::MergeUbergraphPagesIn(Ubergraph);
+	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("MergeUbergraphPages"));
+		Super::MergeUbergraphPagesIn(Ubergraph);
+	}
 
 	// Make sure we expand any split pins here before we process state machine nodes.
 	for (TArray<UEdGraphNode*>::TIterator NodeIt(ConsolidatedEventGraph->Nodes); NodeIt; ++NodeIt)
@@ -137,13 +142,35 @@ void FSMKismetCompilerContext::MergeUbergraphPagesIn(UEdGraph* Ubergraph)
 	NewSMBlueprintClass->SetRootGuid(RootStateMachineNode->GetNodeGuid());
 
 	USMGraph* RootStateMachineGraph = RootStateMachine->GetStateMachineGraph();
-	ValidateAllNodes(RootStateMachineGraph);
-	PreProcessStateMachineNodes(RootStateMachineGraph);
-	PreProcessRuntimeReferences(RootStateMachineGraph);
-	ExpandParentNodes(RootStateMachineGraph);
-	ProcessStateMachineGraph(RootStateMachineGraph);
-	ProcessRuntimeContainers();
-	ProcessRuntimeReferences();
+	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("ValidateAllNodes"));
+		ValidateAllNodes(RootStateMachineGraph);
+	}
+	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("AnalyzeReachability"));
+		AnalyzeReachability(RootStateMachineGraph);
+	}
+	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("PreProcess"));
+		PreProcessStateMachineNodes(RootStateMachineGraph);
+		PreProcessRuntimeReferences(RootStateMachineGraph);
+	}
+	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("ExpandParentNodes"));
+		ExpandParentNodes(RootStateMachineGraph);
+	}
+	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("ProcessStateMachineGraph"));
+		ProcessStateMachineGraph(RootStateMachineGraph);
+	}
+	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("ProcessRuntimeContainers"));
+		ProcessRuntimeContainers();
+	}
+	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("ProcessRuntimeReferences"));
+		ProcessRuntimeReferences();
+	}
 }
 
 void FSMKismetCompilerContext::SpawnNewClass(const FString& NewClassName)
@@ -183,6 +210,8 @@ void FSMKismetCompilerContext::CleanAndSanitizeClass(UBlueprintGeneratedClass* C
 
 void FSMKismetCompilerContext::CopyTermDefaultsToDefaultObject(UObject* DefaultObject)
 {
+	const double StartTime = FPlatformTime::Seconds();
+	
 	Super::CopyTermDefaultsToDefaultObject(DefaultObject);
 
 	USMInstance* DefaultInstance = CastChecked<USMInstance>(DefaultObject);
@@ -330,21 +359,39 @@ void FSMKismetCompilerContext::CopyTermDefaultsToDefaultObject(UObject* DefaultO
 		}
 	}
 	
+	AddPhaseTiming(TEXT("CopyTermDefaultsToDefaultObject"), FPlatformTime::Seconds() - StartTime);
+	
 	if (Settings->bValidateInstanceOnCompile && !Blueprint->bIsNewlyCreated && !Blueprint->HasAnyFlags(RF_NeedLoad | RF_NeedPostLoad))
 	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("ValidateDefaultObject"));
 		ValidateDefaultObject(DefaultInstance);
 	}
+	
+	bDefaultObjectCopied = true;
+	if (bPhaseTimingsStored)
+	{
+		LogPhaseTimings();
+	}
 }
 
 void FSMKismetCompilerContext::PreCompile()
 {
 	Super::PreCompile();
 
-	FSMBlueprintEditorUtils::FixUpDuplicateRuntimeGuids(Blueprint, &MessageLog);
-	FSMBlueprintEditorUtils::FixUpMismatchedRuntimeGuids(Blueprint, &MessageLog);
+	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("FixUpDuplicateRuntimeGuids"));
+		FSMBlueprintEditorUtils::FixUpDuplicateRuntimeGuids(Blueprint, &MessageLog);
+	}
 
+	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("FixUpMismatchedRuntimeGuids"));
+		FSMBlueprintEditorUtils::FixUpMismatchedRuntimeGuids(Blueprint, &MessageLog);
+	}
+	
 	if (USMGraph* Graph = FSMBlueprintEditorUtils::GetRootStateMachineGraph(Blueprint))
 	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("PreCompileNodes"));
+		
 		TArray<USMGraphNode_Base*> Nodes;
 		FSMBlueprintEditorUtils::GetAllNodesOfClassNested<USMGraphNode_Base>(Graph, Nodes);
 		for (USMGraphNode_Base* Node : Nodes)
@@ -358,8 +405,16 @@ void FSMKismetCompilerContext::PostCompile()
 {
 	Super::PostCompile();
 
+	// Runtime node guids may have been fixed up and debug instances will be reinstanced.
+	USMGraphNode_Base::InvalidateDebugNodeCaches();
+
+	// Templates may have been added, removed or replaced. Child classes gather their parent templates too so clear everything.
+	USMUtils::InvalidateTemplateCache();
+
 	if (USMGraph* Graph = FSMBlueprintEditorUtils::GetRootStateMachineGraph(Blueprint))
 	{
+		FScopedPhaseTimer PhaseTimer(*this, TEXT("PostCompileValidate"));
+		
 		TArray<USMGraphK2Node_Base*> K2Nodes;
 		FSMBlueprintEditorUtils::GetAllNodesOfClassNested<USMGraphK2Node_Base>(Graph, K2Nodes);
 		for (USMGraphK2Node_Base* Node : K2Nodes)
@@ -367,6 +422,18 @@ void FSMKismetCompilerContext::PostCompile()
 			Node->PostCompileValidate(MessageLog);
 		}
 	}
+
+	if (bRecordPhaseTimings)
+	{
+		// The default object may still be copied after this.
+		GetSMBlueprint()->LastCompilePhaseTimings = MoveTemp(PhaseTimings);
+		bPhaseTimingsStored = true;
+
+		if (bDefaultObjectCopied)
+		{
+			LogPhaseTimings();
+		}
+	}
 }
 
 USMGraphK2Node_StateMachineNode* FSMKismetCompilerContext::GetRootStateMachineNode() const
@@ -455,6 +522,145 @@ void FSMKismetCompilerContext::ValidateDefaultObject(USMInstance* DefaultInstanc
 	}
 }
 
+void FSMKismetCompilerContext::AnalyzeReachability(USMGraph* StateMachineGraph)
+{
+	const USMProjectEditorSettings* ProjectEditorSettings = FSMBlueprintEditorUtils::GetProjectEditorSettings();
+	if (!ProjectEditorSettings->bWarnOnUnreachableStates && !ProjectEditorSettings->bStripUnreachableStates)
+	{
+		return;
+	}
+
+	TArray<USMGraphNode_StateNodeBase*> InitialStates;
+	if (USMGraphNode_StateMachineEntryNode* EntryNode = StateMachineGraph->GetEntryNode())
+	{
+		EntryNode->GetAllOutputNodesAs(InitialStates);
+	}
+
+	// Without an initial state nothing in this graph is compiled.
+	if (InitialStates.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<USMGraphNode_AnyStateNode*> AnyStates;
+	FSMBlueprintEditorUtils::TryGetAnyStateNodesForGraph(StateMachineGraph, AnyStates);
+
+	// Transitions which can never pass still run initialize and shutdown logic when their state starts and ends, so they keep their target.
+	// Custom node classes may implement that logic natively.
+	auto CanReachTarget = [](const USMGraphNode_TransitionEdge* Transition)
+	{
+		if (Transition->PossibleToTransition() || !Transition->IsUsingDefaultNodeClass())
+		{
+			return true;
+		}
+
+		const USMTransitionGraph* TransitionGraph = Cast<USMTransitionGraph>(Transition->GetBoundGraph());
+		return TransitionGraph && (TransitionGraph->HasInitLogic() || TransitionGraph->HasShutdownLogic());
+	};
+
+	TSet<USMGraphNode_StateNodeBase*> ReachableStates;
+	TArray<USMGraphNode_StateNodeBase*> StatesToVisit;
+	for (USMGraphNode_StateNodeBase* InitialState : InitialStates)
+	{
+		if (!ReachableStates.Contains(InitialState))
+		{
+			ReachableStates.Add(InitialState);
+			StatesToVisit.Add(InitialState);
+		}
+	}
+
+	TArray<USMGraphNode_TransitionEdge*> Transitions;
+	while (StatesToVisit.Num() > 0)
+	{
+		USMGraphNode_StateNodeBase* State = StatesToVisit.Pop(false);
+
+		Transitions.Reset();
+		State->GetOutputTransitions(Transitions);
+
+		// Any State transitions are added to every state they impact.
+		for (USMGraphNode_AnyStateNode* AnyState : AnyStates)
+		{
+			if (FSMBlueprintEditorUtils::DoesAnyStateImpactOtherNode(AnyState, State))
+			{
+				AnyState->GetOutputTransitions(Transitions);
+			}
+		}
+
+		for (USMGraphNode_TransitionEdge* Transition : Transitions)
+		{
+			USMGraphNode_StateNodeBase* TargetState = Transition->GetToState();
+			if (TargetState && !TargetState->IsA<USMGraphNode_AnyStateNode>() && !ReachableStates.Contains(TargetState) && CanReachTarget(Transition))
+			{
+				ReachableStates.Add(TargetState);
+				StatesToVisit.Add(TargetState);
+			}
+		}
+	}
+
+	TArray<USMGraphNode_StateNodeBase*> UnreachableStates;
+	for (UEdGraphNode* GraphNode : StateMachineGraph->Nodes)
+	{
+		USMGraphNode_StateNodeBase* State = Cast<USMGraphNode_StateNodeBase>(GraphNode);
+		if (State && !State->IsA<USMGraphNode_AnyStateNode>() && !ReachableStates.Contains(State))
+		{
+			UnreachableStates.Add(State);
+		}
+	}
+
+	if (ProjectEditorSettings->bWarnOnUnreachableStates)
+	{
+		for (USMGraphNode_StateNodeBase* State : UnreachableStates)
+		{
+			if (ProjectEditorSettings->bStripUnreachableStates)
+			{
+				MessageLog.Warning(TEXT("State @@ can never be reached from an entry state and was removed from the compiled state machine."), State);
+			}
+			else
+			{
+				MessageLog.Warning(TEXT("State @@ can never be reached from an entry state."), State);
+			}
+		}
+	}
+
+	if (ProjectEditorSettings->bStripUnreachableStates)
+	{
+		// The graph is a copy made for this compile.
+		TSet<USMGraphNode_TransitionEdge*> RemovedTransitions;
+		for (USMGraphNode_StateNodeBase* State : UnreachableStates)
+		{
+			Transitions.Reset();
+			State->GetInputTransitions(Transitions);
+			State->GetOutputTransitions(Transitions);
+
+			for (USMGraphNode_TransitionEdge* Transition : Transitions)
+			{
+				if (!RemovedTransitions.Contains(Transition))
+				{
+					RemovedTransitions.Add(Transition);
+					Transition->BreakAllNodeLinks();
+					StateMachineGraph->RemoveNode(Transition);
+				}
+			}
+
+			State->BreakAllNodeLinks();
+			StateMachineGraph->RemoveNode(State);
+		}
+	}
+
+	// Parent graphs are analyzed by their own blueprint.
+	for (UEdGraphNode* GraphNode : StateMachineGraph->Nodes)
+	{
+		USMGraphNode_StateMachineStateNode* StateMachineState = Cast<USMGraphNode_StateMachineStateNode>(GraphNode);
+		if (StateMachineState && !StateMachineState->IsA<USMGraphNode_StateMachineParentNode>())
+		{
+			if (USMGraph* NestedGraph = Cast<USMGraph>(StateMachineState->GetBoundGraph()))
+			{
+				AnalyzeReachability(NestedGraph);
+			}
+		}
+	}
+}
+
 void FSMKismetCompilerContext::PreProcessStateMachineNodes(UEdGraph* Graph)
 {
 	TArray<USMGraphNode_StateMachineStateNode*> StateMachines;
@@ -541,6 +747,7 @@ void FSMKismetCompilerContext::ProcessStateMachineGraph(USMGraph* StateMachineGr
 {
 	// This state machine's Guid. Default to root Guid.
 	FGuid ThisStateMachinesGuid = NewSMBlueprintClass->GetRootGuid();
+	const bool bCompileAnyStateAsGlobalTransitions = FSMBlueprintEditorUtils::GetProjectEditorSettings()->bCompileAnyStateAsGlobalTransitions;
 	// Back out early if the state machine has no entry point.
 	USMGraphNode_StateMachineEntryNode* StateMachineEntryNode = StateMachineGraph->GetEntryNode();
 	if (!StateMachineEntryNode)
@@ -681,6 +888,12 @@ void FSMKismetCompilerContext::ProcessStateMachineGraph(USMGraph* StateMachineGr
 		}
 		else if (USMGraphNode_AnyStateNode* AnyState = Cast<USMGraphNode_AnyStateNode>(GraphNode))
 		{
+			if (bCompileAnyStateAsGlobalTransitions)
+			{
+				// Compiled once as global transitions when linking transitions.
+				continue;
+			}
+			
 			// Any State nodes will duplicate their transitions to all valid state nodes.
 			for (int32 Idx = 0; Idx < AnyState->GetOutputPin()->LinkedTo.Num(); ++Idx)
 			{
@@ -785,7 +998,8 @@ void FSMKismetCompilerContext::ProcessStateMachineGraph(USMGraph* StateMachineGr
 				continue;
 			}
 
-			if (StartNode->IsA<USMGraphNode_AnyStateNode>())
+			USMGraphNode_AnyStateNode* AnyStateNode = Cast<USMGraphNode_AnyStateNode>(StartNode);
+			if (AnyStateNode && !bCompileAnyStateAsGlobalTransitions)
 			{
 				// Already processed.
 				continue;
@@ -814,20 +1028,37 @@ void FSMKismetCompilerContext::ProcessStateMachineGraph(USMGraph* StateMachineGr
 
 			// Link the transition to source nodes by guid. They will be resolved to pointers later.
 			{
-				UEdGraph* SourceStateGraph = Cast<UEdGraph>(StartNode->GetBoundGraph());
-				if (!SourceStateGraph)
+				if (AnyStateNode)
 				{
-					// These errors could occur if a compile happens while a state is being deleted.
-					MessageLog.Error(TEXT("State Machine Transition Node @@ has no graph for start node @@."), EdgeNode, StartNode);
-					continue;
+					if (!SetupGlobalTransition(EdgeNode, AnyStateNode, TransitionSourceGraph->ResultNode->TransitionNode))
+					{
+						continue;
+					}
 				}
-
-				FSMNode_Base* SourceState = FSMBlueprintEditorUtils::GetRuntimeNodeFromGraph(SourceStateGraph);
-				if (!SourceState)
+				else
 				{
-					// These errors could occur if a compile happens while a state is being deleted.
-					MessageLog.Error(TEXT("State Machine Transition Node @@ has an invalid runtime node for start node @@."), EdgeNode, StartNode);
-					continue;
+					UEdGraph* SourceStateGraph = Cast<UEdGraph>(StartNode->GetBoundGraph());
+					if (!SourceStateGraph)
+					{
+						// These errors could occur if a compile happens while a state is being deleted.
+						MessageLog.Error(TEXT("State Machine Transition Node @@ has no graph for start node @@."), EdgeNode, StartNode);
+						continue;
+					}
+
+					FSMNode_Base* SourceState = FSMBlueprintEditorUtils::GetRuntimeNodeFromGraph(SourceStateGraph);
+					if (!SourceState)
+					{
+						// These errors could occur if a compile happens while a state is being deleted.
+						MessageLog.Error(TEXT("State Machine Transition Node @@ has an invalid runtime node for start node @@."), EdgeNode, StartNode);
+						continue;
+					}
+
+					TransitionSourceGraph->ResultNode->TransitionNode.FromGuid = SourceState->GetNodeGuid();
+					if (!TransitionSourceGraph->ResultNode->TransitionNode.FromGuid.IsValid())
+					{
+						MessageLog.Error(TEXT("State Machine Transition Node @@ has an invalid guid for from state @@."), EdgeNode, StartNode);
+						continue;
+					}
 				}
 
 				UEdGraph* TargetStateGraph = Cast<UEdGraph>(EndNode->GetBoundGraph());
@@ -846,13 +1077,6 @@ void FSMKismetCompilerContext::ProcessStateMachineGraph(USMGraph* StateMachineGr
 					continue;
 				}
 
-				TransitionSourceGraph->ResultNode->TransitionNode.FromGuid = SourceState->GetNodeGuid();
-				if (!TransitionSourceGraph->ResultNode->TransitionNode.FromGuid.IsValid())
-				{
-					MessageLog.Error(TEXT("State Machine Transition Node @@ has an invalid guid for from state @@."), EdgeNode, StartNode);
-					continue;
-				}
-
 				TransitionSourceGraph->ResultNode->TransitionNode.ToGuid = TargetState->GetNodeGuid();
 				if (!TransitionSourceGraph->ResultNode->TransitionNode.ToGuid.IsValid())
 				{
@@ -867,6 +1091,37 @@ void FSMKismetCompilerContext::ProcessStateMachineGraph(USMGraph* StateMachineGr
 	}
 }
 
+bool FSMKismetCompilerContext::SetupGlobalTransition(USMGraphNode_TransitionEdge* EdgeNode, USMGraphNode_AnyStateNode* AnyStateNode, FSMTransition& RuntimeTransition)
+{
+	RuntimeTransition.bIsGlobalTransition = true;
+	RuntimeTransition.FromGuid.Invalidate();
+	RuntimeTransition.GlobalFromGuids.Reset();
+	
+	// An Any State transition which can never pass doesn't impact other states.
+	if (!EdgeNode->PossibleToTransition())
+	{
+		return false;
+	}
+
+	USMGraphNode_StateNodeBase* TargetStateNode = EdgeNode->GetToState();
+	for (UEdGraphNode* GraphNode : AnyStateNode->GetGraph()->Nodes)
+	{
+		USMGraphNode_StateNodeBase* FromStateNode = Cast<USMGraphNode_StateNodeBase>(GraphNode);
+		if (!FromStateNode || !FSMBlueprintEditorUtils::DoesAnyStateImpactOtherNode(AnyStateNode, FromStateNode) ||
+			(FromStateNode == TargetStateNode && !AnyStateNode->bAllowInitialReentry))
+		{
+			continue;
+		}
+
+		if (const FSMNode_Base* FromState = FSMBlueprintEditorUtils::GetRuntimeNodeFromGraph(FromStateNode->GetBoundGraph()))
+		{
+			RuntimeTransition.GlobalFromGuids.Add(FromState->GetNodeGuid());
+		}
+	}
+
+	return RuntimeTransition.GlobalFromGuids.Num() > 0;
+}
+
 void FSMKismetCompilerContext::ProcessRuntimeContainers()
 {
 	TArray<USMGraphK2Node_RuntimeNodeContainer*> RuntimeContainerNodeList;
@@ -1020,13 +1275,27 @@ void FSMKismetCompilerContext::ProcessRuntimeReferences()
 		{
 			FSMExposedFunctionHandler Handler;
 			Handler.BoundFunction = FunctionName;
-			RuntimeNode->TransitionInitializedGraphEvaluators.Add(Handler);
+			if (TransitionInitializedNode->bExecuteOnInstanceInitialized)
+			{
+				RuntimeNode->InstanceInitializedGraphEvaluators.Add(Handler);
+			}
+			else
+			{
+				RuntimeNode->TransitionInitializedGraphEvaluators.Add(Handler);
+			}
 		}
 		else if (USMGraphK2Node_TransitionShutdownNode* TransitionShutdownNode = Cast<USMGraphK2Node_TransitionShutdownNode>(RuntimeReferenceNode))
 		{
 			FSMExposedFunctionHandler Handler;
 			Handler.BoundFunction = FunctionName;
-			RuntimeNode->TransitionShutdownGraphEvaluators.Add(Handler);
+			if (TransitionShutdownNode->bExecuteOnInstanceShutdown)
+			{
+				RuntimeNode->InstanceShutdownGraphEvaluators.Add(Handler);
+			}
+			else
+			{
+				RuntimeNode->TransitionShutdownGraphEvaluators.Add(Handler);
+			}
 		}
 		else if (USMGraphK2Node_TransitionPreEvaluateNode* TransitionPreEvaluateNode = Cast<USMGraphK2Node_TransitionPreEvaluateNode>(RuntimeReferenceNode))
 		{
@@ -1466,6 +1735,32 @@ FName FSMKismetCompilerContext::CreateFunctionName(USMGraphK2Node_RootNode* Grap
 	return FName(*FString::Printf(TEXT("%s_%s_%s_%s"), *GraphNode->GetName(), *RuntimeNode->GetNodeName(), *RuntimeNode->GetNodeGuid().ToString(), *FGuid::NewGuid().ToString()));
 }
 
+void FSMKismetCompilerContext::AddPhaseTiming(const FString& Phase, double Seconds)
+{
+	TArray<TPair<FString, double>>& Timings = bPhaseTimingsStored ? GetSMBlueprint()->LastCompilePhaseTimings : PhaseTimings;
+	Timings.Emplace(Phase, Seconds);
+}
+
+void FSMKismetCompilerContext::LogPhaseTimings()
+{
+	const USMProjectEditorSettings* Settings = FSMBlueprintEditorUtils::GetProjectEditorSettings();
+	if (!Settings->bLogCompilePhaseTimings)
+	{
+		return;
+	}
+
+	double TotalSeconds = 0.0;
+	FString Breakdown;
+	for (const TPair<FString, double>& Timing : GetSMBlueprint()->LastCompilePhaseTimings)
+	{
+		TotalSeconds += Timing.Value;
+		Breakdown += FString::Printf(TEXT("\n    %s: %.2f ms"), *Timing.Key, Timing.Value * 1000.0);
+	}
+
+	const FString Message = FString::Printf(TEXT("State machine compile phases took %.2f ms.%s"), TotalSeconds * 1000.0, *Breakdown);
+	MessageLog.Note(*Message);
+}
+
 void FSMKismetCompilerContext::RecompileChildren()
 {
 	/*
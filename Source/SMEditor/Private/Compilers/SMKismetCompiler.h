@@ -16,6 +16,9 @@ class UK2Node_StructMemberSet;
 class USMGraphK2Node_StateWriteNode;
 class USMGraphK2Node_StateReadNode;
 class USMGraph;
+class USMGraphNode_AnyStateNode;
+class USMGraphNode_TransitionEdge;
+struct FSMTransition;
 class USMGraphK2Node_RuntimeNodeContainer;
 class USMGraphK2Node_RootNode;
 class USMGraphK2Node_StateMachineNode;
@@ -85,6 +88,12 @@ protected:
 	/** Generates a run-time state machine from the default instance and checks for errors. */
 	void ValidateDefaultObject(USMInstance* DefaultInstance);
 
+	/**
+	 * Find states which can never become active starting from the entry states, following transitions which can pass and Any State nodes.
+	 * Warns about them and removes them and their transitions if enabled in the project settings. Nested state machines which remain are analyzed as well.
+	 */
+	void AnalyzeReachability(USMGraph* StateMachineGraph);
+
 	/** Creates and assigns container nodes for relevant nested FSMs. */
 	void PreProcessStateMachineNodes(UEdGraph* Graph);
 	
@@ -97,6 +106,12 @@ protected:
 	/** Create runtime properties from a state machine graph. */
 	void ProcessStateMachineGraph(USMGraph* StateMachineGraph);
 
+	/**
+	 * Configure an Any State transition to be evaluated once by its state machine for every state the Any State impacts.
+	 * @return False if the transition can't be taken from any state and shouldn't be compiled.
+	 */
+	bool SetupGlobalTransition(USMGraphNode_TransitionEdge* EdgeNode, USMGraphNode_AnyStateNode* AnyStateNode, FSMTransition& RuntimeTransition);
+
 	/** Run through the ConsolidatedGraph and create properties for runtime nodes and entry points. */
 	void ProcessRuntimeContainers();
 
@@ -112,6 +127,24 @@ protected:
 	/** Call expand logic on function node. */
 	void ProcessFunctionNode(USMGraphK2Node_FunctionNode* FunctionNode);
 
+	/** Record the seconds spent in a compile phase. */
+	void AddPhaseTiming(const FString& Phase, double Seconds);
+
+	/** Display the phase timings in the compiler log if enabled. */
+	void LogPhaseTimings();
+
+	/** Adds the time spent in scope to the compile phase timings. */
+	struct FScopedPhaseTimer
+	{
+		FScopedPhaseTimer(FSMKismetCompilerContext& InContext, const TCHAR* InPhase) : Context(InContext), Phase(InPhase), StartTime(FPlatformTime::Seconds()) {}
+		~FScopedPhaseTimer() { Context.AddPhaseTiming(Phase, FPlatformTime::Seconds() - StartTime); }
+
+	private:
+		FSMKismetCompilerContext& Context;
+		const TCHAR* Phase;
+		double StartTime;
+	};
+
 public:
 	/** Creates and wires an entry point and runtime function. */
 	UK2Node_CustomEvent* SetupStateEntry(USMGraphK2Node_RuntimeNodeContainer* ContainerNode, FStructProperty* Property);
@@ -169,4 +202,12 @@ protected:
 	 * Current derived behavior allows child graphs to replace parent graphs.
 	 */
 	bool bBlueprintIsDerived;
+
+	/** Seconds spent in each compile phase so far, in order. Stored on the blueprint during PostCompile. */
+	TArray<TPair<FString, double>> PhaseTimings;
+
+	/** Only compiles which generate functions record phase timings. */
+	bool bRecordPhaseTimings;
+	bool bPhaseTimingsStored;
+	bool bDefaultObjectCopied;
 };
@@ -10,6 +10,11 @@ USMProjectEditorSettings::USMProjectEditorSettings()
 	StructMemoryLimitWarningThreshold = 0.9f;
 	bValidateInstanceOnCompile = true;
 	bWarnIfChildrenAreOutOfDate = true;
+	bLogCompilePhaseTimings = false;
+	bWarnOnUnreachableStates = false;
+	bStripUnreachableStates = false;
+	bCompileAnyStateAsGlobalTransitions = false;
+	bPersistentTransitionEventBindings = false;
 	bConfigureNewConduitsAsTransitions = true;
 	bDisplayUpdateNotification = true;
 	InstalledVersion = "";
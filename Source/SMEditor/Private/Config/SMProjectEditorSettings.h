@@ -64,6 +64,41 @@ public:
 	 * instead of pressing the compile button, the children may not be updated. In this case the state machine compiler will attempt to warn you.
 	 */
 	bool bWarnIfChildrenAreOutOfDate;
+
+	/**
+	 * Display the time spent in each phase of a state machine compile.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Compile")
+	bool bLogCompilePhaseTimings;
+
+	/**
+	 * Warn about states which can never become active because no entry state, transition, or Any State node leads to them.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Compile")
+	bool bWarnOnUnreachableStates;
+
+	/**
+	 * Leave unreachable states and their transitions out of the compiled state machine. This reduces instance size and initialization time.
+	 * Unreachable states can no longer be loaded by guid, such as from LoadFromState.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Compile")
+	bool bStripUnreachableStates;
+
+	/**
+	 * Compile each Any State transition once as a global transition of its state machine instead of copying it to every impacted state.
+	 * Global transitions are evaluated against the active state in priority order with the state's own transitions.
+	 * This reduces instance size and initialization time, but global transitions aren't returned from a state instance's GetOutgoingTransitions.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Compile")
+	bool bCompileAnyStateAsGlobalTransitions;
+
+	/**
+	 * Bind auto-bound transition events once when the instance initializes instead of each time the owning state starts.
+	 * Events fired while the owning state isn't active are ignored. Entering and leaving states no longer adds or removes delegates,
+	 * but the delegate owner must be available when the instance initializes.
+	 */
+	UPROPERTY(config, EditAnywhere, Category = "Compile")
+	bool bPersistentTransitionEventBindings;
 	
 	/**
 	 * Newly placed conduits will automatically be configured as transitions.
@@ -6,9 +6,17 @@
 #include "Graph/Nodes/SMGraphNode_StateMachineEntryNode.h"
 #include "Rendering/DrawElements.h"
 
+/** How far a transition to the same state curves outside of the state. */
+static const float SelfTransitionExtent = 45.f;
+
+TMap<TWeakObjectPtr<UEdGraph>, TMap<UEdGraphNode*, int32>> FSMGraphConnectionDrawingPolicy::NodeWidgetMaps;
+
 FSMGraphConnectionDrawingPolicy::FSMGraphConnectionDrawingPolicy(int32 InBackLayerID, int32 InFrontLayerID, float ZoomFactor, const FSlateRect& InClippingRect, FSlateWindowElementList& InDrawElements, UEdGraph* InGraphObj)
 	: FConnectionDrawingPolicy(InBackLayerID, InFrontLayerID, ZoomFactor, InClippingRect, InDrawElements)
 	, GraphObj(InGraphObj)
+	, NodeWidgetMap(nullptr)
+	, CurrentArrangedNodes(nullptr)
+	, bNodeWidgetMapRebuilt(false)
 {
 	
 }
@@ -47,16 +55,61 @@ void FSMGraphConnectionDrawingPolicy::DetermineWiringStyle(UEdGraphPin* OutputPi
 
 void FSMGraphConnectionDrawingPolicy::Draw(TMap<TSharedRef<SWidget>, FArrangedWidget>& InPinGeometries, FArrangedChildren& ArrangedNodes)
 {
-	// Build an acceleration structure to quickly find geometry for the nodes
-	NodeWidgetMap.Empty();
-	for (int32 NodeIndex = 0; NodeIndex < ArrangedNodes.Num(); ++NodeIndex)
+	if (!NodeWidgetMaps.Contains(GraphObj))
 	{
-		FArrangedWidget& CurWidget = ArrangedNodes[NodeIndex];
-		TSharedRef<SGraphNode> ChildNode = StaticCastSharedRef<SGraphNode>(CurWidget.Widget);
-		NodeWidgetMap.Add(ChildNode->GetNodeObj(), NodeIndex);
+		for (auto It = NodeWidgetMaps.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
 	}
 
+	NodeWidgetMap = &NodeWidgetMaps.FindOrAdd(GraphObj);
+	CurrentArrangedNodes = &ArrangedNodes;
+	bNodeWidgetMapRebuilt = false;
+
 	FConnectionDrawingPolicy::Draw(InPinGeometries, ArrangedNodes);
+
+	CurrentArrangedNodes = nullptr;
+}
+
+FArrangedWidget* FSMGraphConnectionDrawingPolicy::FindNodeWidget(FArrangedChildren& ArrangedNodes, UEdGraphNode* Node)
+{
+	auto IsMatchingIndex = [&](const int32* Index)
+	{
+		return Index && ArrangedNodes.IsValidIndex(*Index) && static_cast<SGraphNode&>(ArrangedNodes[*Index].Widget.Get()).GetNodeObj() == Node;
+	};
+
+	const int32* Index = NodeWidgetMap->Find(Node);
+	if (!IsMatchingIndex(Index) && !bNodeWidgetMapRebuilt)
+	{
+		RebuildNodeWidgetMap(ArrangedNodes);
+		Index = NodeWidgetMap->Find(Node);
+	}
+
+	return IsMatchingIndex(Index) ? &ArrangedNodes[*Index] : nullptr;
+}
+
+void FSMGraphConnectionDrawingPolicy::RebuildNodeWidgetMap(FArrangedChildren& ArrangedNodes)
+{
+	NodeWidgetMap->Reset();
+	for (int32 NodeIndex = 0; NodeIndex < ArrangedNodes.Num(); ++NodeIndex)
+	{
+		const SGraphNode& ChildNode = static_cast<SGraphNode&>(ArrangedNodes[NodeIndex].Widget.Get());
+		NodeWidgetMap->Add(ChildNode.GetNodeObj(), NodeIndex);
+	}
+
+	bNodeWidgetMapRebuilt = true;
+}
+
+bool FSMGraphConnectionDrawingPolicy::IsLinkCulled(const FArrangedWidget& StartWidget, const FArrangedWidget& EndWidget) const
+{
+	const FSlateRect LinkBounds = StartWidget.Geometry.GetLayoutBoundingRect().Expand(EndWidget.Geometry.GetLayoutBoundingRect())
+		.ExtendBy(SelfTransitionExtent * ZoomFactor + ArrowRadius.GetMax());
+
+	return !FSlateRect::DoRectanglesIntersect(LinkBounds, ClippingRect);
 }
 
 FVector2D FSMGraphConnectionDrawingPolicy::ComputeSplineTangent(const FVector2D& Start, const FVector2D& End) const
@@ -75,16 +128,14 @@ void FSMGraphConnectionDrawingPolicy::DetermineLinkGeometry(FArrangedChildren& A
 		StartWidgetGeometry = PinGeometries->Find(OutputPinWidget);
 
 		USMGraphNode_StateNodeBase* State = CastChecked<USMGraphNode_StateNodeBase>(InputPin->GetOwningNode());
-		if (const int32* StateIndex = NodeWidgetMap.Find(State))
-		{
-			/*
-			 * This used to be FindChecked, but there's an edge case that crashes...
-			 * Create parent node, open node, create a new state, while the state is still being named press back on the mouse so you go to the parent
-			 * Hover mouse over parent. It tries to draw the graph in a popup, but because the state hasn't been committed it doesn't exist yet.
-			 * Presumably fails with references too.
-			 */
-			EndWidgetGeometry = &ArrangedNodes[*StateIndex];
-		}
+
+		/*
+		 * This used to be FindChecked, but there's an edge case that crashes...
+		 * Create parent node, open node, create a new state, while the state is still being named press back on the mouse so you go to the parent
+		 * Hover mouse over parent. It tries to draw the graph in a popup, but because the state hasn't been committed it doesn't exist yet.
+		 * Presumably fails with references too.
+		 */
+		EndWidgetGeometry = FindNodeWidget(ArrangedNodes, State);
 	}
 	else if (USMGraphNode_TransitionEdge* EdgeNode = Cast<USMGraphNode_TransitionEdge>(InputPin->GetOwningNode()))
 	{
@@ -92,12 +143,12 @@ void FSMGraphConnectionDrawingPolicy::DetermineLinkGeometry(FArrangedChildren& A
 		USMGraphNode_StateNodeBase* End = EdgeNode->GetToState();
 		if (Start != nullptr && End != nullptr)
 		{
-			int32* StartNodeIndex = NodeWidgetMap.Find(Start);
-			int32* EndNodeIndex = NodeWidgetMap.Find(End);
-			if (StartNodeIndex && EndNodeIndex)
+			FArrangedWidget* StartNodeWidget = FindNodeWidget(ArrangedNodes, Start);
+			FArrangedWidget* EndNodeWidget = FindNodeWidget(ArrangedNodes, End);
+			if (StartNodeWidget && EndNodeWidget)
 			{
-				StartWidgetGeometry = &ArrangedNodes[*StartNodeIndex];
-				EndWidgetGeometry = &ArrangedNodes[*EndNodeIndex];
+				StartWidgetGeometry = StartNodeWidget;
+				EndWidgetGeometry = EndNodeWidget;
 			}
 		}
 	}
@@ -123,6 +174,12 @@ void FSMGraphConnectionDrawingPolicy::DetermineLinkGeometry(FArrangedChildren& A
 			StartWidgetGeometry = EndWidgetGeometry = nullptr;
 		}
 	}
+
+	// Skip styling and drawing links which can't be seen.
+	if (StartWidgetGeometry && EndWidgetGeometry && IsLinkCulled(*StartWidgetGeometry, *EndWidgetGeometry))
+	{
+		StartWidgetGeometry = EndWidgetGeometry = nullptr;
+	}
 }
 
 
@@ -153,12 +210,11 @@ void FSMGraphConnectionDrawingPolicy::DrawSplineWithArrow(const FVector2D& Start
 
 void FSMGraphConnectionDrawingPolicy::DrawSplineWithArrow(const FGeometry& StartGeom, const FGeometry& EndGeom, const FConnectionParams& Params)
 {
-	// Get a reasonable seed point (halfway between the boxes)
-	const FVector2D StartCenter = FGeometryHelper::CenterOf(StartGeom);
-
 	// This is a curve connecting itself.
 	if (Params.bUserFlag2)
 	{
+		const FVector2D StartCenter = FGeometryHelper::CenterOf(StartGeom);
+
 		// Look for a point diagonally down and right. We want the bottom right corner chosen.
 		FVector2D StartAnchorPoint = FGeometryHelper::FindClosestPointOnGeom(StartGeom, StartCenter * 100);
 		StartAnchorPoint.X -= 20.f * ZoomFactor; // Move to the left so its not exactly on the corner overlapping connected transitions.
@@ -167,12 +223,30 @@ void FSMGraphConnectionDrawingPolicy::DrawSplineWithArrow(const FGeometry& Start
 		return;
 	}
 	
-	const FVector2D EndCenter = FGeometryHelper::CenterOf(EndGeom);
-	const FVector2D SeedPoint = (StartCenter + EndCenter) * 0.5f;
+	FVector2D StartAnchorPoint;
+	FVector2D EndAnchorPoint;
 
-	// Find the (approximate) closest points between the two boxes
-	const FVector2D StartAnchorPoint = FGeometryHelper::FindClosestPointOnGeom(StartGeom, SeedPoint);
-	const FVector2D EndAnchorPoint = FGeometryHelper::FindClosestPointOnGeom(EndGeom, SeedPoint);
+	// Transition wires use the anchors cached on the transition widget, which only change when a state moves.
+	const SGraphNode_TransitionEdge* TransitionWidget = nullptr;
+	if (CurrentArrangedNodes && Params.AssociatedPin2)
+	{
+		if (USMGraphNode_TransitionEdge* TransitionNode = Cast<USMGraphNode_TransitionEdge>(Params.AssociatedPin2->GetOwningNode()))
+		{
+			if (FArrangedWidget* TransitionArrangedWidget = FindNodeWidget(*CurrentArrangedNodes, TransitionNode))
+			{
+				TransitionWidget = &static_cast<const SGraphNode_TransitionEdge&>(TransitionArrangedWidget->Widget.Get());
+			}
+		}
+	}
+
+	if (TransitionWidget)
+	{
+		TransitionWidget->GetWireAnchorPoints(StartGeom, EndGeom, StartAnchorPoint, EndAnchorPoint);
+	}
+	else
+	{
+		SGraphNode_TransitionEdge::CalculateWireAnchorPoints(StartGeom, EndGeom, StartAnchorPoint, EndAnchorPoint);
+	}
 
 	DrawSplineWithArrow(StartAnchorPoint, EndAnchorPoint, Params);
 }
@@ -206,8 +280,8 @@ void FSMGraphConnectionDrawingPolicy::Internal_DrawLineWithArrow(const FVector2D
 
 void FSMGraphConnectionDrawingPolicy::Internal_DrawCurvedLineWithArrow(const FVector2D& StartAnchorPoint, const FConnectionParams& Params)
 {
-	const float MaxX = 45.f * ZoomFactor;
-	const float MaxY = 45.f * ZoomFactor;
+	const float MaxX = SelfTransitionExtent * ZoomFactor;
+	const float MaxY = SelfTransitionExtent * ZoomFactor;
 
 	const FVector P1(StartAnchorPoint.X, StartAnchorPoint.Y, 0.f);
 	const FVector P2(StartAnchorPoint.X + MaxX, StartAnchorPoint.Y + MaxY, 0.f);
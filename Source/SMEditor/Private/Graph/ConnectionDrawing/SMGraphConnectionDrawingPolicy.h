@@ -9,7 +9,13 @@ class FSMGraphConnectionDrawingPolicy : public FConnectionDrawingPolicy
 {
 protected:
 	UEdGraph* GraphObj;
-	TMap<UEdGraphNode*, int32> NodeWidgetMap;
+
+	/** Index of each node widget in the arranged nodes. Persists across paints for this graph. */
+	TMap<UEdGraphNode*, int32>* NodeWidgetMap;
+	/** Arranged nodes of the current draw. */
+	FArrangedChildren* CurrentArrangedNodes;
+	/** The node widget map is rebuilt at most once per draw. */
+	bool bNodeWidgetMapRebuilt;
 
 public:
 	FSMGraphConnectionDrawingPolicy(int32 InBackLayerID, int32 InFrontLayerID, float ZoomFactor, const FSlateRect& InClippingRect, FSlateWindowElementList& InDrawElements, UEdGraph* InGraphObj);
@@ -25,8 +31,18 @@ public:
 	// End of FConnectionDrawingPolicy interface
 
 protected:
+	/** Find the arranged widget of a node, rebuilding the node widget map if the arrangement has changed since it was built. */
+	FArrangedWidget* FindNodeWidget(FArrangedChildren& ArrangedNodes, UEdGraphNode* Node);
+	void RebuildNodeWidgetMap(FArrangedChildren& ArrangedNodes);
+
+	/** If the link including its arrow and self transition curve is entirely outside of the clipping rect. */
+	bool IsLinkCulled(const FArrangedWidget& StartWidget, const FArrangedWidget& EndWidget) const;
+
 	void Internal_DrawLineWithArrow(const FVector2D& StartAnchorPoint, const FVector2D& EndAnchorPoint, const FConnectionParams& Params);
 	void Internal_DrawCurvedLineWithArrow(const FVector2D& StartAnchorPoint, const FConnectionParams& Params);
 	void Internal_DrawArrow(const FVector2D Pos, const FVector2D &DeltaPos, const FConnectionParams &Params);
 
+private:
+	/** Node widget maps by graph. Lookups are validated against the current arrangement so a map stays valid until nodes are added, removed, or reordered. */
+	static TMap<TWeakObjectPtr<UEdGraph>, TMap<UEdGraphNode*, int32>> NodeWidgetMaps;
 };
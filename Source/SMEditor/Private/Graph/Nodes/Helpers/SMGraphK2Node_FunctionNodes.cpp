@@ -19,6 +19,7 @@
 #include "K2Node_AddDelegate.h"
 #include "K2Node_RemoveDelegate.h"
 #include "K2Node_DynamicCast.h"
+#include "K2Node_IfThenElse.h"
 
 
 #define LOCTEXT_NAMESPACE "SMStateMachineFunctionNode"
@@ -450,18 +451,41 @@ void USMGraphK2Node_FunctionNode_TransitionEvent::CustomExpandNode(FSMKismetComp
 		CompilerContext.MessageLog.Error(TEXT("Delegate property missing for transition event node @@"), this);
 		return;
 	}
+
+	const UEdGraphSchema* Schema = GetSchema();
+
+	// Bind once for the life of the instance and ignore the event while the transition isn't initialized.
+	const bool bPersistentBinding = FSMBlueprintEditorUtils::GetProjectEditorSettings()->bPersistentTransitionEventBindings;
+	if (bPersistentBinding)
+	{
+		UFunction* IsActiveFunction = USMInstance::StaticClass()->FindFunctionByName("Internal_IsTransitionEventActive"); // Protected function.
+		check(IsActiveFunction);
+		UK2Node_CallFunction* IsActiveFunctionNode = CreateFunctionCallWithGuidInput(IsActiveFunction, CompilerContext, RuntimeNodeContainer, NodeProperty, "NodeGuid");
+
+		UK2Node_IfThenElse* BranchNode = CompilerContext.SpawnIntermediateNode<UK2Node_IfThenElse>(this, CompilerContext.ConsolidatedEventGraph);
+		BranchNode->AllocateDefaultPins();
+
+		UEdGraphPin* EventThenPin = CustomEvent->FindPinChecked(UEdGraphSchema_K2::PN_Then, EGPD_Output);
+		CompilerContext.MovePinLinksToIntermediate(*EventThenPin, *BranchNode->GetThenPin());
+
+		Schema->TryCreateConnection(EventThenPin, BranchNode->GetExecPin());
+		if (!Schema->TryCreateConnection(IsActiveFunctionNode->GetReturnValuePin(), BranchNode->GetConditionPin()))
+		{
+			CompilerContext.MessageLog.Error(TEXT("Could not gate persistent binding for transition event node @@"), this);
+			return;
+		}
+	}
 	
 	// Create initialized node to wire up binding to the event.
 	USMGraphK2Node_TransitionInitializedNode* TransitionInitializedNode = CompilerContext.ConsolidatedEventGraph->CreateIntermediateNode<USMGraphK2Node_TransitionInitializedNode>();
 	TransitionInitializedNode->AllocateDefaultPins();
 	TransitionInitializedNode->ContainerOwnerGuid = RuntimeNodeContainer->ContainerOwnerGuid;
 	TransitionInitializedNode->RuntimeNodeGuid = RuntimeNodeContainer->GetRunTimeNodeChecked()->GetNodeGuid();
+	TransitionInitializedNode->bExecuteOnInstanceInitialized = bPersistentBinding;
 	
 	UBlueprintNodeSpawner* AddSpawner = UBlueprintDelegateNodeSpawner::Create(UK2Node_AddDelegate::StaticClass(), DelegateProperty);
 	UK2Node_AddDelegate* AddDelegateNode = CastChecked<UK2Node_AddDelegate>(AddSpawner->Invoke(CompilerContext.ConsolidatedEventGraph, IBlueprintNodeBinder::FBindingSet(), FVector2D()));
 	UEdGraphPin* DelegateInputPin = AddDelegateNode->FindPin(UEdGraphSchema_K2::PN_DelegateEntry);
-
-	const UEdGraphSchema* Schema = GetSchema();
 	
 	Schema->TryCreateConnection(TransitionInitializedNode->GetOutputPin(), AddDelegateNode->GetExecPin());
 	Schema->TryCreateConnection(DelegateOutputPin, DelegateInputPin);
@@ -471,6 +495,7 @@ void USMGraphK2Node_FunctionNode_TransitionEvent::CustomExpandNode(FSMKismetComp
 	TransitionShutdownNode->AllocateDefaultPins();
 	TransitionShutdownNode->ContainerOwnerGuid = RuntimeNodeContainer->ContainerOwnerGuid;
 	TransitionShutdownNode->RuntimeNodeGuid = RuntimeNodeContainer->GetRunTimeNodeChecked()->GetNodeGuid();
+	TransitionShutdownNode->bExecuteOnInstanceShutdown = bPersistentBinding;
 
 	UBlueprintNodeSpawner* RemoveSpawner = UBlueprintDelegateNodeSpawner::Create(UK2Node_RemoveDelegate::StaticClass(), DelegateProperty);
 	UK2Node_RemoveDelegate* RemoveDelegateNode = CastChecked<UK2Node_RemoveDelegate>(RemoveSpawner->Invoke(CompilerContext.ConsolidatedEventGraph, IBlueprintNodeBinder::FBindingSet(), FVector2D()));
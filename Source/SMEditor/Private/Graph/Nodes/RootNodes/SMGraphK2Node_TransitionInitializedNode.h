@@ -28,4 +28,8 @@ class USMGraphK2Node_TransitionInitializedNode : public USMGraphK2Node_RuntimeNo
 	virtual bool CanUserDeleteNode() const override { return true; }
 	virtual bool CanDuplicateNode() const override { return true; }
 	//~ End UEdGraphNode Interface
+
+	/** Run once when the instance is initialized instead of each time the transition is initialized. Set on intermediate nodes for persistent event bindings. */
+	UPROPERTY()
+	bool bExecuteOnInstanceInitialized = false;
 };
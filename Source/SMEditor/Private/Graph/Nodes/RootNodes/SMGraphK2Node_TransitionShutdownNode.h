@@ -28,4 +28,8 @@ class USMGraphK2Node_TransitionShutdownNode : public USMGraphK2Node_RuntimeNodeR
 	virtual bool CanUserDeleteNode() const override { return true; }
 	virtual bool CanDuplicateNode() const override { return true; }
 	//~ End UEdGraphNode Interface
+
+	/** Run once when the instance is shutdown instead of each time the transition is shutdown. Set on intermediate nodes for persistent event bindings. */
+	UPROPERTY()
+	bool bExecuteOnInstanceShutdown = false;
 };
@@ -14,6 +14,9 @@
 #include "Blueprints/SMBlueprintEditor.h"
 #include "SMGraphNode_StateNode.h"
 
+uint32 USMGraphNode_Base::DebugNodeCacheGeneration = 0;
+uint32 USMGraphNode_Base::VisualCacheGeneration = 1;
+
 #define LOCTEXT_NAMESPACE "SMGraphNodeBase"
 
 /** Log a message to the message log up to 4 arguments long. */
@@ -39,6 +42,7 @@ USMGraphNode_Base::USMGraphNode_Base(const FObjectInitializer& ObjectInitializer
 	DebugTotalTime = 0.f;
 	bIsDebugActive = false;
 	bWasDebugActive = false;
+	bIsDisplayingTrace = false;
 	MaxTimeToShowDebug = 1.f;
 	BoundGraph = nullptr;
 	NodeInstanceTemplate = nullptr;
@@ -253,11 +257,22 @@ void USMGraphNode_Base::OnCompile(FSMKismetCompilerContext& CompilerContext)
 
 void USMGraphNode_Base::ResetDebugState()
 {
-	// Prevents a previous cycle from showing it as running.
-	if (const FSMNode_Base* DebugNode = GetDebugNode())
+	// Prevents a previous cycle from showing it as running. Events only report changes so start from the current state.
+	ActiveDebugPaths.Reset();
+	if (GetDebugNode() && DebugNodeCache.DebugNodes)
 	{
-		const_cast<FSMNode_Base*>(DebugNode)->bWasActive = bWasDebugActive = false;
+		for (const FSMNode_Base* DebugNode : *DebugNodeCache.DebugNodes)
+		{
+			if (DebugNode->IsActive())
+			{
+				ActiveDebugPaths.Add(DebugNode->GetGuid());
+			}
+		}
 	}
+	
+	bIsDebugActive = ActiveDebugPaths.Num() > 0;
+	bWasDebugActive = false;
+	DebugTotalTime = 0.f;
 }
 
 void USMGraphNode_Base::OnWidgetConstruct()
@@ -265,44 +280,78 @@ void USMGraphNode_Base::OnWidgetConstruct()
 	ResetDebugState();
 }
 
-void USMGraphNode_Base::UpdateTime(float DeltaTime)
+void USMGraphNode_Base::OnDebugEvent(const FSMDebugEvent& Event)
 {
-	if (const FSMNode_Base* DebugNode = GetDebugNode())
+	switch (Event.Type)
 	{
-		MaxTimeToShowDebug = GetMaxDebugTime();
-		
-		// Toggle active status and reset time if switching active states.
-		if(DebugNode->IsActive() || (DebugNode->bWasActive && !WasDebugNodeActive()))
+	case ESMDebugEventType::Entered:
 		{
+			ActiveDebugPaths.Add(Event.PathGuid);
+			bIsDebugActive = true;
 			bWasDebugActive = false;
-
-			// Was active is debug only data and exists to help us determine if we should draw an active state.
-			const_cast<FSMNode_Base*>(DebugNode)->bWasActive = false;
-			if (!IsDebugNodeActive())
-			{
-				bIsDebugActive = true;
-				DebugTotalTime = 0.f;
-			}
-		}
-		else if (IsDebugNodeActive())
-		{
-			bWasDebugActive = true;
-			bIsDebugActive = false;
 			DebugTotalTime = 0.f;
+			break;
 		}
-		// In the event a node is no longer active but is still being reported it is and we don't want to display it any more.
-		else if (WasDebugNodeActive() && !IsDebugNodeActive() && DebugTotalTime >= MaxTimeToShowDebug)
-		{
-			bWasDebugActive = false;
-		}
-		else
+	case ESMDebugEventType::Exited:
 		{
-			DebugTotalTime += DeltaTime;
+			// Stay active while another runtime node with the same NodeGuid is active.
+			// A node entered and exited in the same frame still displays as last active.
+			ActiveDebugPaths.Remove(Event.PathGuid);
+			if (IsDebugNodeActive() && ActiveDebugPaths.Num() == 0)
+			{
+				bIsDebugActive = false;
+				bWasDebugActive = true;
+				DebugTotalTime = 0.f;
+			}
+			break;
 		}
+	default:
+		break;
+	}
+}
+
+void USMGraphNode_Base::SetTraceDisplayState(bool bActive, float TimeSinceChange)
+{
+	bIsDisplayingTrace = true;
+	bIsDebugActive = bActive;
+	bWasDebugActive = !bActive && TimeSinceChange < GetMaxDebugTime();
+	DebugTotalTime = bActive ? 0.f : TimeSinceChange;
+}
+
+void USMGraphNode_Base::ClearTraceDisplayState()
+{
+	if (bIsDisplayingTrace)
+	{
+		bIsDisplayingTrace = false;
+		ResetDebugState();
+	}
+}
+
+void USMGraphNode_Base::UpdateTime(float DeltaTime)
+{
+	// The trace sets the display time directly. Otherwise there is nothing to expire unless activity is displayed.
+	if (IsDisplayingTrace() || (!bIsDebugActive && !bWasDebugActive))
+	{
+		return;
 	}
-	else
+
+	if (GetDebugNode() == nullptr)
 	{
+		ActiveDebugPaths.Reset();
 		bIsDebugActive = bWasDebugActive = false;
+		return;
+	}
+
+	MaxTimeToShowDebug = GetMaxDebugTime();
+
+	// Active status is driven by debug events, only the last active display needs to expire.
+	if (WasDebugNodeActive() && DebugTotalTime >= MaxTimeToShowDebug)
+	{
+		bWasDebugActive = false;
+	}
+	else if (!IsDebugNodeActive())
+	{
+		DebugTotalTime += DeltaTime;
 	}
 }
 
@@ -445,20 +494,57 @@ FSMNode_Base* USMGraphNode_Base::FindRuntimeNode() const
 
 const FSMNode_Base* USMGraphNode_Base::GetDebugNode() const
 {
-	USMBlueprint* Blueprint = CastChecked<USMBlueprint>(FSMBlueprintEditorUtils::FindBlueprintForNode(this));
+	// Called several times per node each frame while debugging. Only resolve the runtime node when the debug object changes.
+	if (DebugNodeCache.Generation != DebugNodeCacheGeneration || !DebugNodeCache.Blueprint.IsValid())
+	{
+		DebugNodeCache = FDebugNodeCache();
+		DebugNodeCache.Blueprint = FSMBlueprintEditorUtils::FindBlueprintForNode(this);
+		DebugNodeCache.Generation = DebugNodeCacheGeneration;
+	}
 
-	if (USMInstance* Instance = Cast<USMInstance>(Blueprint->GetObjectBeingDebugged()))
+	UBlueprint* Blueprint = DebugNodeCache.Blueprint.Get();
+	USMInstance* Instance = Blueprint ? Cast<USMInstance>(Blueprint->GetObjectBeingDebugged()) : nullptr;
+	if (!Instance)
 	{
-		if (FSMNode_Base* RuntimeNode = FindRuntimeNode())
-		{
-			const FSMDebugStateMachine& DebugMachine = Instance->GetDebugStateMachineConst();
+		return nullptr;
+	}
 
-			// Find the real runtime node being debugged.
-			return DebugMachine.GetRuntimeNode(RuntimeNode->GetNodeGuid());
-		}
+	const FSMDebugStateMachine& DebugMachine = Instance->GetDebugStateMachineConst();
+	if (DebugNodeCache.Instance != Instance || DebugNodeCache.MappingVersion != DebugMachine.GetMappingVersion())
+	{
+		DebugNodeCache.Instance = Instance;
+		DebugNodeCache.MappingVersion = DebugMachine.GetMappingVersion();
+
+		// Find the real runtime node being debugged.
+		const FSMNode_Base* RuntimeNode = FindRuntimeNode();
+		DebugNodeCache.DebugNodes = RuntimeNode ? DebugMachine.FindRuntimeNodes(RuntimeNode->GetNodeGuid()) : nullptr;
 	}
 
-	return nullptr;
+	return DebugNodeCache.DebugNodes ? FSMDebugStateMachine::ResolveRuntimeNode(*DebugNodeCache.DebugNodes) : nullptr;
+}
+
+uint32 USMGraphNode_Base::GetDebugNodeCacheGeneration()
+{
+	return DebugNodeCacheGeneration;
+}
+
+void USMGraphNode_Base::InvalidateDebugNodeCaches()
+{
+	DebugNodeCacheGeneration++;
+}
+
+void USMGraphNode_Base::InvalidateVisualCaches()
+{
+	// Zero is reserved for caches which have never been built.
+	if (++VisualCacheGeneration == 0)
+	{
+		VisualCacheGeneration = 1;
+	}
+}
+
+uint32 USMGraphNode_Base::GetVisualCacheGeneration()
+{
+	return VisualCacheGeneration;
 }
 
 float USMGraphNode_Base::GetMaxDebugTime() const
@@ -473,7 +559,7 @@ FLinearColor USMGraphNode_Base::GetBackgroundColor() const
 	const FLinearColor BaseColor = Internal_GetBackgroundColor() * (CustomColor ? *CustomColor : FLinearColor(1.f, 1.f, 1.f, 1.f));
 	const FLinearColor ActiveColor = GetActiveBackgroundColor();
 
-	if (GetDebugNode() == nullptr)
+	if (!HasDebugDisplay())
 	{
 		return BaseColor;
 	}
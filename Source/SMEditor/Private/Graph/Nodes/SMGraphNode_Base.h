@@ -17,6 +17,8 @@ class USMGraph;
 class SGraphNode_StateNode;
 class FSMKismetCompilerContext;
 struct FSMNode_Base;
+struct FSMDebugEvent;
+class USMInstance;
 
 USTRUCT()
 struct FSMGraphNodeLog
@@ -84,6 +86,14 @@ public:
 	/** So we can pass time ticks for specific node appearance behavior. */
 	virtual void UpdateTime(float DeltaTime);
 
+	/** Called by the blueprint editor for each activity event of the debugged runtime node. */
+	virtual void OnDebugEvent(const FSMDebugEvent& Event);
+
+	/** Display a recorded state instead of the debug object. Last active display fades by the time since the node changed. */
+	void SetTraceDisplayState(bool bActive, float TimeSinceChange);
+	void ClearTraceDisplayState();
+	bool IsDisplayingTrace() const { return bIsDisplayingTrace; }
+
 	/** Helper to set error messages that may happen before compile. */
 	virtual void CheckSetErrorMessages() {}
 
@@ -166,13 +176,24 @@ public:
 	
 	/** Helper to locate the runtime node this node represents. */
 	FSMNode_Base* FindRuntimeNode() const;
-	/** Locates the current debug node if one exists. */
+	/** Locates the current debug node if one exists. The lookup is cached per debug object. */
 	const FSMNode_Base* GetDebugNode() const;
+	/** Clear the cached debug node of every graph node. Call when runtime node guids may have changed. */
+	static void InvalidateDebugNodeCaches();
+	/** Changes whenever debug node caches are invalidated. */
+	static uint32 GetDebugNodeCacheGeneration();
+
+	/** Invalidate display values derived from graph contents or settings. Called when any object is modified or on undo. */
+	static void InvalidateVisualCaches();
+	/** Changes whenever visual caches are invalidated. */
+	static uint32 GetVisualCacheGeneration();
 	
 	float GetDebugTime() const { return DebugTotalTime; }
 	virtual float GetMaxDebugTime() const;
 	bool IsDebugNodeActive() const { return bIsDebugActive; }
 	bool WasDebugNodeActive() const { return bWasDebugActive; }
+	/** If there is a debug object or trace to display. */
+	bool HasDebugDisplay() const { return bIsDisplayingTrace || GetDebugNode() != nullptr; }
 
 	virtual FName GetFriendlyNodeName() const { return "Node"; }
 
@@ -218,13 +239,39 @@ protected:
 	/** Resets on active change. */
 	float DebugTotalTime;
 	float MaxTimeToShowDebug;
+
+	/** Path guids of the active runtime nodes sharing this node's NodeGuid, such as duplicate parent or reference nodes. */
+	TSet<FGuid> ActiveDebugPaths;
 	
 	uint32 bIsDebugActive:	1;
 	uint32 bWasDebugActive: 1;
+	uint32 bIsDisplayingTrace: 1;
 
 	uint32 bIsPrecompiling: 1;
 	uint32 bJustPasted:		1;
 
+private:
+	/** The debug node lookup for the current debug object. Rebuilt when the debug object or its node map changes. */
+	struct FDebugNodeCache
+	{
+		TWeakObjectPtr<UBlueprint> Blueprint;
+		TWeakObjectPtr<USMInstance> Instance;
+
+		/** Runtime nodes in the debug object's node map. Owned by the instance. */
+		const TArray<FSMNode_Base*>* DebugNodes = nullptr;
+
+		uint32 MappingVersion = 0;
+		uint32 Generation = 0;
+	};
+
+	mutable FDebugNodeCache DebugNodeCache;
+
+	/** Incremented to invalidate all debug node caches. */
+	static uint32 DebugNodeCacheGeneration;
+
+	/** Incremented to invalidate cached display values. */
+	static uint32 VisualCacheGeneration;
+
 public:
 	/** Member flag for forcing guid regeneration. */
 	uint32 bRequiresGuidRegeneration:	1;
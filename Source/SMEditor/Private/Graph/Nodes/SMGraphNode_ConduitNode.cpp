@@ -9,6 +9,7 @@
 #include "RootNodes/SMGraphK2Node_TransitionShutdownNode.h"
 #include "RootNodes/SMGraphK2Node_TransitionEnteredNode.h"
 #include "Utilities/SMBlueprintEditorUtils.h"
+#include "SMDebugEventBuffer.h"
 
 
 #define LOCTEXT_NAMESPACE "SMGraphConduitNode"
@@ -92,35 +93,11 @@ void USMGraphNode_ConduitNode::ResetDebugState()
 	Super::ResetDebugState();
 
 	// Prevents a previous cycle from showing it as running.
-	if (const FSMConduit* DebugNode = (FSMConduit*)GetDebugNode())
-	{
-		const_cast<FSMConduit*>(DebugNode)->bWasEvaluating = bWasEvaluating = false;
-	}
+	bWasEvaluating = false;
 }
 
 void USMGraphNode_ConduitNode::UpdateTime(float DeltaTime)
 {
-	const USMEditorSettings* Settings = FSMBlueprintEditorUtils::GetEditorSettings();
-	if (ShouldEvalWithTransitions() && Settings->bDisplayTransitionEvaluation)
-	{
-		if (const FSMConduit* DebugNode = (FSMConduit*)GetDebugNode())
-		{
-			if (WasEvaluating() && (DebugNode->IsActive() || DebugNode->bWasActive))
-			{
-				// Cancel evaluation display and let the super method reset.
-				bWasEvaluating = false;
-				bWasDebugActive = false;
-			}
-			else if (DebugNode->bIsEvaluating || DebugNode->bWasEvaluating)
-			{
-				// Not active but evaluating.
-				bIsDebugActive = true;
-				bWasEvaluating = true;
-			}
-			const_cast<FSMConduit*>(DebugNode)->bWasEvaluating = false;
-		}
-	}
-
 	Super::UpdateTime(DeltaTime);
 
 	if (!WasDebugNodeActive())
@@ -129,6 +106,27 @@ void USMGraphNode_ConduitNode::UpdateTime(float DeltaTime)
 	}
 }
 
+void USMGraphNode_ConduitNode::OnDebugEvent(const FSMDebugEvent& Event)
+{
+	if (Event.Type == ESMDebugEventType::Evaluated)
+	{
+		const USMEditorSettings* Settings = FSMBlueprintEditorUtils::GetEditorSettings();
+		if (ShouldEvalWithTransitions() && Settings->bDisplayTransitionEvaluation && !IsDebugNodeActive())
+		{
+			// Not active but evaluating. Display as last active so the evaluation color fades out.
+			bWasEvaluating = true;
+			bWasDebugActive = true;
+			DebugTotalTime = 0.f;
+		}
+
+		return;
+	}
+
+	// Cancel evaluation display and let the super method take over.
+	bWasEvaluating = false;
+	Super::OnDebugEvent(Event);
+}
+
 void USMGraphNode_ConduitNode::ImportDeprecatedProperties()
 {
 	Super::ImportDeprecatedProperties();
@@ -154,6 +152,10 @@ void USMGraphNode_ConduitNode::SetRuntimeDefaults(FSMState_Base& State) const
 {
 	Super::SetRuntimeDefaults(State);
 	((FSMConduit&)State).bEvalWithTransitions = ShouldEvalWithTransitions();
+	if (USMConduitGraph* ConduitGraph = Cast<USMConduitGraph>(GetBoundGraph()))
+	{
+		((FSMConduit&)State).ConditionalEvaluationType = ConduitGraph->GetConditionalEvaluationType();
+	}
 	if(USMConduitInstance* Instance = Cast<USMConduitInstance>(GetNodeTemplate()))
 	{
 		((FSMConduit&)State).bCanEvaluate = Instance->bCanEvaluate;
@@ -35,6 +35,7 @@ class USMGraphNode_ConduitNode : public USMGraphNode_StateNodeBase
 	// USMGraphNode_Base
 	virtual void ResetDebugState() override;
 	virtual void UpdateTime(float DeltaTime) override;
+	virtual void OnDebugEvent(const FSMDebugEvent& Event) override;
 	virtual void ImportDeprecatedProperties() override;
 	virtual void PlaceDefaultInstanceNodes() override;
 	virtual UClass* GetNodeClass() const override { return ConduitClass; }
@@ -14,6 +14,7 @@
 #include "RootNodes/SMGraphK2Node_TransitionEnteredNode.h"
 #include "RootNodes/SMGraphK2Node_TransitionInitializedNode.h"
 #include "RootNodes/SMGraphK2Node_TransitionShutdownNode.h"
+#include "SMDebugEventBuffer.h"
 
 
 #define LOCTEXT_NAMESPACE "SMGraphTransition"
@@ -22,7 +23,7 @@ USMGraphNode_TransitionEdge::USMGraphNode_TransitionEdge(const FObjectInitialize
 	: Super(ObjectInitializer), DelegateOwnerInstance(SMDO_This), DelegateOwnerClass(nullptr),
 	  PriorityOrder_DEPRECATED(0),
 	  bCanEvaluate_DEPRECATED(true), bCanEvaluateFromEvent_DEPRECATED(true), bCanEvalWithStartState_DEPRECATED(true),
-	  bWasEvaluating(false)
+	  bWasEvaluating(false), CachedBackgroundColor(ForceInit), CachedBackgroundColorGeneration(0)
 {
 	bCanRenameNode = false;
 }
@@ -190,35 +191,11 @@ void USMGraphNode_TransitionEdge::ResetDebugState()
 	Super::ResetDebugState();
 
 	// Prevents a previous cycle from showing it as running.
-	if (const FSMTransition* DebugNode = (FSMTransition*)GetDebugNode())
-	{
-		const_cast<FSMTransition*>(DebugNode)->bWasEvaluating = bWasEvaluating = false;
-	}
+	bWasEvaluating = false;
 }
 
 void USMGraphNode_TransitionEdge::UpdateTime(float DeltaTime)
 {
-	const USMEditorSettings* Settings = FSMBlueprintEditorUtils::GetEditorSettings();
-	if (Settings->bDisplayTransitionEvaluation)
-	{
-		if (const FSMTransition* DebugNode = (FSMTransition*)GetDebugNode())
-		{
-			if (WasEvaluating() && (DebugNode->IsActive() || DebugNode->bWasActive))
-			{
-				// Cancel evaluation display and let the super method reset.
-				bWasEvaluating = false;
-				bWasDebugActive = false;
-			}
-			else if (DebugNode->bIsEvaluating || DebugNode->bWasEvaluating)
-			{
-				// Not active but evaluating.
-				bIsDebugActive = true;
-				bWasEvaluating = true;
-			}
-			const_cast<FSMTransition*>(DebugNode)->bWasEvaluating = false;
-		}
-	}
-
 	Super::UpdateTime(DeltaTime);
 
 	if (!WasDebugNodeActive())
@@ -227,6 +204,27 @@ void USMGraphNode_TransitionEdge::UpdateTime(float DeltaTime)
 	}
 }
 
+void USMGraphNode_TransitionEdge::OnDebugEvent(const FSMDebugEvent& Event)
+{
+	if (Event.Type == ESMDebugEventType::Evaluated)
+	{
+		const USMEditorSettings* Settings = FSMBlueprintEditorUtils::GetEditorSettings();
+		if (Settings->bDisplayTransitionEvaluation && !IsDebugNodeActive())
+		{
+			// Not active but evaluating. Display as last active so the evaluation color fades out.
+			bWasEvaluating = true;
+			bWasDebugActive = true;
+			DebugTotalTime = 0.f;
+		}
+
+		return;
+	}
+
+	// Cancel evaluation display and let the super method take over.
+	bWasEvaluating = false;
+	Super::OnDebugEvent(Event);
+}
+
 void USMGraphNode_TransitionEdge::ImportDeprecatedProperties()
 {
 	Super::ImportDeprecatedProperties();
@@ -532,6 +530,18 @@ FLinearColor USMGraphNode_TransitionEdge::GetTransitionColor(bool bIsHovered) co
 }
 
 FLinearColor USMGraphNode_TransitionEdge::Internal_GetBackgroundColor() const
+{
+	const uint32 Generation = GetVisualCacheGeneration();
+	if (CachedBackgroundColorGeneration != Generation)
+	{
+		CachedBackgroundColor = CalculateBackgroundColor();
+		CachedBackgroundColorGeneration = Generation;
+	}
+
+	return CachedBackgroundColor;
+}
+
+FLinearColor USMGraphNode_TransitionEdge::CalculateBackgroundColor() const
 {
 	const USMEditorSettings* Settings = FSMBlueprintEditorUtils::GetEditorSettings();
 	const FLinearColor ColorModifier = GetCustomBackgroundColor() ? *GetCustomBackgroundColor() : FLinearColor(1.f, 1.f, 1.f, 1.f);
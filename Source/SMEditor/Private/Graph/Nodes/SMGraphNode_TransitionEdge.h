@@ -85,6 +85,7 @@ class SMEDITOR_API USMGraphNode_TransitionEdge : public USMGraphNode_Base
 	// USMGraphNode_Base
 	virtual void ResetDebugState() override;
 	virtual void UpdateTime(float DeltaTime) override;
+	virtual void OnDebugEvent(const FSMDebugEvent& Event) override;
 	virtual void ImportDeprecatedProperties() override;
 	virtual void PlaceDefaultInstanceNodes() override;
 	virtual FName GetFriendlyNodeName() const override { return "Transition"; }
@@ -124,7 +125,13 @@ class SMEDITOR_API USMGraphNode_TransitionEdge : public USMGraphNode_Base
 	bool WasEvaluating() const { return bWasEvaluating; }
 protected:
 	virtual FLinearColor Internal_GetBackgroundColor() const override;
+	/** Determine the color from the transition graph contents. */
+	FLinearColor CalculateBackgroundColor() const;
 	void SetDefaultsWhenPlaced();
 
 	bool bWasEvaluating;
+
+	/** Background color is drawn every frame but only changes when the graph or settings are edited. */
+	mutable FLinearColor CachedBackgroundColor;
+	mutable uint32 CachedBackgroundColorGeneration;
 };
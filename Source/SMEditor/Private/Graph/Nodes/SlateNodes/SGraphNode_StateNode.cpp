@@ -9,6 +9,7 @@
 #include "GraphEditorSettings.h"
 #include "Templates/SharedPointer.h"
 #include "Widgets/Images/SImage.h"
+#include "Widgets/Layout/SSpacer.h"
 #include "Widgets/SToolTip.h"
 #include "Widgets/SWidget.h"
 #include "Widgets/SBoxPanel.h"
@@ -121,16 +122,32 @@ void SGraphNode_StateNode::UpdateGraphNode()
 							.ToolTipText(this, &SGraphNode_StateNode::GetErrorMsgToolTip)
 						]
 						+ SHorizontalBox::Slot()
-							.AutoWidth()
-							.VAlign(VAlign_Center)
+						.AutoWidth()
+						[
+							// Zoomed out only the name area's size is kept. Avoids painting text and icons which can't be read.
+							SNew(SLevelOfDetailBranchNode)
+							.UseLowDetailSlot(this, &SGraphNode_StateNode::UseLowDetailNodeContent)
+							.LowDetail()
 							[
-								SNew(SImage)
-								.Image(NodeTypeIcon)
+								SNew(SSpacer)
+								.Size(this, &SGraphNode_StateNode::GetLowDetailContentSize)
+							]
+							.HighDetail()
+							[
+								SAssignNew(HighDetailContent, SHorizontalBox)
+								+ SHorizontalBox::Slot()
+									.AutoWidth()
+									.VAlign(VAlign_Center)
+									[
+										SNew(SImage)
+										.Image(NodeTypeIcon)
+									]
+								+ SHorizontalBox::Slot()
+								.Padding(ContentPadding)
+								[
+									ContentBox.ToSharedRef()
+								]
 							]
-						+ SHorizontalBox::Slot()
-						.Padding(ContentPadding)
-						[
-							ContentBox.ToSharedRef()
 						]
 					]
 				]
@@ -209,7 +226,7 @@ TArray<FOverlayWidgetInfo> SGraphNode_StateNode::GetOverlayWidgets(bool bSelecte
 	TArray<FOverlayWidgetInfo> Widgets;
 
 	const USMEditorSettings* EditorSettings = FSMBlueprintEditorUtils::GetEditorSettings();
-	if (!EditorSettings->bDisableVisualCues)
+	if (!EditorSettings->bDisableVisualCues && !UseLowDetailNodeContent())
 	{
 		if (USMGraphNode_StateNodeBase* StateNode = Cast<USMGraphNode_StateNodeBase>(GraphNode))
 		{
@@ -423,6 +440,23 @@ TSharedPtr<SVerticalBox> SGraphNode_StateNode::CreateContentBox()
 	return Content;
 }
 
+bool SGraphNode_StateNode::UseLowDetailNodeContent() const
+{
+	// Keep the name visible while it's being edited.
+	if (InlineEditableText.IsValid() && InlineEditableText->IsInEditMode())
+	{
+		return false;
+	}
+
+	return GetCurrentLOD() <= EGraphRenderingLOD::LowestDetail;
+}
+
+FVector2D SGraphNode_StateNode::GetLowDetailContentSize() const
+{
+	// Only the active detail level is prepassed, so this is the size from when the node was last fully displayed.
+	return HighDetailContent.IsValid() ? HighDetailContent->GetDesiredSize() : FVector2D::ZeroVector;
+}
+
 FSlateColor SGraphNode_StateNode::GetBorderBackgroundColor() const
 {
 	USMGraphNode_StateNodeBase* StateNode = CastChecked<USMGraphNode_StateNodeBase>(GraphNode);
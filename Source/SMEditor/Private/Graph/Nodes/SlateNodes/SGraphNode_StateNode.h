@@ -40,8 +40,14 @@ protected:
 	virtual TSharedRef<SVerticalBox> BuildComplexTooltip();
 	virtual UEdGraph* GetGraphToUseForTooltip() const;
 
+	/** If the graph is zoomed out far enough to skip drawing the node's icon and name. */
+	bool UseLowDetailNodeContent() const;
+	FVector2D GetLowDetailContentSize() const;
+
 protected:
 	TSharedPtr<SGraphPreviewer> GraphPreviewer;
+	/** Icon and name area, swapped for a spacer of the same size at low detail. */
+	TSharedPtr<SWidget> HighDetailContent;
 	TSharedPtr<SWidget> AnyStateImpactWidget;
 	FMargin ContentPadding;
 	const int32 OverlayWidgetPadding = 25;
@@ -286,11 +286,9 @@ void SGraphNode_TransitionEdge::PositionBetweenTwoNodesWithOffset(const FGeometr
 		return;
 	}
 
-	const FVector2D SeedPoint = (StartCenter + EndCenter) * 0.5f;
-
-	// Find the (approximate) closest points between the two boxes
-	const FVector2D StartAnchorPoint = FGeometryHelper::FindClosestPointOnGeom(StartGeom, SeedPoint);
-	const FVector2D EndAnchorPoint = FGeometryHelper::FindClosestPointOnGeom(EndGeom, SeedPoint);
+	FVector2D StartAnchorPoint;
+	FVector2D EndAnchorPoint;
+	CalculateWireAnchorPoints(StartGeom, EndGeom, StartAnchorPoint, EndAnchorPoint);
 
 	// Position ourselves halfway along the connecting line between the nodes, elevated away perpendicular to the direction of the line
 	const float Height = 30.0f;
@@ -327,6 +325,50 @@ void SGraphNode_TransitionEdge::PositionBetweenTwoNodesWithOffset(const FGeometr
 	GraphNode->NodePosY = NewCorner.Y;
 }
 
+void SGraphNode_TransitionEdge::CalculateWireAnchorPoints(const FGeometry& StartGeom, const FGeometry& EndGeom, FVector2D& OutStartAnchor, FVector2D& OutEndAnchor)
+{
+	// Get a reasonable seed point (halfway between the boxes)
+	const FVector2D StartCenter = FGeometryHelper::CenterOf(StartGeom);
+	const FVector2D EndCenter = FGeometryHelper::CenterOf(EndGeom);
+	const FVector2D SeedPoint = (StartCenter + EndCenter) * 0.5f;
+
+	// Find the (approximate) closest points between the two boxes
+	OutStartAnchor = FGeometryHelper::FindClosestPointOnGeom(StartGeom, SeedPoint);
+	OutEndAnchor = FGeometryHelper::FindClosestPointOnGeom(EndGeom, SeedPoint);
+}
+
+void SGraphNode_TransitionEdge::GetWireAnchorPoints(const FGeometry& StartGeom, const FGeometry& EndGeom, FVector2D& OutStartAnchor, FVector2D& OutEndAnchor) const
+{
+	USMGraphNode_TransitionEdge* EdgeNode = CastChecked<USMGraphNode_TransitionEdge>(GraphNode);
+	const USMGraphNode_StateNodeBase* FromState = EdgeNode->GetFromState();
+	const USMGraphNode_StateNodeBase* ToState = EdgeNode->GetToState();
+
+	const FIntPoint StartPosition = FromState ? FIntPoint(FromState->NodePosX, FromState->NodePosY) : FIntPoint::ZeroValue;
+	const FIntPoint EndPosition = ToState ? FIntPoint(ToState->NodePosX, ToState->NodePosY) : FIntPoint::ZeroValue;
+	const FVector2D StartSize = StartGeom.GetLocalSize();
+	const FVector2D EndSize = EndGeom.GetLocalSize();
+
+	FWireGeometryCache& Cache = WireGeometryCache;
+	if (!Cache.bIsValid || Cache.StartPosition != StartPosition || Cache.EndPosition != EndPosition ||
+		Cache.StartSize != StartSize || Cache.EndSize != EndSize)
+	{
+		CalculateWireAnchorPoints(StartGeom, EndGeom, OutStartAnchor, OutEndAnchor);
+
+		Cache.StartLocalAnchor = StartGeom.AbsoluteToLocal(OutStartAnchor);
+		Cache.EndLocalAnchor = EndGeom.AbsoluteToLocal(OutEndAnchor);
+		Cache.StartPosition = StartPosition;
+		Cache.EndPosition = EndPosition;
+		Cache.StartSize = StartSize;
+		Cache.EndSize = EndSize;
+		Cache.bIsValid = true;
+
+		return;
+	}
+
+	OutStartAnchor = StartGeom.LocalToAbsolute(Cache.StartLocalAnchor);
+	OutEndAnchor = EndGeom.LocalToAbsolute(Cache.EndLocalAnchor);
+}
+
 FSlateColor SGraphNode_TransitionEdge::GetEdgeColor() const
 {
 	return FLinearColor(0.9f, 0.9f, 0.9f, 1.0f);
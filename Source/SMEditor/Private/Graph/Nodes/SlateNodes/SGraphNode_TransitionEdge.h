@@ -36,8 +36,30 @@ public:
 	// Calculate position for multiple nodes to be placed between a start and end point, by providing this nodes index and max expected nodes 
 	void PositionBetweenTwoNodesWithOffset(const FGeometry& StartGeom, const FGeometry& EndGeom, int32 NodeIndex, int32 MaxNodes) const;
 
+	/** Find the closest points between two state geometries for drawing the wire. */
+	static void CalculateWireAnchorPoints(const FGeometry& StartGeom, const FGeometry& EndGeom, FVector2D& OutStartAnchor, FVector2D& OutEndAnchor);
+
+	/** Wire anchor points for this transition's states. Cached until either state moves or resizes. */
+	void GetWireAnchorPoints(const FGeometry& StartGeom, const FGeometry& EndGeom, FVector2D& OutStartAnchor, FVector2D& OutEndAnchor) const;
+
 protected:
 	FSlateColor GetEdgeColor() const;
 	const FSlateBrush* GetIcon() const;
 
+private:
+	struct FWireGeometryCache
+	{
+		/** Anchors in the local space of each state so panning and zooming don't invalidate them. */
+		FVector2D StartLocalAnchor = FVector2D::ZeroVector;
+		FVector2D EndLocalAnchor = FVector2D::ZeroVector;
+
+		FIntPoint StartPosition = FIntPoint::ZeroValue;
+		FIntPoint EndPosition = FIntPoint::ZeroValue;
+		FVector2D StartSize = FVector2D::ZeroVector;
+		FVector2D EndSize = FVector2D::ZeroVector;
+
+		bool bIsValid = false;
+	};
+
+	mutable FWireGeometryCache WireGeometryCache;
 };
@@ -27,3 +27,21 @@ bool USMConduitGraph::HasAnyLogicConnections() const
 
 	return false;
 }
+
+ESMConditionalEvaluationType USMConduitGraph::GetConditionalEvaluationType() const
+{
+	TArray<USMGraphK2Node_ConduitResultNode*> RootNodeList;
+	FSMBlueprintEditorUtils::GetAllNodesOfClassNested<USMGraphK2Node_ConduitResultNode>(const_cast<USMConduitGraph*>(this), RootNodeList);
+
+	for (USMGraphK2Node_RootNode* RootNode : RootNodeList)
+	{
+		UEdGraphPin* Pin = RootNode->GetInputPin();
+		
+		if (Pin->LinkedTo.Num() == 0)
+		{
+			return Pin->DefaultValue.ToBool() ? ESMConditionalEvaluationType::SM_AlwaysTrue : ESMConditionalEvaluationType::SM_AlwaysFalse;
+		}
+	}
+
+	return ESMConditionalEvaluationType::SM_Graph;
+}
@@ -17,6 +17,9 @@ public:
 	virtual FSMNode_Base* GetRuntimeNode() const override { return ResultNode->GetRunTimeNode(); }
 	// ~USMGraphK2
 
+	/** If the result is a constant the conduit graph doesn't need to run when evaluating. */
+	ESMConditionalEvaluationType GetConditionalEvaluationType() const;
+
 public:
 	UPROPERTY()
 	class USMGraphK2Node_ConduitResultNode* ResultNode;
@@ -16,6 +16,7 @@
 #include "PropertyEditorModule.h"
 #include "Customization/SMEditorCustomization.h"
 #include "Framework/Notifications/NotificationManager.h"
+#include "Graph/Nodes/SMGraphNode_Base.h"
 #include "Graph/Nodes/SMGraphNode_ConduitNode.h"
 #include "Graph/Nodes/SMGraphNode_StateMachineStateNode.h"
 #include "Graph/Nodes/SMGraphNode_TransitionEdge.h"
@@ -51,6 +52,10 @@ void FSMEditorModule::StartupModule()
 	FEdGraphUtilities::RegisterVisualPinFactory(SMGraphPinNodeFactory);
 
 	RefreshAllNodesDelegateHandle = FSMBlueprintEditorUtils::OnRefreshAllNodesEvent.AddStatic(&FSMBlueprintEditorUtils::HandleRefreshAllNodes);
+
+	// Graph display values are cached until anything is edited.
+	ObjectModifiedHandle = FCoreUObjectDelegates::OnObjectModified.AddRaw(this, &FSMEditorModule::OnObjectModified);
+	PostUndoRedoHandle = FEditorDelegates::PostUndoRedo.AddStatic(&USMGraphNode_Base::InvalidateVisualCaches);
 	
 	// Register details customization.
 	FPropertyEditorModule& PropertyModule = FModuleManager::LoadModuleChecked<FPropertyEditorModule>("PropertyEditor");
@@ -103,6 +108,8 @@ void FSMEditorModule::ShutdownModule()
 	FEdGraphUtilities::UnregisterVisualPinFactory(SMGraphPinNodeFactory);
 
 	FSMBlueprintEditorUtils::OnRefreshAllNodesEvent.Remove(RefreshAllNodesDelegateHandle);
+	FCoreUObjectDelegates::OnObjectModified.Remove(ObjectModifiedHandle);
+	FEditorDelegates::PostUndoRedo.Remove(PostUndoRedoHandle);
 	
 	FPropertyEditorModule& PropertyModule = FModuleManager::LoadModuleChecked<FPropertyEditorModule>("PropertyEditor");
 	ClassLayoutContext.UnregisterCustomClassLayouts(PropertyModule);
@@ -163,6 +170,11 @@ void FSMEditorModule::UnregisterSettings()
 	}
 }
 
+void FSMEditorModule::OnObjectModified(UObject* Object)
+{
+	USMGraphNode_Base::InvalidateVisualCaches();
+}
+
 void FSMEditorModule::BeginPIE(bool bValue)
 {
 	bPlayingInEditor = true;
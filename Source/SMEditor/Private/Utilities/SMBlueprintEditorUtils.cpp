@@ -419,23 +419,7 @@ UClass* FSMBlueprintEditorUtils::GetStateMachineClassFromGraph(const UEdGraph* G
 const FSMNode_Base* FSMBlueprintEditorUtils::GetDebugNode(USMGraphNode_Base* Node)
 {
 	check(Node);
-
-	if (UBlueprint* ThisBlueprint = FindBlueprintForNode(Node))
-	{
-		if (USMInstance* CurrentDebugObject = Cast<USMInstance>(ThisBlueprint->GetObjectBeingDebugged()))
-		{
-			if (FSMNode_Base* RuntimeNode = GetRuntimeNodeFromGraph(Node->GetBoundGraph()))
-			{
-				// Find the correct runtime instance mapping to this node.
-				if (const FSMNode_Base* RealRuntimeNode = CurrentDebugObject->GetDebugStateMachineConst().GetRuntimeNode(RuntimeNode->GetNodeGuid()))
-				{
-					return RealRuntimeNode;
-				}
-			}
-		}
-	}
-
-	return nullptr;
+	return Node->GetDebugNode();
 }
 
 void FSMBlueprintEditorUtils::FindRuntimeNodeWithOwners(const UEdGraph* Graph, TArray<const FSMNode_Base*>& RuntimeNodesOrdered, TSet<const UObject*>* StopOnOuters)
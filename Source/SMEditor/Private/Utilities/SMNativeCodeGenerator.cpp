@@ -0,0 +1,832 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "SMNativeCodeGenerator.h"
+#include "Blueprints/SMBlueprint.h"
+#include "Blueprints/SMBlueprintGeneratedClass.h"
+#include "Utilities/SMBlueprintEditorUtils.h"
+#include "Graph/SMTransitionGraph.h"
+#include "Graph/SMConduitGraph.h"
+#include "Graph/Nodes/SMGraphNode_Base.h"
+#include "SMInstance.h"
+#include "SMConduit.h"
+#include "SMUtils.h"
+#include "K2Node_VariableGet.h"
+#include "K2Node_CallFunction.h"
+#include "K2Node_Knot.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "UObject/StructOnScope.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+namespace SMNativeCodeGenerator
+{
+	/** Nested expressions deeper than this are left to the blueprint. */
+	static constexpr int32 MaxExpressionDepth = 32;
+
+	struct FNodeEntry
+	{
+		UScriptStruct* Struct = nullptr;
+		const FSMNode_Base* Node = nullptr;
+		FString MemberName;
+	};
+
+	struct FFunctionEntry
+	{
+		FString Name;
+		FString MemberName;
+
+		/** Set if this is a condition converted to native code. */
+		FString NativeExpression;
+
+		/** The condition can't be converted and is evaluated by a blueprint event returning the result. */
+		bool bIsBlueprintCondition = false;
+	};
+
+	static bool IsValidIdentifier(const FString& Name)
+	{
+		if (Name.IsEmpty() || FChar::IsDigit(Name[0]))
+		{
+			return false;
+		}
+
+		for (const TCHAR Char : Name)
+		{
+			if (Char > 127 || !(FChar::IsAlnum(Char) || Char == TEXT('_')))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	static FString MakeIdentifier(const FString& Prefix, const FString& Name, TSet<FString>& UsedNames)
+	{
+		FString Identifier = Prefix;
+		for (const TCHAR Char : Name)
+		{
+			Identifier.AppendChar(Char <= 127 && FChar::IsAlnum(Char) ? Char : TEXT('_'));
+		}
+
+		FString UniqueIdentifier = Identifier;
+		for (int32 Suffix = 1; UsedNames.Contains(UniqueIdentifier); ++Suffix)
+		{
+			UniqueIdentifier = FString::Printf(TEXT("%s_%d"), *Identifier, Suffix);
+		}
+
+		UsedNames.Add(UniqueIdentifier);
+		return UniqueIdentifier;
+	}
+
+	static FString GetNodePrefix(const UScriptStruct* Struct)
+	{
+		if (Struct->IsChildOf(FSMTransition::StaticStruct()))
+		{
+			return TEXT("Transition_");
+		}
+		if (Struct->IsChildOf(FSMConduit::StaticStruct()))
+		{
+			return TEXT("Conduit_");
+		}
+		if (Struct->IsChildOf(FSMStateMachine::StaticStruct()))
+		{
+			return TEXT("StateMachine_");
+		}
+
+		return TEXT("State_");
+	}
+
+	static int32 GetNodeSortOrder(const UScriptStruct* Struct)
+	{
+		if (Struct->IsChildOf(FSMTransition::StaticStruct()))
+		{
+			return 3;
+		}
+		if (Struct->IsChildOf(FSMConduit::StaticStruct()))
+		{
+			return 2;
+		}
+		if (Struct->IsChildOf(FSMStateMachine::StaticStruct()))
+		{
+			return 0;
+		}
+
+		return 1;
+	}
+
+	static bool IsCondition(const UScriptStruct* Struct, const FProperty* HandlerProperty)
+	{
+		return HandlerProperty->GetFName() == GET_MEMBER_NAME_CHECKED(FSMNode_Base, GraphEvaluator) &&
+			(Struct->IsChildOf(FSMTransition::StaticStruct()) || Struct->IsChildOf(FSMConduit::StaticStruct()));
+	}
+
+	/** Name the generated function after the node member and the handler it replaces. */
+	static FString MakeFunctionName(const FString& MemberName, const UScriptStruct* Struct, const FProperty* HandlerProperty, int32 ArrayIndex, TSet<FString>& UsedNames)
+	{
+		FString Suffix = HandlerProperty->GetName();
+		Suffix.RemoveFromEnd(TEXT("GraphEvaluators"));
+		Suffix.RemoveFromEnd(TEXT("GraphEvaluator"));
+
+		if (Suffix.IsEmpty())
+		{
+			Suffix = IsCondition(Struct, HandlerProperty) ? TEXT("Evaluate") : TEXT("BeginState");
+		}
+
+		if (ArrayIndex != INDEX_NONE)
+		{
+			Suffix += FString::Printf(TEXT("_%d"), ArrayIndex);
+		}
+
+		return MakeIdentifier(MemberName + TEXT("_"), Suffix, UsedNames);
+	}
+
+	/** Call Visitor for each graph function handler of a node, including handlers in arrays. */
+	static void ForEachHandler(UScriptStruct* Struct, void* NodeMemory, TFunctionRef<void(FProperty*, int32, FSMExposedFunctionHandler&)> Visitor)
+	{
+		for (TFieldIterator<FProperty> It(Struct); It; ++It)
+		{
+			FProperty* Property = *It;
+			if (FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+			{
+				if (StructProperty->Struct == FSMExposedFunctionHandler::StaticStruct())
+				{
+					Visitor(Property, INDEX_NONE, *StructProperty->ContainerPtrToValuePtr<FSMExposedFunctionHandler>(NodeMemory));
+				}
+			}
+			else if (FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+			{
+				FStructProperty* InnerProperty = CastField<FStructProperty>(ArrayProperty->Inner);
+				if (InnerProperty && InnerProperty->Struct == FSMExposedFunctionHandler::StaticStruct())
+				{
+					FScriptArrayHelper ArrayHelper(ArrayProperty, ArrayProperty->ContainerPtrToValuePtr<void>(NodeMemory));
+					for (int32 Idx = 0; Idx < ArrayHelper.Num(); ++Idx)
+					{
+						Visitor(Property, Idx, *reinterpret_cast<FSMExposedFunctionHandler*>(ArrayHelper.GetRawPtr(Idx)));
+					}
+				}
+			}
+		}
+	}
+
+	static FString EscapeString(const FString& Text)
+	{
+		return Text.ReplaceCharWithEscapedChar();
+	}
+
+	static FString GuidToCpp(const FGuid& Guid)
+	{
+		return FString::Printf(TEXT("FGuid(0x%08X, 0x%08X, 0x%08X, 0x%08X)"), Guid.A, Guid.B, Guid.C, Guid.D);
+	}
+
+	/** Node members which aren't public are set through these. */
+	static const TCHAR* FindSetter(const FProperty* Property)
+	{
+		static const TMap<FName, const TCHAR*> Setters =
+		{
+			{ TEXT("Guid"), TEXT("SetNodeGuid") },
+			{ TEXT("OwnerGuid"), TEXT("SetOwnerNodeGuid") },
+			{ TEXT("NodeName"), TEXT("SetNodeName") },
+			{ TEXT("TemplateName"), TEXT("SetTemplateName") },
+			{ TEXT("NodeInstanceClass"), TEXT("SetNodeInstanceClass") },
+			{ TEXT("ReferencedStateMachineClass"), TEXT("SetClassReference") },
+			{ TEXT("ReferencedTemplateName"), TEXT("SetReferencedTemplateName") }
+		};
+
+		const TCHAR* const* Setter = Setters.Find(Property->GetFName());
+		return Setter ? *Setter : nullptr;
+	}
+
+	/** Members calculated or assigned during initialization. */
+	static bool IsRuntimeOnly(const FProperty* Property)
+	{
+		static const TSet<FName> RuntimeMembers =
+		{
+			TEXT("PathGuid"), TEXT("OwningInstance"), TEXT("NodeInstance"), TEXT("ReferencedStateMachine"), TEXT("IsReferencedByInstance")
+		};
+
+		return Property->HasAnyPropertyFlags(CPF_Transient) || RuntimeMembers.Contains(Property->GetFName());
+	}
+
+	/**
+	 * C++ expression for a class reference. Native classes are referenced directly. Other classes are found by a
+	 * ConstructorHelpers::FClassFinder added to OutLines, which is only valid in a constructor.
+	 */
+	static FString ClassToCpp(UClass* Class, const UClass* BaseClass, const FString& FinderName, TArray<FString>& OutLines, TSet<FString>& OutIncludes)
+	{
+		if (!Class)
+		{
+			return TEXT("nullptr");
+		}
+
+		if (Class->HasAnyClassFlags(CLASS_Native))
+		{
+			const FString& IncludePath = Class->GetMetaData(TEXT("IncludePath"));
+			if (!IncludePath.IsEmpty())
+			{
+				OutIncludes.Add(IncludePath);
+				return FString::Printf(TEXT("%s%s::StaticClass()"), Class->GetPrefixCPP(), *Class->GetName());
+			}
+		}
+
+		OutIncludes.Add(TEXT("UObject/ConstructorHelpers.h"));
+		OutLines.Add(FString::Printf(TEXT("\tstatic ConstructorHelpers::FClassFinder<%s%s> %s(TEXT(\"%s\"));\n"),
+			BaseClass->GetPrefixCPP(), *BaseClass->GetName(), *FinderName, *Class->GetPathName()));
+		return FinderName + TEXT(".Class");
+	}
+
+	/** C++ literal for a value. False if the type isn't supported. */
+	static bool ValueToCpp(const FProperty* Property, const void* Value, FString& OutValue)
+	{
+		if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+		{
+			OutValue = BoolProperty->GetPropertyValue(Value) ? TEXT("true") : TEXT("false");
+			return true;
+		}
+
+		const UEnum* Enum = nullptr;
+		const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property);
+		if (const FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property))
+		{
+			Enum = EnumProperty->GetEnum();
+			NumericProperty = EnumProperty->GetUnderlyingProperty();
+		}
+		else if (const FByteProperty* ByteProperty = CastField<FByteProperty>(Property))
+		{
+			Enum = ByteProperty->Enum;
+		}
+
+		if (Enum)
+		{
+			// Includes the enum name for enum classes.
+			const FName EnumName = Enum->GetNameByValue(NumericProperty->GetSignedIntPropertyValue(Value));
+			OutValue = EnumName.ToString();
+			return EnumName != NAME_None;
+		}
+
+		if (NumericProperty)
+		{
+			if (NumericProperty->IsFloatingPoint())
+			{
+				OutValue = FString::Printf(TEXT("%.9g"), NumericProperty->GetFloatingPointPropertyValue(Value));
+				if (!OutValue.Contains(TEXT(".")) && !OutValue.Contains(TEXT("e")))
+				{
+					OutValue += TEXT(".0");
+				}
+				if (Property->IsA<FFloatProperty>())
+				{
+					OutValue += TEXT("f");
+				}
+			}
+			else
+			{
+				OutValue = NumericProperty->GetNumericPropertyValueToString(Value);
+			}
+
+			return true;
+		}
+
+		if (const FNameProperty* NameProperty = CastField<FNameProperty>(Property))
+		{
+			const FName Name = NameProperty->GetPropertyValue(Value);
+			OutValue = Name == NAME_None ? TEXT("NAME_None") : FString::Printf(TEXT("FName(TEXT(\"%s\"))"), *EscapeString(Name.ToString()));
+			return true;
+		}
+
+		if (const FStrProperty* StrProperty = CastField<FStrProperty>(Property))
+		{
+			OutValue = FString::Printf(TEXT("TEXT(\"%s\")"), *EscapeString(StrProperty->GetPropertyValue(Value)));
+			return true;
+		}
+
+		const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+		if (StructProperty && StructProperty->Struct == TBaseStructure<FGuid>::Get())
+		{
+			OutValue = GuidToCpp(*static_cast<const FGuid*>(Value));
+			return true;
+		}
+
+		return false;
+	}
+
+	static bool IsHandlerProperty(const FProperty* Property)
+	{
+		const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+		return StructProperty && StructProperty->Struct == FSMExposedFunctionHandler::StaticStruct();
+	}
+
+	/**
+	 * Add an assignment to OutLines for each member of a node which differs from the struct defaults.
+	 * @return False if a member can't be written as C++. OutError describes which.
+	 */
+	static bool WriteNodeInitializers(const FNodeEntry& Entry, const void* NodeMemory, const void* DefaultsMemory, TArray<FString>& OutLines,
+		TSet<FString>& OutIncludes, FString& OutError)
+	{
+		for (TFieldIterator<FProperty> It(Entry.Struct); It; ++It)
+		{
+			FProperty* Property = *It;
+			if (IsRuntimeOnly(Property) || Property->Identical_InContainer(NodeMemory, DefaultsMemory))
+			{
+				continue;
+			}
+
+			const FString Target = FString::Printf(TEXT("%s.%s"), *Entry.MemberName, *Property->GetName());
+			const TCHAR* Setter = FindSetter(Property);
+			if (!Setter && !Property->HasAnyPropertyFlags(CPF_NativeAccessSpecifierPublic))
+			{
+				OutError = FString::Printf(TEXT("Node %s sets %s which isn't public and can't be exported."), *Entry.Node->GetNodeName(), *Property->GetName());
+				return false;
+			}
+
+			auto Assign = [&](const FString& Value)
+			{
+				OutLines.Add(Setter ? FString::Printf(TEXT("\t%s.%s(%s);\n"), *Entry.MemberName, Setter, *Value) : FString::Printf(TEXT("\t%s = %s;\n"), *Target, *Value));
+			};
+
+			if (FClassProperty* ClassProperty = CastField<FClassProperty>(Property))
+			{
+				UClass* Class = Cast<UClass>(ClassProperty->GetObjectPropertyValue_InContainer(NodeMemory));
+				if (Property->GetFName() == TEXT("NodeInstanceClass") && Class == Entry.Node->GetDefaultNodeInstanceClass())
+				{
+					// Assigned during initialization when empty.
+					continue;
+				}
+
+				Assign(ClassToCpp(Class, ClassProperty->MetaClass, Entry.MemberName + TEXT("_") + Property->GetName(), OutLines, OutIncludes));
+				continue;
+			}
+
+			if (IsHandlerProperty(Property))
+			{
+				const FSMExposedFunctionHandler* Handler = Property->ContainerPtrToValuePtr<FSMExposedFunctionHandler>(NodeMemory);
+				OutLines.Add(FString::Printf(TEXT("\t%s.BoundFunction = FName(TEXT(\"%s\"));\n"), *Target, *Handler->BoundFunction.ToString()));
+				continue;
+			}
+
+			if (FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+			{
+				FScriptArrayHelper ArrayHelper(ArrayProperty, ArrayProperty->ContainerPtrToValuePtr<void>(NodeMemory));
+				OutLines.Add(FString::Printf(TEXT("\t%s.SetNum(%d);\n"), *Target, ArrayHelper.Num()));
+				for (int32 Idx = 0; Idx < ArrayHelper.Num(); ++Idx)
+				{
+					if (IsHandlerProperty(ArrayProperty->Inner))
+					{
+						const FSMExposedFunctionHandler* Handler = reinterpret_cast<const FSMExposedFunctionHandler*>(ArrayHelper.GetRawPtr(Idx));
+						OutLines.Add(FString::Printf(TEXT("\t%s[%d].BoundFunction = FName(TEXT(\"%s\"));\n"), *Target, Idx, *Handler->BoundFunction.ToString()));
+						continue;
+					}
+
+					FString Value;
+					if (!ValueToCpp(ArrayProperty->Inner, ArrayHelper.GetRawPtr(Idx), Value))
+					{
+						OutError = FString::Printf(TEXT("Node %s member %s has elements of an unsupported type and can't be exported."), *Entry.Node->GetNodeName(), *Property->GetName());
+						return false;
+					}
+
+					OutLines.Add(FString::Printf(TEXT("\t%s[%d] = %s;\n"), *Target, Idx, *Value));
+				}
+				continue;
+			}
+
+			FString Value;
+			if (!ValueToCpp(Property, Property->ContainerPtrToValuePtr<void>(NodeMemory), Value))
+			{
+				OutError = FString::Printf(TEXT("Node %s member %s is of an unsupported type and can't be exported."), *Entry.Node->GetNodeName(), *Property->GetName());
+				return false;
+			}
+
+			Assign(Value);
+		}
+
+		return true;
+	}
+}
+
+bool FSMNativeCodeGenerator::TryConvertBoolExpression(const UEdGraphPin* InputPin, UClass* OwnerClass, FString& OutExpression, TSet<FName>& VariablesOut)
+{
+	using namespace SMNativeCodeGenerator;
+
+	TSet<FName> Variables;
+	TFunction<bool(const UEdGraphPin*, int32, FString&)> Convert;
+	Convert = [&](const UEdGraphPin* Pin, int32 Depth, FString& Expression) -> bool
+	{
+		if (!Pin || Depth > MaxExpressionDepth)
+		{
+			return false;
+		}
+
+		if (Pin->LinkedTo.Num() == 0)
+		{
+			Expression = Pin->DefaultValue.ToBool() ? TEXT("true") : TEXT("false");
+			return true;
+		}
+
+		if (Pin->LinkedTo.Num() > 1)
+		{
+			return false;
+		}
+
+		UEdGraphNode* Node = Pin->LinkedTo[0]->GetOwningNode();
+
+		if (UK2Node_Knot* Knot = Cast<UK2Node_Knot>(Node))
+		{
+			return Convert(Knot->GetInputPin(), Depth + 1, Expression);
+		}
+
+		if (UK2Node_VariableGet* VariableGet = Cast<UK2Node_VariableGet>(Node))
+		{
+			if (!VariableGet->VariableReference.IsSelfContext())
+			{
+				return false;
+			}
+
+			const FName VariableName = VariableGet->VariableReference.GetMemberName();
+			FBoolProperty* BoolProperty = FindFProperty<FBoolProperty>(OwnerClass, VariableName);
+			if (!BoolProperty || !IsValidIdentifier(VariableName.ToString()))
+			{
+				return false;
+			}
+
+			Variables.Add(VariableName);
+			Expression = VariableName.ToString();
+			return true;
+		}
+
+		if (UK2Node_CallFunction* CallFunction = Cast<UK2Node_CallFunction>(Node))
+		{
+			const UFunction* Function = CallFunction->GetTargetFunction();
+			if (!Function || Function->GetOwnerClass() != UKismetMathLibrary::StaticClass())
+			{
+				return false;
+			}
+
+			const FName FunctionName = Function->GetFName();
+			if (FunctionName == GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, Not_PreBool))
+			{
+				FString Operand;
+				if (!Convert(CallFunction->FindPin(TEXT("A"), EGPD_Input), Depth + 1, Operand))
+				{
+					return false;
+				}
+
+				Expression = FString::Printf(TEXT("!(%s)"), *Operand);
+				return true;
+			}
+
+			const bool bIsAnd = FunctionName == GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, BooleanAND);
+			const bool bIsOr = FunctionName == GET_FUNCTION_NAME_CHECKED(UKismetMathLibrary, BooleanOR);
+			if (bIsAnd || bIsOr)
+			{
+				FString LeftOperand;
+				FString RightOperand;
+				if (!Convert(CallFunction->FindPin(TEXT("A"), EGPD_Input), Depth + 1, LeftOperand) ||
+					!Convert(CallFunction->FindPin(TEXT("B"), EGPD_Input), Depth + 1, RightOperand))
+				{
+					return false;
+				}
+
+				Expression = FString::Printf(TEXT("(%s %s %s)"), *LeftOperand, bIsAnd ? TEXT("&&") : TEXT("||"), *RightOperand);
+				return true;
+			}
+		}
+
+		return false;
+	};
+
+	// Only report variables once the whole expression converted.
+	if (!Convert(InputPin, 0, OutExpression))
+	{
+		OutExpression.Reset();
+		return false;
+	}
+
+	VariablesOut.Append(Variables);
+	return true;
+}
+
+bool FSMNativeCodeGenerator::Generate(USMBlueprint* Blueprint, const FOptions& Options, FResult& OutResult, FString& OutError)
+{
+	using namespace SMNativeCodeGenerator;
+
+	OutResult = FResult();
+
+	if (!Blueprint || !IsValidIdentifier(Options.ClassName))
+	{
+		OutError = TEXT("A blueprint and a valid class name are required.");
+		return false;
+	}
+
+	USMBlueprintGeneratedClass* GeneratedClass = Cast<USMBlueprintGeneratedClass>(Blueprint->GeneratedClass);
+	if (!GeneratedClass || Blueprint->Status == BS_Error || Blueprint->Status == BS_Dirty)
+	{
+		OutError = FString::Printf(TEXT("%s must be compiled without errors before it can be exported."), *Blueprint->GetName());
+		return false;
+	}
+
+	if (Cast<USMBlueprintGeneratedClass>(GeneratedClass->GetSuperClass()))
+	{
+		OutError = FString::Printf(TEXT("%s has a state machine blueprint parent. Only blueprints deriving directly from a native class can be exported."), *Blueprint->GetName());
+		return false;
+	}
+
+	USMInstance* DefaultInstance = CastChecked<USMInstance>(GeneratedClass->GetDefaultObject());
+
+	TSet<FStructProperty*> Properties;
+	FGuid RootGuid = DefaultInstance->RootStateMachineGuid;
+	if (!USMUtils::TryGetStateMachinePropertiesForClass(GeneratedClass, Properties, RootGuid))
+	{
+		OutError = FString::Printf(TEXT("%s has no compiled state machine."), *Blueprint->GetName());
+		return false;
+	}
+
+	// Conditions are read from the editor graphs, matched to the compiled nodes by guid.
+	TMap<FGuid, const UEdGraphPin*> ConditionPins;
+	{
+		TArray<USMGraphNode_Base*> GraphNodes;
+		FSMBlueprintEditorUtils::GetAllNodesOfClassNested<USMGraphNode_Base>(Blueprint, GraphNodes);
+		for (USMGraphNode_Base* GraphNode : GraphNodes)
+		{
+			const FSMNode_Base* RuntimeNode = GraphNode->FindRuntimeNode();
+			if (!RuntimeNode)
+			{
+				continue;
+			}
+
+			if (USMTransitionGraph* TransitionGraph = Cast<USMTransitionGraph>(GraphNode->GetBoundGraph()))
+			{
+				if (TransitionGraph->ResultNode)
+				{
+					ConditionPins.Add(RuntimeNode->GetNodeGuid(), TransitionGraph->ResultNode->GetInputPin());
+				}
+			}
+			else if (USMConduitGraph* ConduitGraph = Cast<USMConduitGraph>(GraphNode->GetBoundGraph()))
+			{
+				if (ConduitGraph->ResultNode)
+				{
+					ConditionPins.Add(RuntimeNode->GetNodeGuid(), ConduitGraph->ResultNode->GetInputPin());
+				}
+			}
+		}
+	}
+
+	TArray<FNodeEntry> Nodes;
+	for (FStructProperty* Property : Properties)
+	{
+		UScriptStruct* Struct = Property->Struct;
+		if (Struct->GetOutermost() != FSMNode_Base::StaticStruct()->GetOutermost())
+		{
+			OutError = FString::Printf(TEXT("Node %s uses the custom runtime struct %s which can't be exported."), *Property->GetName(), *Struct->GetName());
+			return false;
+		}
+
+		FNodeEntry& Entry = Nodes.AddDefaulted_GetRef();
+		Entry.Struct = Struct;
+		Entry.Node = Property->ContainerPtrToValuePtr<FSMNode_Base>(DefaultInstance);
+	}
+
+	// Stable output between exports.
+	Nodes.Sort([](const FNodeEntry& A, const FNodeEntry& B)
+	{
+		const int32 OrderA = GetNodeSortOrder(A.Struct);
+		const int32 OrderB = GetNodeSortOrder(B.Struct);
+		if (OrderA != OrderB)
+		{
+			return OrderA < OrderB;
+		}
+
+		if (A.Node->GetNodeName() != B.Node->GetNodeName())
+		{
+			return A.Node->GetNodeName() < B.Node->GetNodeName();
+		}
+
+		return A.Node->GetNodeGuid() < B.Node->GetNodeGuid();
+	});
+
+	TSet<FString> UsedNames;
+	for (FNodeEntry& Entry : Nodes)
+	{
+		Entry.MemberName = MakeIdentifier(GetNodePrefix(Entry.Struct), Entry.Node->GetNodeName(), UsedNames);
+	}
+
+	TSet<FName> BoolVariables;
+	TArray<FFunctionEntry> Functions;
+	TArray<FString> NodeInitializers;
+	TSet<FString> IncludeFiles;
+	TSet<FString> SourceIncludeFiles;
+
+	// Graphs with logic which can't be converted. Their logic would be lost in the native class.
+	TArray<FString> UnconvertedGraphs;
+
+	for (const FNodeEntry& Entry : Nodes)
+	{
+		FStructOnScope NodeCopy(Entry.Struct);
+		Entry.Struct->CopyScriptStruct(NodeCopy.GetStructMemory(), Entry.Node);
+
+		// Bind handlers to generated functions. Resolved function pointers belong to the blueprint class and are dropped.
+		ForEachHandler(Entry.Struct, NodeCopy.GetStructMemory(), [&](FProperty* HandlerProperty, int32 ArrayIndex, FSMExposedFunctionHandler& Handler)
+		{
+			if (Handler.BoundFunction == NAME_None)
+			{
+				Handler = FSMExposedFunctionHandler();
+				return;
+			}
+
+			FFunctionEntry& Function = Functions.AddDefaulted_GetRef();
+			Function.Name = MakeFunctionName(Entry.MemberName, Entry.Struct, HandlerProperty, ArrayIndex, UsedNames);
+			Function.MemberName = Entry.MemberName;
+
+			if (IsCondition(Entry.Struct, HandlerProperty))
+			{
+				const UEdGraphPin* const* ConditionPin = ConditionPins.Find(Entry.Node->GetNodeGuid());
+				if (ConditionPin && TryConvertBoolExpression(*ConditionPin, GeneratedClass, Function.NativeExpression, BoolVariables))
+				{
+					OutResult.NumNativeConditions++;
+				}
+				else
+				{
+					Function.bIsBlueprintCondition = true;
+					OutResult.BlueprintFunctions.Add(Function.Name + TEXT("_CanEnterTransition"));
+					UnconvertedGraphs.Add(FString::Printf(TEXT("%s (%s)"), *Entry.Node->GetNodeName(), *HandlerProperty->GetName()));
+				}
+			}
+			else
+			{
+				OutResult.BlueprintFunctions.Add(Function.Name);
+				UnconvertedGraphs.Add(FString::Printf(TEXT("%s (%s)"), *Entry.Node->GetNodeName(), *HandlerProperty->GetName()));
+			}
+
+			Handler = FSMExposedFunctionHandler();
+			Handler.BoundFunction = *Function.Name;
+		});
+
+		// Templates live on the blueprint class as default subobjects and can't be found from the native class.
+		for (TFieldIterator<FNameProperty> It(Entry.Struct); It; ++It)
+		{
+			if (It->GetFName() == TEXT("TemplateName") || It->GetFName() == TEXT("ReferencedTemplateName"))
+			{
+				if (It->GetPropertyValue_InContainer(NodeCopy.GetStructMemory()) != NAME_None)
+				{
+					It->SetPropertyValue_InContainer(NodeCopy.GetStructMemory(), NAME_None);
+					OutResult.Warnings.Add(FString::Printf(TEXT("Node %s uses a node template which isn't exported. The node class defaults are used instead."), *Entry.Node->GetNodeName()));
+				}
+			}
+		}
+
+		FStructOnScope Defaults(Entry.Struct);
+		if (!WriteNodeInitializers(Entry, NodeCopy.GetStructMemory(), Defaults.GetStructMemory(), NodeInitializers, SourceIncludeFiles, OutError))
+		{
+			return false;
+		}
+
+		IncludeFiles.Add(FString::Printf(TEXT("%s.h"), *Entry.Struct->GetName()));
+		OutResult.NumNodes++;
+	}
+
+	if (UnconvertedGraphs.Num() > 0 && !Options.bAllowBlueprintImplementedGraphs)
+	{
+		OutError = FString::Printf(TEXT("%s has graphs which can't be converted to native code: %s. Only conditions built from constants, bool variables, NOT, AND and OR are converted."),
+			*Blueprint->GetName(), *FString::Join(UnconvertedGraphs, TEXT(", ")));
+		return false;
+	}
+
+	const FString ClassName = TEXT("U") + Options.ClassName;
+	const FString ApiMacro = Options.ApiMacro.IsEmpty() ? FString() : Options.ApiMacro + TEXT(" ");
+	const FString BlueprintPath = Blueprint->GetPathName();
+
+	//////////////////////////////////////////////////////////////////////////
+	// Header
+
+	FString& Header = OutResult.HeaderText;
+	Header += FString::Printf(TEXT("// Generated from %s by the Logic Driver native exporter. Re-export instead of editing.\n"), *BlueprintPath);
+	Header += TEXT("#pragma once\n\n");
+	Header += TEXT("#include \"CoreMinimal.h\"\n");
+	Header += TEXT("#include \"SMInstance.h\"\n");
+
+	IncludeFiles.Sort([](const FString& A, const FString& B) { return A < B; });
+	for (const FString& IncludeFile : IncludeFiles)
+	{
+		Header += FString::Printf(TEXT("#include \"%s\"\n"), *IncludeFile);
+	}
+
+	Header += FString::Printf(TEXT("#include \"%s.generated.h\"\n\n"), *Options.ClassName);
+	Header += TEXT("/**\n");
+	Header += FString::Printf(TEXT(" * Native version of %s.\n"), *Blueprint->GetName());
+	if (OutResult.BlueprintFunctions.Num() > 0)
+	{
+		Header += TEXT(" * Blueprint events are graphs which couldn't be converted. Implement them in a blueprint subclass.\n");
+	}
+	Header += TEXT(" */\n");
+	Header += OutResult.BlueprintFunctions.Num() > 0 ? TEXT("UCLASS(Abstract, Blueprintable)\n") : TEXT("UCLASS(Blueprintable)\n");
+	Header += FString::Printf(TEXT("class %s%s : public USMInstance\n"), *ApiMacro, *ClassName);
+	Header += TEXT("{\n");
+	Header += TEXT("\tGENERATED_BODY()\n\n");
+	Header += TEXT("public:\n");
+	Header += FString::Printf(TEXT("\t%s();\n"), *ClassName);
+
+	TArray<FName> SortedVariables = BoolVariables.Array();
+	SortedVariables.Sort([](const FName& A, const FName& B) { return A.LexicalLess(B); });
+	for (const FName& Variable : SortedVariables)
+	{
+		Header += TEXT("\n\tUPROPERTY(EditAnywhere, BlueprintReadWrite, Category = \"State Machine\")\n");
+		Header += FString::Printf(TEXT("\tbool %s;\n"), *Variable.ToString());
+	}
+
+	if (Functions.Num() > 0)
+	{
+		Header += TEXT("\nprotected:\n");
+		for (const FFunctionEntry& Function : Functions)
+		{
+			if (!Function.NativeExpression.IsEmpty())
+			{
+				Header += FString::Printf(TEXT("\tUFUNCTION()\n\tvoid %s();\n\n"), *Function.Name);
+			}
+			else if (Function.bIsBlueprintCondition)
+			{
+				Header += FString::Printf(TEXT("\tUFUNCTION()\n\tvoid %s();\n\n"), *Function.Name);
+				Header += FString::Printf(TEXT("\tUFUNCTION(BlueprintImplementableEvent, Category = \"State Machine\")\n\tbool %s_CanEnterTransition();\n\n"), *Function.Name);
+			}
+			else
+			{
+				Header += FString::Printf(TEXT("\tUFUNCTION(BlueprintImplementableEvent, Category = \"State Machine\")\n\tvoid %s();\n\n"), *Function.Name);
+			}
+		}
+
+		Header.RemoveFromEnd(TEXT("\n"));
+	}
+
+	Header += TEXT("\nprivate:\n");
+	for (const FNodeEntry& Entry : Nodes)
+	{
+		Header += FString::Printf(TEXT("\tUPROPERTY()\n\t%s %s;\n\n"), *Entry.Struct->GetStructCPPName(), *Entry.MemberName);
+	}
+	Header.RemoveFromEnd(TEXT("\n"));
+	Header += TEXT("};\n");
+
+	//////////////////////////////////////////////////////////////////////////
+	// Source
+
+	TArray<FString> InstanceInitializers;
+	InstanceInitializers.Add(FString::Printf(TEXT("\tRootStateMachineGuid = %s;\n"), *GuidToCpp(RootGuid)));
+
+	if (UClass* StateMachineClass = DefaultInstance->GetStateMachineClass())
+	{
+		const FString ClassExpression = ClassToCpp(StateMachineClass, USMStateMachineInstance::StaticClass(), TEXT("StateMachineClassFinder"), InstanceInitializers, SourceIncludeFiles);
+		InstanceInitializers.Add(FString::Printf(TEXT("\tSetStateMachineClass(%s);\n"), *ClassExpression));
+	}
+
+	for (const FName& Variable : SortedVariables)
+	{
+		FBoolProperty* BoolProperty = FindFProperty<FBoolProperty>(GeneratedClass, Variable);
+		InstanceInitializers.Add(FString::Printf(TEXT("\t%s = %s;\n"), *Variable.ToString(), BoolProperty->GetPropertyValue_InContainer(DefaultInstance) ? TEXT("true") : TEXT("false")));
+	}
+
+	FString& Source = OutResult.SourceText;
+	Source += FString::Printf(TEXT("// Generated from %s by the Logic Driver native exporter. Re-export instead of editing.\n"), *BlueprintPath);
+	Source += FString::Printf(TEXT("#include \"%s.h\"\n"), *Options.ClassName);
+
+	SourceIncludeFiles.Sort([](const FString& A, const FString& B) { return A < B; });
+	for (const FString& IncludeFile : SourceIncludeFiles)
+	{
+		Source += FString::Printf(TEXT("#include \"%s\"\n"), *IncludeFile);
+	}
+
+	Source += FString::Printf(TEXT("\n%s::%s()\n{\n"), *ClassName, *ClassName);
+	for (const FString& Initializer : InstanceInitializers)
+	{
+		Source += Initializer;
+	}
+
+	Source += TEXT("\n");
+	for (const FString& Initializer : NodeInitializers)
+	{
+		Source += Initializer;
+	}
+	Source += TEXT("}\n");
+
+	for (const FFunctionEntry& Function : Functions)
+	{
+		if (!Function.NativeExpression.IsEmpty())
+		{
+			Source += FString::Printf(TEXT("\nvoid %s::%s()\n{\n\t%s.bCanEnterTransition = %s;\n}\n"), *ClassName, *Function.Name, *Function.MemberName, *Function.NativeExpression);
+		}
+		else if (Function.bIsBlueprintCondition)
+		{
+			Source += FString::Printf(TEXT("\nvoid %s::%s()\n{\n\t%s.bCanEnterTransition = %s_CanEnterTransition();\n}\n"), *ClassName, *Function.Name, *Function.MemberName, *Function.Name);
+		}
+	}
+
+	return true;
+}
+
+bool FSMNativeCodeGenerator::SaveToDirectory(const FString& Directory, const FOptions& Options, const FResult& Result, FString& OutError)
+{
+	const FString HeaderPath = FPaths::Combine(Directory, Options.ClassName + TEXT(".h"));
+	const FString SourcePath = FPaths::Combine(Directory, Options.ClassName + TEXT(".cpp"));
+
+	if (!FFileHelper::SaveStringToFile(Result.HeaderText, *HeaderPath) || !FFileHelper::SaveStringToFile(Result.SourceText, *SourcePath))
+	{
+		OutError = FString::Printf(TEXT("Could not write %s."), *FPaths::Combine(Directory, Options.ClassName));
+		return false;
+	}
+
+	return true;
+}
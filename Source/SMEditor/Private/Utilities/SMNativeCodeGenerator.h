@@ -0,0 +1,70 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USMBlueprint;
+class UEdGraphPin;
+
+/**
+ * Exports a compiled state machine blueprint as a native USMInstance subclass.
+ *
+ * Every runtime node becomes a native FSMState, FSMTransition, FSMConduit or FSMStateMachine member initialized in the
+ * constructor with plain assignments of the compiled class defaults. Transition and conduit conditions built only from constants,
+ * bool member variables, NOT, AND and OR are converted to native functions. Any other graph with logic fails the export unless
+ * bAllowBlueprintImplementedGraphs is set, in which case the class is abstract and the graph is declared as a
+ * BlueprintImplementableEvent a blueprint subclass has to implement.
+ *
+ * Node class templates are not exported. Nodes using custom node classes run with the class defaults.
+ */
+class SMEDITOR_API FSMNativeCodeGenerator
+{
+public:
+	struct FOptions
+	{
+		/** Name of the generated class without the U prefix. Also used for the file names. */
+		FString ClassName;
+
+		/** Export macro of the module the class is added to, such as MYGAME_API. May be empty. */
+		FString ApiMacro;
+
+		/**
+		 * Export graphs which can't be converted as BlueprintImplementableEvents of an abstract class instead of failing.
+		 * Their logic isn't carried over and has to be implemented again in a blueprint subclass.
+		 */
+		bool bAllowBlueprintImplementedGraphs = false;
+	};
+
+	struct FResult
+	{
+		FString HeaderText;
+		FString SourceText;
+
+		int32 NumNodes = 0;
+
+		/** Conditions converted to native code. */
+		int32 NumNativeConditions = 0;
+
+		/** Generated functions left for a blueprint subclass to implement. Only set with bAllowBlueprintImplementedGraphs. */
+		TArray<FString> BlueprintFunctions;
+
+		/** Behavior which differs from the blueprint, such as node templates which couldn't be exported. */
+		TArray<FString> Warnings;
+	};
+
+	/**
+	 * Generate the header and source for a compiled blueprint.
+	 * @return False if the blueprint can't be exported. OutError describes why.
+	 */
+	static bool Generate(USMBlueprint* Blueprint, const FOptions& Options, FResult& OutResult, FString& OutError);
+
+	/** Write a result next to each other as ClassName.h and ClassName.cpp. */
+	static bool SaveToDirectory(const FString& Directory, const FOptions& Options, const FResult& Result, FString& OutError);
+
+	/**
+	 * Convert the graph connected to a bool input pin into a C++ expression.
+	 * @param VariablesOut Bool member variables of the owner class the expression reads.
+	 * @return False if the graph contains anything other than constants, self bool variables, NOT, AND, OR and reroute nodes.
+	 */
+	static bool TryConvertBoolExpression(const UEdGraphPin* InputPin, UClass* OwnerClass, FString& OutExpression, TSet<FName>& VariablesOut);
+};
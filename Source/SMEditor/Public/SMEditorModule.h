@@ -31,6 +31,8 @@ private:
 	void RegisterSettings();
 	void UnregisterSettings();
 
+	void OnObjectModified(UObject* Object);
+
 	void BeginPIE(bool bValue);
 	void EndPie(bool bValue);
 
@@ -49,6 +51,8 @@ private:
 	FSMKismetCompiler SMBlueprintCompiler;
 
 	FDelegateHandle RefreshAllNodesDelegateHandle;
+	FDelegateHandle ObjectModifiedHandle;
+	FDelegateHandle PostUndoRedoHandle;
 
 	FDelegateHandle BeginPieHandle;
 	FDelegateHandle EndPieHandle;
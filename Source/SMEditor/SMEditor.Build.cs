@@ -49,6 +49,8 @@ public class SMEditor : ModuleRules
                 "EditorWidgets",
                 "ToolMenus",
                 "AssetTools",
+                "Json",
+                "DesktopPlatform",
 
                 "WorkspaceMenuStructure",
 				"DetailCustomizations",
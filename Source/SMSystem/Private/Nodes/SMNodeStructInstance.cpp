@@ -0,0 +1,60 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "SMNodeStructInstance.h"
+#include "Misc/ScopeRWLock.h"
+
+
+DEFINE_STAT(STAT_NodeStructInstances);
+
+static TMap<const UClass*, FSMNodeStructRegistry::FEntry> RegisteredNodeStructs;
+
+/** Modules may register while instances initialize on other threads. */
+static FRWLock RegisteredNodeStructsLock;
+
+FSMNodeStructInstance::FSMNodeStructInstance()
+{
+	INC_DWORD_STAT(STAT_NodeStructInstances)
+}
+
+FSMNodeStructInstance::~FSMNodeStructInstance()
+{
+	DEC_DWORD_STAT(STAT_NodeStructInstances)
+}
+
+void FSMNodeStructRegistry::Register(const UClass* NodeInstanceClass, const FEntry& Entry)
+{
+	check(NodeInstanceClass && Entry.Construct);
+	
+	FRWScopeLock Lock(RegisteredNodeStructsLock, SLT_Write);
+	RegisteredNodeStructs.Add(NodeInstanceClass, Entry);
+}
+
+void FSMNodeStructRegistry::Unregister(const UClass* NodeInstanceClass)
+{
+	FRWScopeLock Lock(RegisteredNodeStructsLock, SLT_Write);
+	RegisteredNodeStructs.Remove(NodeInstanceClass);
+}
+
+bool FSMNodeStructRegistry::HasRegistrations()
+{
+	FRWScopeLock Lock(RegisteredNodeStructsLock, SLT_ReadOnly);
+	return RegisteredNodeStructs.Num() > 0;
+}
+
+bool FSMNodeStructRegistry::Find(const UClass* NodeInstanceClass, FEntry& OutEntry)
+{
+	if (!NodeInstanceClass)
+	{
+		return false;
+	}
+
+	FRWScopeLock Lock(RegisteredNodeStructsLock, SLT_ReadOnly);
+	
+	const FEntry* Entry = RegisteredNodeStructs.Find(NodeInstanceClass);
+	if (!Entry)
+	{
+		return false;
+	}
+
+	OutEntry = *Entry;
+	return true;
+}
@@ -1,14 +1,104 @@
 // Copyright Recursoft LLC 2019-2020. All Rights Reserved.
 #include "SMNode_Base.h"
 #include "SMUtils.h"
+#include "SMInstance.h"
 #include "SMLogging.h"
 #include "SMNodeInstance.h"
+#include "SMNodeStructInstance.h"
 
 
+void FSMNetworkedTransactionHistory::SetCapacity(int32 NewCapacity)
+{
+	Entries.SetNumUninitialized(FMath::Max(NewCapacity, 1));
+	Reset();
+	RecordedGuids.Reserve(Entries.Num());
+}
+
+bool FSMNetworkedTransactionHistory::Contains(const FGuid& TransactionGuid) const
+{
+	return RecordedGuids.Contains(TransactionGuid);
+}
+
+void FSMNetworkedTransactionHistory::Add(const FGuid& TransactionGuid, double CurrentTime)
+{
+	if (Entries.Num() == 0)
+	{
+		SetCapacity(DefaultCapacity);
+	}
+
+	bool bAlreadyRecorded = false;
+	RecordedGuids.Add(TransactionGuid, &bAlreadyRecorded);
+	if (bAlreadyRecorded)
+	{
+		return;
+	}
+
+	if (Count == Entries.Num())
+	{
+		if (Timeout >= 0.0 && Entries[Head].Time + Timeout <= CurrentTime)
+		{
+			// The oldest has expired and can be overwritten.
+			RecordedGuids.Remove(Entries[Head].TransactionGuid);
+			Head = (Head + 1) % Entries.Num();
+			--Count;
+		}
+		else
+		{
+			// Dropping an entry that hasn't expired would let a late duplicate of it be applied again.
+			Grow();
+		}
+	}
+
+	const int32 Capacity = Entries.Num();
+	FEntry& Entry = Entries[(Head + Count) % Capacity];
+	Entry.TransactionGuid = TransactionGuid;
+	Entry.Time = CurrentTime;
+	++Count;
+}
+
+void FSMNetworkedTransactionHistory::RemoveExpired(double CurrentTime, double InTimeout)
+{
+	Timeout = InTimeout;
+	
+	const int32 Capacity = Entries.Num();
+	while (Count > 0 && Entries[Head].Time + Timeout <= CurrentTime)
+	{
+		RecordedGuids.Remove(Entries[Head].TransactionGuid);
+		Head = (Head + 1) % Capacity;
+		--Count;
+	}
+}
+
+void FSMNetworkedTransactionHistory::Grow()
+{
+	const int32 OldCapacity = Entries.Num();
+	
+	TArray<FEntry> NewEntries;
+	NewEntries.SetNumUninitialized(OldCapacity * 2);
+	for (int32 Offset = 0; Offset < Count; ++Offset)
+	{
+		NewEntries[Offset] = Entries[(Head + Offset) % OldCapacity];
+	}
+
+	Entries = MoveTemp(NewEntries);
+	Head = 0;
+	RecordedGuids.Reserve(Entries.Num());
+	
+	LD_LOG_WARNING(TEXT("Previous transaction history grew from %d to %d entries because none had expired. Consider raising the previous transaction capacity."),
+		OldCapacity, Entries.Num());
+}
+
+void FSMNetworkedTransactionHistory::Reset()
+{
+	Head = 0;
+	Count = 0;
+	RecordedGuids.Reset();
+}
+
 FSMNode_Base::FSMNode_Base() : TimeInState(0), bIsInEndState(false), bHasUpdated(false), DuplicateId(0),
 OwnerNode(nullptr),
-OwningInstance(nullptr), NodeInstance(nullptr), NodeInstanceClass(nullptr),
-bInitialized(false), bIsActive(false)
+OwningInstance(nullptr), NodeInstance(nullptr), NodeInstanceClass(nullptr), NodeStructInstance(nullptr),
+bInitialized(false), bIsActive(false), bTransitionNodesInitialized(false)
 {
 	/*
 	 * Originally the Guid was initialized here. This caused warnings to show up during packaging because
@@ -32,6 +122,14 @@ void FSMNode_Base::Initialize(UObject* Instance)
 	{
 		FunctionHandler.Initialize(Instance);
 	}
+	for (FSMExposedFunctionHandler& FunctionHandler : InstanceInitializedGraphEvaluators)
+	{
+		FunctionHandler.Initialize(Instance);
+	}
+	for (FSMExposedFunctionHandler& FunctionHandler : InstanceShutdownGraphEvaluators)
+	{
+		FunctionHandler.Initialize(Instance);
+	}
 	
 	CreateNodeInstance();
 }
@@ -39,6 +137,10 @@ void FSMNode_Base::Initialize(UObject* Instance)
 void FSMNode_Base::Reset()
 {
 	GraphEvaluator.Reset();
+	bTransitionNodesInitialized = false;
+
+	// The owning instance releases the memory.
+	NodeStructInstance = nullptr;
 	
 	for (FSMExposedFunctionHandler& FunctionHandler : TransitionInitializedGraphEvaluators)
 	{
@@ -48,6 +150,14 @@ void FSMNode_Base::Reset()
 	{
 		FunctionHandler.Reset();
 	}
+	for (FSMExposedFunctionHandler& FunctionHandler : InstanceInitializedGraphEvaluators)
+	{
+		FunctionHandler.Reset();
+	}
+	for (FSMExposedFunctionHandler& FunctionHandler : InstanceShutdownGraphEvaluators)
+	{
+		FunctionHandler.Reset();
+	}
 }
 
 const FGuid& FSMNode_Base::GetNodeGuid() const
@@ -111,6 +221,17 @@ void FSMNode_Base::CreateNodeInstance()
 		check(NodeInstanceClass);
 	}
 
+	FSMNodeStructRegistry::FEntry StructEntry;
+	if (OwningInstance && FSMNodeStructRegistry::Find(NodeInstanceClass, StructEntry))
+	{
+		NodeStructInstance = OwningInstance->CreateNodeStructInstance(*this, StructEntry);
+		if (NodeStructInstance)
+		{
+			NodeInstance = nullptr;
+			return;
+		}
+	}
+
 	UObject* TemplateInstance = nullptr;
 	if (TemplateName != NAME_None && OwningInstance)
 	{
@@ -136,6 +257,11 @@ void FSMNode_Base::SetNodeInstanceClass(UClass* NewNodeInstanceClass)
 	NodeInstanceClass = NewNodeInstanceClass;
 }
 
+bool FSMNode_Base::CanExecuteEventLogic() const
+{
+	return !OwningInstance || OwningInstance->CanExecuteStateEventLogic();
+}
+
 bool FSMNode_Base::IsNodeInstanceClassCompatible(UClass* NewNodeInstanceClass) const
 {
 	ensureMsgf(false, TEXT("FSMNode_Base IsNodeInstanceClassCompatible hit for node %s and instance class %s. This should always be overidden in child classes."),
@@ -155,14 +281,26 @@ void FSMNode_Base::SetTemplateName(const FName& Name)
 
 void FSMNode_Base::ExecuteInitializeNodes()
 {
+	bTransitionNodesInitialized = true;
 	USMUtils::ExecuteGraphFunctions(TransitionInitializedGraphEvaluators);
 }
 
 void FSMNode_Base::ExecuteShutdownNodes()
 {
+	bTransitionNodesInitialized = false;
 	USMUtils::ExecuteGraphFunctions(TransitionShutdownGraphEvaluators);
 }
 
+void FSMNode_Base::ExecuteInstanceInitializedNodes()
+{
+	USMUtils::ExecuteGraphFunctions(InstanceInitializedGraphEvaluators);
+}
+
+void FSMNode_Base::ExecuteInstanceShutdownNodes()
+{
+	USMUtils::ExecuteGraphFunctions(InstanceShutdownGraphEvaluators);
+}
+
 void FSMNode_Base::Execute()
 {
 	if (!bInitialized)
@@ -179,6 +317,10 @@ void FSMNode_Base::SetActive(bool bValue)
 {
 #if WITH_EDITORONLY_DATA
 	bWasActive = bIsActive;
+	if (OwningInstance && bValue != bIsActive)
+	{
+		OwningInstance->RecordDebugEvent(*this, bValue ? ESMDebugEventType::Entered : ESMDebugEventType::Exited);
+	}
 #endif
 	bIsActive = bValue;
 }
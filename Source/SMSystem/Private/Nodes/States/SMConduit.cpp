@@ -5,7 +5,7 @@
 #include "SMUtils.h"
 
 FSMConduit::FSMConduit() : Super(), bCanEnterTransition(false), bCanEvaluate(true), bEvalWithTransitions(false),
-                           bIsEvaluating(false), bCheckedForTransitions(false)
+                           ConditionalEvaluationType(ESMConditionalEvaluationType::SM_Graph), bIsEvaluating(false), bCheckedForTransitions(false)
 {
 }
 
@@ -35,7 +35,10 @@ bool FSMConduit::StartState()
 {
 	const bool bResult = Super::StartState();
 
-	ConduitEnteredGraphEvaluator.Execute();
+	if (CanExecuteEventLogic())
+	{
+		ConduitEnteredGraphEvaluator.Execute();
+	}
 
 	return bResult;
 }
@@ -55,6 +58,18 @@ bool FSMConduit::EndState(float DeltaSeconds, const FSMTransition* TransitionToT
 }
 
 bool FSMConduit::GetValidTransition(TArray<TArray<FSMTransition*>>& Transitions)
+{
+	TArray<FSMTransition*> Chain;
+	if (GetValidTransitionChain(Chain))
+	{
+		Transitions.Add(MoveTemp(Chain));
+		return true;
+	}
+
+	return false;
+}
+
+bool FSMConduit::GetValidTransitionChain(TArray<FSMTransition*>& OutChain)
 {
 	if (bCheckedForTransitions || !bCanEvaluate)
 	{
@@ -63,11 +78,32 @@ bool FSMConduit::GetValidTransition(TArray<TArray<FSMTransition*>>& Transitions)
 
 	bIsEvaluating = true;
 #if WITH_EDITORONLY_DATA
-	bWasEvaluating = true; // Will be set to false from the editor.
+	bWasEvaluating = true;
+	if (OwningInstance)
+	{
+		OwningInstance->RecordDebugEvent(*this, ESMDebugEventType::Evaluated);
+	}
 #endif
 	
-	// First check that the conduit passes.
-	Execute();
+	// First check that the conduit passes. Constant results were determined by the compiler.
+	switch (ConditionalEvaluationType)
+	{
+	case ESMConditionalEvaluationType::SM_AlwaysTrue:
+		{
+			bCanEnterTransition = true;
+			break;
+		}
+	case ESMConditionalEvaluationType::SM_AlwaysFalse:
+		{
+			bCanEnterTransition = false;
+			break;
+		}
+	default:
+		{
+			Execute();
+			break;
+		}
+	}
 
 	bIsEvaluating = false;
 	
@@ -79,7 +115,15 @@ bool FSMConduit::GetValidTransition(TArray<TArray<FSMTransition*>>& Transitions)
 	bCheckedForTransitions = true;
 	
 	// Passes, find the best transition.
-	const bool bResult = Super::GetValidTransition(Transitions);
+	bool bResult = false;
+	for (FSMTransition* Transition : GetOutgoingTransitions())
+	{
+		if (Transition->CanTransition(OutChain))
+		{
+			bResult = true;
+			break;
+		}
+	}
 	
 	bCheckedForTransitions = false;
 	return bResult;
@@ -90,7 +134,10 @@ void FSMConduit::EnterConduitWithTransition()
 	if (IsConfiguredAsTransition())
 	{
 		SetActive(true);
-		ConduitEnteredGraphEvaluator.Execute();
+		if (CanExecuteEventLogic())
+		{
+			ConduitEnteredGraphEvaluator.Execute();
+		}
 		SetActive(false);
 	}
 }
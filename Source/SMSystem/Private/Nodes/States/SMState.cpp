@@ -2,8 +2,11 @@
 
 #include "SMState.h"
 #include "SMConduit.h"
+#include "SMStateMachine.h"
 #include "SMTransition.h"
 #include "SMStateInstance.h"
+#include "SMNodeStructInstance.h"
+#include "SMInstance.h"
 #include "SMUtils.h"
 #include "SMLogging.h"
 
@@ -20,6 +23,7 @@ void FSMState_Base::ResetReadStates()
 	bHasUpdated = false;
 	bIsInEndState = false;
 	TimeInState = 0.f;
+	FixedStepsInState = 0;
 }
 
 FSMState_Base::FSMState_Base() : Super(), bIsRootNode(false), bAlwaysUpdate(false), bEvalTransitionsOnStart(false),
@@ -46,6 +50,14 @@ void FSMState_Base::Initialize(UObject* Instance)
 	{
 		return lhs.Priority < rhs.Priority;
 	});
+
+	GlobalTransitions.StableSort([](const FSMTransition& lhs, const FSMTransition& rhs)
+	{
+		return lhs.Priority < rhs.Priority;
+	});
+
+	// Rebuilt on first use so connected conduits have sorted their transitions.
+	bTransitionChainsCached = false;
 }
 
 void FSMState_Base::Reset()
@@ -73,12 +85,28 @@ void FSMState_Base::ExecuteInitializeNodes()
 
 void FSMState_Base::GetAllTransitionChains(TArray<FSMTransition*>& OutTransitions) const
 {
-	for (FSMTransition* Transition : OutgoingTransitions)
+	for (FSMTransition* Transition : GetAllTransitionChains())
 	{
-		Transition->GetConnectedTransitions(OutTransitions);
+		OutTransitions.AddUnique(Transition);
 	}
 }
 
+const TArray<FSMTransition*>& FSMState_Base::GetAllTransitionChains() const
+{
+	if (!bTransitionChainsCached)
+	{
+		TransitionChains.Reset();
+		for (FSMTransition* Transition : OutgoingTransitions)
+		{
+			Transition->GetConnectedTransitions(TransitionChains);
+		}
+
+		bTransitionChainsCached = true;
+	}
+
+	return TransitionChains;
+}
+
 bool FSMState_Base::StartState()
 {
 	NextTransition = nullptr;
@@ -94,9 +122,16 @@ bool FSMState_Base::StartState()
 
 	SetActive(true);
 	
-	if (USMStateInstance_Base* StateInstance = Cast<USMStateInstance_Base>(NodeInstance))
+	if (CanExecuteEventLogic())
 	{
-		StateInstance->OnStateBeginEvent.Broadcast(StateInstance);
+		if (NodeStructInstance)
+		{
+			NodeStructInstance->OnStateBegin(*this);
+		}
+		else if (USMStateInstance_Base* StateInstance = Cast<USMStateInstance_Base>(NodeInstance))
+		{
+			StateInstance->OnStateBeginEvent.Broadcast(StateInstance);
+		}
 	}
 	
 	InitializeTransitions();
@@ -113,10 +148,26 @@ bool FSMState_Base::UpdateState(float DeltaSeconds)
 
 	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("SMState_Base::UpdateState"), STAT_SMState_Update, STATGROUP_LogicDriver);
 	
-	TimeInState += DeltaSeconds;
+	if (OwningInstance && OwningInstance->IsUsingFixedTimeStep())
+	{
+		// Zero delta updates such as from events don't advance the step count.
+		if (DeltaSeconds > 0.f)
+		{
+			++FixedStepsInState;
+		}
+		TimeInState = FixedStepsInState * OwningInstance->GetFixedTimeStep();
+	}
+	else
+	{
+		TimeInState += DeltaSeconds;
+	}
 	UpdateReadStates();
 
-	if (USMStateInstance_Base* StateInstance = Cast<USMStateInstance_Base>(NodeInstance))
+	if (NodeStructInstance)
+	{
+		NodeStructInstance->OnStateUpdate(*this, DeltaSeconds);
+	}
+	else if (USMStateInstance_Base* StateInstance = Cast<USMStateInstance_Base>(NodeInstance))
 	{
 		StateInstance->OnStateUpdateEvent.Broadcast(StateInstance, DeltaSeconds);
 	}
@@ -142,9 +193,16 @@ bool FSMState_Base::EndState(float DeltaSeconds, const FSMTransition* Transition
 
 	UpdateReadStates();
 
-	if (USMStateInstance_Base* StateInstance = Cast<USMStateInstance_Base>(NodeInstance))
+	if (CanExecuteEventLogic())
 	{
-		StateInstance->OnStateEndEvent.Broadcast(StateInstance);
+		if (NodeStructInstance)
+		{
+			NodeStructInstance->OnStateEnd(*this);
+		}
+		else if (USMStateInstance_Base* StateInstance = Cast<USMStateInstance_Base>(NodeInstance))
+		{
+			StateInstance->OnStateEndEvent.Broadcast(StateInstance);
+		}
 	}
 	
 	SetActive(false);
@@ -200,6 +258,11 @@ bool FSMState_Base::GetValidTransition(TArray<TArray<FSMTransition*>>& Transitio
 
 bool FSMState_Base::IsEndState() const
 {
+	if (HasGlobalTransitions())
+	{
+		return false;
+	}
+	
 	for(FSMTransition* Transition : OutgoingTransitions)
 	{
 		// Look for at least one valid transition.
@@ -227,9 +290,17 @@ void FSMState_Base::SetCanExecuteLogic(bool bValue)
 	bCanExecuteLogic = bValue;
 }
 
+bool FSMState_Base::CanExecuteUpdateLogic() const
+{
+	return CanExecuteLogic() && (!OwningInstance || OwningInstance->CanExecuteStateUpdateLogicForLOD());
+}
+
 bool FSMState_Base::CanEvaluateTransitionsOnTick() const
 {
-	if (bDisableTickTransitionEvaluation)
+	// The tick LOD may disable tick evaluation in which case only event based transitions are checked.
+	const bool bDisableTickTransitionEvaluationForLOD = OwningInstance && !OwningInstance->CanEvaluateTransitionsOnTickForLOD();
+	
+	if (bDisableTickTransitionEvaluation || bDisableTickTransitionEvaluationForLOD)
 	{
 		/* Check if any immediate outgoing transition has just completed from an event before returning false. */
 		for (FSMTransition* Transition : OutgoingTransitions)
@@ -241,7 +312,20 @@ bool FSMState_Base::CanEvaluateTransitionsOnTick() const
 		}
 	}
 
-	return !bDisableTickTransitionEvaluation;
+	return !bDisableTickTransitionEvaluation && !bDisableTickTransitionEvaluationForLOD;
+}
+
+void FSMState_Base::RestoreFromSnapshot(bool bActive, float InTimeInState, int32 InFixedStepsInState, bool bInHasUpdated)
+{
+	SetActive(bActive);
+	NextTransition = nullptr;
+	bReenteredByParallelState = false;
+	bIsStateEnding = false;
+	
+	TimeInState = InTimeInState;
+	FixedStepsInState = InFixedStepsInState;
+	bHasUpdated = bInHasUpdated;
+	bIsInEndState = IsEndState();
 }
 
 void FSMState_Base::SetTransitionToTake(const FSMTransition* Transition)
@@ -262,6 +346,7 @@ void FSMState_Base::NotifyOfParallelReentry(bool bValue)
 void FSMState_Base::AddOutgoingTransition(FSMTransition* Transition)
 {
 	OutgoingTransitions.AddUnique(Transition);
+	bTransitionChainsCached = false;
 }
 
 void FSMState_Base::AddIncomingTransition(FSMTransition* Transition)
@@ -269,29 +354,45 @@ void FSMState_Base::AddIncomingTransition(FSMTransition* Transition)
 	IncomingTransitions.AddUnique(Transition);
 }
 
+void FSMState_Base::ReserveTransitions(int32 NumOutgoing, int32 NumIncoming)
+{
+	OutgoingTransitions.Reserve(NumOutgoing);
+	IncomingTransitions.Reserve(NumIncoming);
+}
+
 void FSMState_Base::InitializeTransitions()
 {
 	ExecuteInitializeNodes();
 	
-	TArray<FSMTransition*> AllTransitions;
-	GetAllTransitionChains(AllTransitions);
-	
-	for(FSMTransition* Transition : AllTransitions)
+	for(FSMTransition* Transition : GetAllTransitionChains())
 	{
 		Transition->ExecuteInitializeNodes();
 	}
+
+	if (HasGlobalTransitions())
+	{
+		if (FSMStateMachine* Owner = (FSMStateMachine*)GetOwnerNode())
+		{
+			Owner->NotifyGlobalTransitionsOfStateStart(this);
+		}
+	}
 }
 
 void FSMState_Base::ShutdownTransitions()
 {
-	TArray<FSMTransition*> AllTransitions;
-	GetAllTransitionChains(AllTransitions);
-
-	for (FSMTransition* Transition : AllTransitions)
+	for (FSMTransition* Transition : GetAllTransitionChains())
 	{
 		Transition->ExecuteShutdownNodes();
 	}
 
+	if (HasGlobalTransitions())
+	{
+		if (FSMStateMachine* Owner = (FSMStateMachine*)GetOwnerNode())
+		{
+			Owner->NotifyGlobalTransitionsOfStateEnd(this);
+		}
+	}
+
 	ExecuteShutdownNodes();
 }
 
@@ -332,7 +433,7 @@ bool FSMState::StartState()
 		return false;
 	}
 
-	if (CanExecuteLogic())
+	if (CanExecuteLogic() && CanExecuteEventLogic())
 	{
 		Execute();
 	}
@@ -347,7 +448,7 @@ bool FSMState::UpdateState(float DeltaSeconds)
 		return false;
 	}
 
-	if (CanExecuteLogic())
+	if (CanExecuteUpdateLogic())
 	{
 		UpdateStateGraphEvaluator.Execute((void*)&DeltaSeconds);
 	}
@@ -362,7 +463,7 @@ bool FSMState::EndState(float DeltaSeconds, const FSMTransition* TransitionToTak
 		return false;
 	}
 
-	if (CanExecuteLogic())
+	if (CanExecuteLogic() && CanExecuteEventLogic())
 	{
 		bIsStateEnding = true;
 		EndStateGraphEvaluator.Execute();
@@ -5,6 +5,110 @@
 #include "SMUtils.h"
 #include "SMStateMachineInstance.h"
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("SMTransitionLimitReached"), STAT_TransitionLimitReached, STATGROUP_LogicDriver);
+
+void FSMStateSet::Init(int32 NumIndices)
+{
+	const int32 NumExisting = Bits.Num();
+	if (NumExisting < NumIndices)
+	{
+		Bits.SetNumUninitialized(NumIndices);
+		Bits.SetRange(NumExisting, NumIndices - NumExisting, false);
+		SlotsByIndex.SetNumUninitialized(NumIndices);
+	}
+}
+
+bool FSMStateSet::Contains(const FSMState_Base* State, int32 Index) const
+{
+	if (Index == INDEX_NONE)
+	{
+		return State && Slots.ContainsByPredicate([State](const FSlot& Slot) { return Slot.State == State; });
+	}
+	
+	return Index < Bits.Num() && Bits[Index];
+}
+
+void FSMStateSet::Add(FSMState_Base* State, int32 Index)
+{
+	if (!State || Contains(State, Index))
+	{
+		return;
+	}
+
+	int32 Slot;
+	if (FreeSlots.Num() > 0)
+	{
+		Slot = FreeSlots.Pop(false);
+		Slots[Slot] = { State, Index };
+	}
+	else
+	{
+		Slot = Slots.Add({ State, Index });
+	}
+
+	if (Index != INDEX_NONE)
+	{
+		Init(Index + 1);
+		Bits[Index] = true;
+		SlotsByIndex[Index] = Slot;
+	}
+
+	NumStates++;
+}
+
+void FSMStateSet::Remove(FSMState_Base* State, int32 Index)
+{
+	if (!State || !Contains(State, Index))
+	{
+		return;
+	}
+
+	int32 Slot;
+	if (Index != INDEX_NONE)
+	{
+		Bits[Index] = false;
+		Slot = SlotsByIndex[Index];
+	}
+	else
+	{
+		Slot = Slots.IndexOfByPredicate([State](const FSlot& InSlot) { return InSlot.State == State; });
+	}
+
+	check(Slots[Slot].State == State);
+	Slots[Slot] = { nullptr, INDEX_NONE };
+	FreeSlots.Add(Slot);
+	
+	NumStates--;
+}
+
+void FSMStateSet::Reset()
+{
+	// Only members have their bit set.
+	for (const FSlot& Slot : Slots)
+	{
+		if (Slot.State && Slot.Index != INDEX_NONE)
+		{
+			Bits[Slot.Index] = false;
+		}
+	}
+	
+	Slots.Reset();
+	FreeSlots.Reset();
+	NumStates = 0;
+}
+
+TArray<FSMState_Base*> FSMStateSet::Array() const
+{
+	TArray<FSMState_Base*> Result;
+	Result.Reserve(NumStates);
+	for (FSMState_Base* State : *this)
+	{
+		Result.Add(State);
+	}
+
+	return Result;
+}
+
 FSMStateMachine::FSMStateMachine() : Super(), bHasAdditionalLogic(false), bReuseCurrentState(false),
                                      bOnlyReuseIfNotEndState(false), bAllowIndependentTick(false),
                                      bCallReferenceTickOnManualUpdate(true), bReuseReference(false),
@@ -40,132 +144,148 @@ void FSMStateMachine::ProcessStates(float DeltaSeconds, bool bForceTransitionEva
 		return;
 	}
 
-	bool bStateChanged = false;
-	TArray<FSMState_Base*> ActiveStatesCopy = GetActiveStates();
-	for (FSMState_Base* CurrentState : ActiveStatesCopy)
+	// Each pass starts states entered by the previous pass and evaluates their transitions. States already processed are skipped
+	// so passes end once no transition is taken, or once the transition limit is reached. Remaining transitions wait for the next update.
+	const int32 MaxTransitions = OwningInstance ? OwningInstance->GetMaxTransitionsPerUpdate() : 0;
+	int32 TransitionsTaken = 0;
+	bool bTransitionLimitReached = false;
+	bool bStateChanged;
+	
+	do
 	{
-		bool bStateJustStarted = false;
-		
-		// Always start the state before attempting a transition.
-		if (!CurrentState->IsActive() || CurrentState->HasBeenReenteredFromParallelState())
+		bStateChanged = false;
+		TArray<FSMState_Base*> ActiveStatesCopy = GetActiveStates();
+		for (FSMState_Base* CurrentState : ActiveStatesCopy)
 		{
-			// prevents repeated reentry if this state was ending and triggered a transition which led to processing.
-			if (CurrentState->IsStateEnding())
+			const int32 CurrentStateIndex = GetLocalStateIndex(CurrentState);
+			bool bStateJustStarted = false;
+		
+			// Always start the state before attempting a transition.
+			if (!CurrentState->IsActive() || CurrentState->HasBeenReenteredFromParallelState())
 			{
-				continue;
-			}
+				// prevents repeated reentry if this state was ending and triggered a transition which led to processing.
+				if (CurrentState->IsStateEnding())
+				{
+					continue;
+				}
 
-			if (!CurrentState->IsActive() || !CurrentState->HasBeenReenteredFromParallelState() || CurrentState->bAllowParallelReentry)
-			{
-				CurrentState->StartState();
-				bStateJustStarted = true;
-			}
+				if (!CurrentState->IsActive() || !CurrentState->HasBeenReenteredFromParallelState() || CurrentState->bAllowParallelReentry)
+				{
+					CurrentState->StartState();
+					bStateJustStarted = true;
+				}
 			
-			// Prevents repeated reentry with parallel states.
-			CurrentState->NotifyOfParallelReentry(false);
+				// Prevents repeated reentry with parallel states.
+				CurrentState->NotifyOfParallelReentry(false);
 			
-			// It's possible the current state is null depending on start state's logic (such as if it is shutting down this state machine).
-			if (!ActiveStates.Contains(CurrentState) || !CurrentState->bEvalTransitionsOnStart)
+				// It's possible the current state is null depending on start state's logic (such as if it is shutting down this state machine).
+				if (!ActiveStates.Contains(CurrentState, CurrentStateIndex) || !CurrentState->bEvalTransitionsOnStart)
+				{
+					// Don't perform transition evaluation in same tick unless specified.
+					continue;
+				}
+			}
+
+			/*
+			 * This can be true when there are multiple active states, and the first one transitions and reentries into the next one.
+			 * Without this check that would cause a stack overflow.
+			 */
+			if (ProcessingStates.Contains(CurrentState, CurrentStateIndex))
 			{
-				// Don't perform transition evaluation in same tick unless specified.
 				continue;
 			}
-		}
 
-		/*
-		 * This can be true when there are multiple active states, and the first one transitions and reentries into the next one.
-		 * Without this check that would cause a stack overflow.
-		 */
-		if (ProcessingStates.Contains(CurrentState))
-		{
-			continue;
-		}
-
-		// Evaluate possible transitions and return the best one. If the state machine is waiting, not allowed to evaluate transitions,
-		// or this is a normal update and the state isn't allowed to evaluate, then skip evaluation.
-		bool bCanCheckTransitions = !(bWaitingForTransitionUpdate || !bCanEvaluateTransitions ||
-			(!bForceTransitionEvaluationOnly && !CurrentState->CanEvaluateTransitionsOnTick()));
+			// Evaluate possible transitions and return the best one. If the state machine is waiting, not allowed to evaluate transitions,
+			// or this is a normal update and the state isn't allowed to evaluate, then skip evaluation.
+			bool bCanCheckTransitions = !(bWaitingForTransitionUpdate || !bCanEvaluateTransitions || bTransitionLimitReached ||
+				(!bForceTransitionEvaluationOnly && !CurrentState->CanEvaluateTransitionsOnTick()));
 
-		if (bCanCheckTransitions && CurrentState->IsStateMachine())
-		{
-			if (((FSMStateMachine*)CurrentState)->bWaitForEndState)
+			if (bCanCheckTransitions && CurrentState->IsStateMachine())
 			{
-				bCanCheckTransitions = (FSMStateMachine*)CurrentState->IsInEndState();
+				if (((FSMStateMachine*)CurrentState)->bWaitForEndState)
+				{
+					bCanCheckTransitions = (FSMStateMachine*)CurrentState->IsInEndState();
+				}
 			}
-		}
 		
-		TArray<TArray<FSMTransition*>> ParallelTransitionChains;
-		if (bCanCheckTransitions && CurrentState->GetValidTransition(ParallelTransitionChains))
-		{
-			bool bSuccess = false;
-			for (TArray<FSMTransition*>& TransitionChain : ParallelTransitionChains)
+			TArray<TArray<FSMTransition*>> ParallelTransitionChains;
+			if (bCanCheckTransitions && (CurrentState->HasGlobalTransitions() ? GetValidTransitionIncludingGlobal(CurrentState, ParallelTransitionChains) :
+				CurrentState->GetValidTransition(ParallelTransitionChains)))
 			{
-				// This specific transition doesn't allow same tick eval with start state.
-				if (bStateJustStarted && !FSMTransition::CanEvaluateWithStartState(TransitionChain))
+				bool bSuccess = false;
+				for (TArray<FSMTransition*>& TransitionChain : ParallelTransitionChains)
 				{
-					continue;
-				}
-
-				if (FSMState_Base* NextState = FSMTransition::GetFinalStateFromChain(TransitionChain))
-				{
-					// If the next state is already active the transition may not allow evaluation. Doesn't apply to self transitions.
-					if (NextState != CurrentState && NextState->IsActive() && !FSMTransition::CanChainEvalIfNextStateActive(TransitionChain))
+					// This specific transition doesn't allow same tick eval with start state.
+					if (bStateJustStarted && !FSMTransition::CanEvaluateWithStartState(TransitionChain))
 					{
 						continue;
 					}
-				}
+
+					if (FSMState_Base* NextState = FSMTransition::GetFinalStateFromChain(TransitionChain))
+					{
+						// If the next state is already active the transition may not allow evaluation. Doesn't apply to self transitions.
+						if (NextState != CurrentState && NextState->IsActive() && !FSMTransition::CanChainEvalIfNextStateActive(TransitionChain))
+						{
+							continue;
+						}
+					}
 				
-				for (FSMTransition* Transition : TransitionChain)
-				{
-					if (ProcessTransition(Transition, nullptr, DeltaSeconds))
+					for (FSMTransition* Transition : TransitionChain)
 					{
-						ProcessingStates.Add(CurrentState);
-						// If this succeeds once we are good. It's possible a multi chain may have a failure when in a networked environment
-						// because one was already taken.
-						bSuccess = true;
+						if (ProcessTransition(Transition, nullptr, DeltaSeconds))
+						{
+							TransitionsTaken++;
+							ProcessingStates.Add(CurrentState, CurrentStateIndex);
+							// If this succeeds once we are good. It's possible a multi chain may have a failure when in a networked environment
+							// because one was already taken.
+							bSuccess = true;
+						}
 					}
 				}
-			}
 
-			if (bSuccess)
-			{
-				bStateChanged = true;
-				//  May remain active in which case we should update.
-				if (!CurrentState->IsActive())
+				if (bSuccess)
 				{
-					continue;
+					bStateChanged = true;
+					bTransitionLimitReached = MaxTransitions > 0 && TransitionsTaken >= MaxTransitions;
+					
+					//  May remain active in which case we should update.
+					if (!CurrentState->IsActive())
+					{
+						continue;
+					}
 				}
 			}
-		}
 		
-		if (!bStateJustStarted)
-		{
-			if (bForceTransitionEvaluationOnly)
+			if (!bStateJustStarted)
 			{
-				// This is an optimized transition evaluation branch. Forward request directly to nested FSM if present.
-				if (CurrentState->IsStateMachine())
+				if (bForceTransitionEvaluationOnly)
+				{
+					// This is an optimized transition evaluation branch. Forward request directly to nested FSM if present.
+					if (CurrentState->IsStateMachine())
+					{
+						((FSMStateMachine*)CurrentState)->ProcessStates(DeltaSeconds, bForceTransitionEvaluationOnly);
+					}
+				}
+				else
 				{
-					((FSMStateMachine*)CurrentState)->ProcessStates(DeltaSeconds, bForceTransitionEvaluationOnly);
+					// No transition found, perform general update.
+					ProcessingStates.Add(CurrentState, CurrentStateIndex);
+					CurrentState->UpdateState(DeltaSeconds);
 				}
 			}
-			else
-			{
-				// No transition found, perform general update.
-				ProcessingStates.Add(CurrentState);
-				CurrentState->UpdateState(DeltaSeconds);
-			}
 		}
 	}
+	while (bStateChanged && !bTransitionLimitReached);
 
-	if (bStateChanged)
+	if (bTransitionLimitReached)
 	{
-		ProcessStates(DeltaSeconds, bForceTransitionEvaluationOnly);
+		INC_DWORD_STAT(STAT_TransitionLimitReached);
 	}
 	
 	ProcessingStates.Reset();
 }
 
-bool FSMStateMachine::ProcessTransition(FSMTransition* Transition, const FSMNetworkedTransaction* Transaction, float DeltaSeconds, FDateTime* CurrentTime)
+bool FSMStateMachine::ProcessTransition(FSMTransition* Transition, const FSMNetworkedTransaction* Transaction, float DeltaSeconds, const double* CurrentTime)
 {
 	if (ReferencedStateMachine)
 	{
@@ -186,6 +306,12 @@ bool FSMStateMachine::ProcessTransition(FSMTransition* Transition, const FSMNetw
 		}
 	}
 
+	// A global transition from the server is taken from whichever of its states is active here.
+	if (bServerUpdate && Transition->bIsGlobalTransition)
+	{
+		Transition->TrySetGlobalFromActiveState();
+	}
+
 	// If this was called via server the state is likely still active.
 	if (bCanTransitionNow)
 	{
@@ -210,7 +336,7 @@ bool FSMStateMachine::ProcessTransition(FSMTransition* Transition, const FSMNetw
 
 		SetCurrentState(ToState, LastState);
 
-		if (!ActiveStates.Contains(ToState))
+		if (!ActiveStates.Contains(ToState, GetLocalStateIndex(ToState)))
 		{
 			const FString InstanceName = GetOwningInstance() ? GetOwningInstance()->GetName() : "Unknown";
 			LD_LOG_ERROR(TEXT("Current state not set for state machine node '%s'. The package '%s' may be getting cleaned up. Check your code for proper UE4 memory management."), *GetNodeName(), *InstanceName);
@@ -223,13 +349,13 @@ bool FSMStateMachine::ProcessTransition(FSMTransition* Transition, const FSMNetw
 	// This is a new transition not being supplied by the server.
 	if (!bServerUpdate && IsNetworked())
 	{
+		// The timestamp is recorded by the server when it replicates the transaction.
 		FSMNetworkedTransaction NewTransition(GetGuid(), Transition->GetGuid());
-		NewTransition.Timestamp = CurrentTime ? *CurrentTime : FDateTime::UtcNow();
 		
 		// Don't follow this transition a second time.
 		if (bCanTransitionNow)
 		{
-			PreviousTransactions.Add(NewTransition.TransactionGuid, NewTransition);
+			PreviousTransactions.Add(NewTransition.TransactionGuid, CurrentTime ? *CurrentTime : FPlatformTime::Seconds());
 		}
 		else
 		{
@@ -242,32 +368,22 @@ bool FSMStateMachine::ProcessTransition(FSMTransition* Transition, const FSMNetw
 	else if (bServerUpdate && Transaction)
 	{
 		// Don't record a server transition more than once either.
-		PreviousTransactions.Add(Transaction->TransactionGuid, *Transaction);
+		PreviousTransactions.Add(Transaction->TransactionGuid, CurrentTime ? *CurrentTime : FPlatformTime::Seconds());
 	}
 
 	return bCanTransitionNow;
 }
 
-void FSMStateMachine::CleanupPreviousTransactions(const FDateTime& CurrentTime, float PreviousTransactionTimeout)
+void FSMStateMachine::CleanupPreviousTransactions(double CurrentTime, float PreviousTransactionTimeout)
 {
-	// Check for and remove expired transactions.
-	if (PreviousTransactions.Num())
-	{
-		TArray<FGuid> TransactionsToRemove;
-		const FTimespan Seconds = FTimespan::FromSeconds((double)PreviousTransactionTimeout);
-		for (const auto& PreviousTransaction : PreviousTransactions)
-		{
-			FDateTime ExpirationDate = PreviousTransaction.Value.Timestamp + Seconds;
-			if (ExpirationDate <= CurrentTime)
-			{
-				TransactionsToRemove.Add(PreviousTransaction.Key);
-			}
-		}
+	PreviousTransactions.RemoveExpired(CurrentTime, (double)PreviousTransactionTimeout);
+}
 
-		for (const FGuid& Id : TransactionsToRemove)
-		{
-			PreviousTransactions.Remove(Id);
-		}
+void FSMStateMachine::SetPreviousTransactionCapacity(int32 Capacity)
+{
+	if (PreviousTransactions.GetCapacity() != Capacity)
+	{
+		PreviousTransactions.SetCapacity(Capacity);
 	}
 }
 
@@ -337,7 +453,7 @@ void FSMStateMachine::AddActiveState(FSMState_Base* State, bool bReplicate)
 void FSMStateMachine::RemoveActiveState(FSMState_Base* State, bool bReplicate)
 {
 	State->EndState(0.f);
-	ActiveStates.Remove(State);
+	ActiveStates.Remove(State, GetLocalStateIndex(State));
 
 	if (USMInstance* Instance = GetOwningInstance())
 	{
@@ -357,26 +473,40 @@ void FSMStateMachine::RemoveActiveState(FSMState_Base* State, bool bReplicate)
 	}
 }
 
+void FSMStateMachine::ClearActiveStatesForSnapshot()
+{
+	ActiveStates.Reset();
+	ProcessingStates.Reset();
+	bWaitingForTransitionUpdate = false;
+	TimeSpentWaitingForUpdate = 0.f;
+}
+
+void FSMStateMachine::AddActiveStateForSnapshot(FSMState_Base* State)
+{
+	ActiveStates.Add(State, GetLocalStateIndex(State));
+}
+
 void FSMStateMachine::SetCurrentState(FSMState_Base* ToState, FSMState_Base* FromState)
 {
 	const bool bStartedInEndState = IsInEndState();
 	
 	if (FromState && !FromState->bStayActiveOnStateChange)
 	{
-		ActiveStates.Remove(FromState);
+		ActiveStates.Remove(FromState, GetLocalStateIndex(FromState));
 	}
 
 	if (ToState)
 	{
 		ToState->SetPreviousEnteredState(FromState);
-		if (ActiveStates.Contains(ToState))
+		const int32 ToStateIndex = GetLocalStateIndex(ToState);
+		if (ActiveStates.Contains(ToState, ToStateIndex))
 		{
 			// Reentered.
 			ToState->NotifyOfParallelReentry();
 		}
 		else
 		{
-			ActiveStates.Add(ToState);
+			ActiveStates.Add(ToState, ToStateIndex);
 		}
 	}
 
@@ -408,6 +538,13 @@ void FSMStateMachine::Initialize(UObject* Instance)
 	{
 		Node->Initialize(Instance);
 	}
+
+	GlobalTransitions.Sort([](const FSMTransition& lhs, const FSMTransition& rhs)
+	{
+		return lhs.Priority < rhs.Priority;
+	});
+	ActiveStates.Init(States.Num());
+	ProcessingStates.Init(States.Num());
 }
 
 void FSMStateMachine::Reset()
@@ -427,7 +564,7 @@ bool FSMStateMachine::StartState()
 
 	if(bHasAdditionalLogic)
 	{
-		if (CanExecuteLogic())
+		if (CanExecuteLogic() && CanExecuteEventLogic())
 		{
 			Execute();
 		}
@@ -471,7 +608,7 @@ bool FSMStateMachine::UpdateState(float DeltaSeconds)
 
 	if (bHasAdditionalLogic)
 	{
-		if (CanExecuteLogic())
+		if (CanExecuteUpdateLogic())
 		{
 			UpdateStateGraphEvaluator.Execute((void*)&DeltaSeconds);
 		}
@@ -514,7 +651,7 @@ bool FSMStateMachine::EndState(float DeltaSeconds, const FSMTransition* Transiti
 
 	if (bHasAdditionalLogic)
 	{
-		if (CanExecuteLogic())
+		if (CanExecuteLogic() && CanExecuteEventLogic())
 		{
 			EndStateGraphEvaluator.Execute();
 		}
@@ -731,10 +868,14 @@ TArray<FSMState_Base*> FSMStateMachine::GetActiveStates() const
 {
 	if (ReferencedStateMachine)
 	{
-		if (ReferencedStateMachine->GetRootStateMachine().HasActiveStates())
+		// Read the referenced root directly rather than forwarding the call.
+		const FSMStateMachine& ReferencedRoot = ReferencedStateMachine->GetRootStateMachine();
+		if (ReferencedRoot.HasActiveStates())
 		{
-			return ReferencedStateMachine->GetRootStateMachine().GetActiveStates();
+			return ReferencedRoot.ActiveStates.Array();
 		}
+
+		return HasActiveStates() ? ActiveStates.Array() : ReferencedRoot.TemporaryEntryStates.Array();
 	}
 	
 	if (HasActiveStates())
@@ -742,14 +883,14 @@ TArray<FSMState_Base*> FSMStateMachine::GetActiveStates() const
 		return ActiveStates.Array();
 	}
 	
-	return ReferencedStateMachine ? ReferencedStateMachine->GetRootStateMachine().TemporaryEntryStates.Array() : TemporaryEntryStates.Array();
+	return TemporaryEntryStates.Array();
 }
 
 TArray<FSMState_Base*> FSMStateMachine::GetAllNestedActiveStates() const
 {
 	if (ReferencedStateMachine)
 	{
-		return ReferencedStateMachine->GetAllActiveStates();
+		return ReferencedStateMachine->GetRootStateMachine().GetAllNestedActiveStates();
 	}
 
 	TArray<FSMState_Base*> OutStates = GetActiveStates();
@@ -769,7 +910,7 @@ bool FSMStateMachine::IsInEndState() const
 {
 	if (ReferencedStateMachine)
 	{
-		return ReferencedStateMachine->IsInEndState();
+		return ReferencedStateMachine->GetRootStateMachine().IsInEndState();
 	}
 
 	for (FSMState_Base* CurrentState : ActiveStates)
@@ -823,10 +964,17 @@ FSMNode_Base* FSMStateMachine::GetOwnerNode() const
 	return Super::GetOwnerNode();
 }
 
+void FSMStateMachine::ReserveNodes(int32 NumStates, int32 NumTransitions, int32 NumGlobalTransitions)
+{
+	States.Reserve(NumStates);
+	Transitions.Reserve(NumTransitions);
+	GlobalTransitions.Reserve(NumGlobalTransitions);
+}
+
 void FSMStateMachine::AddState(FSMState_Base* State)
 {
 	State->SetOwnerNode(this);
-	States.AddUnique(State);
+	State->SetStateIndex(States.AddUnique(State));
 }
 
 void FSMStateMachine::AddTransition(FSMTransition* Transition)
@@ -835,6 +983,75 @@ void FSMStateMachine::AddTransition(FSMTransition* Transition)
 	Transitions.AddUnique(Transition);
 }
 
+void FSMStateMachine::AddGlobalTransition(FSMTransition* Transition)
+{
+	check(Transition->bIsGlobalTransition);
+	AddTransition(Transition);
+	GlobalTransitions.AddUnique(Transition);
+}
+
+bool FSMStateMachine::GetValidTransitionIncludingGlobal(FSMState_Base* State, TArray<TArray<FSMTransition*>>& OutTransitions)
+{
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("SMStateMachine::GetValidTransitionIncludingGlobal"), STAT_SMStateMachine_GetValidTransitionIncludingGlobal, STATGROUP_LogicDriver);
+
+	// Conduits evaluate their own condition before any transition.
+	const bool bIsConduit = State->IsConduit();
+	if (bIsConduit && State->GetValidTransition(OutTransitions))
+	{
+		return true;
+	}
+	
+	static const TArray<FSMTransition*> NoTransitions;
+	const TArray<FSMTransition*>& StateTransitions = bIsConduit ? NoTransitions : State->GetOutgoingTransitions();
+
+	// Both lists are sorted by priority. The state's own transitions win ties.
+	const TArray<FSMTransition*>& StateGlobalTransitions = State->GetGlobalTransitions();
+	int32 StateIdx = 0;
+	int32 GlobalIdx = 0;
+	while (StateIdx < StateTransitions.Num() || GlobalIdx < StateGlobalTransitions.Num())
+	{
+		FSMTransition* Transition;
+		if (GlobalIdx >= StateGlobalTransitions.Num() || (StateIdx < StateTransitions.Num() && StateTransitions[StateIdx]->Priority <= StateGlobalTransitions[GlobalIdx]->Priority))
+		{
+			Transition = StateTransitions[StateIdx++];
+		}
+		else
+		{
+			Transition = StateGlobalTransitions[GlobalIdx++];
+			Transition->SetGlobalFromState(State);
+		}
+		
+		TArray<FSMTransition*> Chain;
+		if (Transition->CanTransition(Chain))
+		{
+			OutTransitions.Add(Chain);
+
+			if (bIsConduit || !Transition->bRunParallel)
+			{
+				return true;
+			}
+		}
+	}
+
+	return OutTransitions.Num() > 0;
+}
+
+void FSMStateMachine::NotifyGlobalTransitionsOfStateStart(FSMState_Base* State)
+{
+	for (FSMTransition* Transition : State->GetGlobalTransitions())
+	{
+		Transition->NotifyGlobalFromStateStarted(State);
+	}
+}
+
+void FSMStateMachine::NotifyGlobalTransitionsOfStateEnd(FSMState_Base* State)
+{
+	for (FSMTransition* Transition : State->GetGlobalTransitions())
+	{
+		Transition->NotifyGlobalFromStateEnded(State);
+	}
+}
+
 TArray<FSMNode_Base*> FSMStateMachine::GetAllNodes(bool bIncludeNested) const
 {
 	TArray<FSMNode_Base*> Results;
@@ -3,7 +3,9 @@
 #include "SMTransition.h"
 #include "SMConduit.h"
 #include "SMState.h"
+#include "SMStateMachine.h"
 #include "SMTransitionInstance.h"
+#include "SMNodeStructInstance.h"
 #include "SMLogging.h"
 #include "SMUtils.h"
 
@@ -23,7 +25,11 @@ struct TransitionEvaluatorHelper
 		{
 			TransitionPtr->bIsEvaluating = false;
 #if WITH_EDITORONLY_DATA
-			TransitionPtr->bWasEvaluating = true; // Will be set to false from the editor.
+			TransitionPtr->bWasEvaluating = true;
+			if (USMInstance* Instance = TransitionPtr->GetOwningInstance())
+			{
+				Instance->RecordDebugEvent(*TransitionPtr, ESMDebugEventType::Evaluated);
+			}
 #endif
 		}
 	}
@@ -44,7 +50,8 @@ FSMTransition::FSMTransition() : Super(), Priority(0), bCanEnterTransition(false
                                  bIsEvaluating(false), bCanEvaluate(true), bCanEvaluateFromEvent(true),
                                  bRunParallel(false),
                                  bEvalIfNextStateActive(true), bCanEvalWithStartState(true),
-                                 bAlwaysFalse(false), ConditionalEvaluationType(), FromState(nullptr), ToState(nullptr)
+                                 bAlwaysFalse(false), bIsGlobalTransition(false), ConditionalEvaluationType(), FromState(nullptr), ToState(nullptr),
+                                 NumActiveGlobalFromStates(0)
 {
 }
 
@@ -60,6 +67,7 @@ void FSMTransition::Initialize(UObject* Instance)
 void FSMTransition::Reset()
 {
 	Super::Reset();
+	NumActiveGlobalFromStates = 0;
 	TransitionEnteredGraphEvaluator.Reset();
 	TransitionPreEvaluateGraphEvaluator.Reset();
 	TransitionPostEvaluateGraphEvaluator.Reset();
@@ -89,7 +97,7 @@ void FSMTransition::ExecuteShutdownNodes()
 {
 	bIsEvaluating = false;
 #if WITH_EDITORONLY_DATA
-	bWasEvaluating = false; // Will be set to false from the editor.
+	bWasEvaluating = false;
 #endif
 	
 	Super::ExecuteShutdownNodes();
@@ -104,12 +112,19 @@ void FSMTransition::TakeTransition()
 {
 	SetActive(true);
 
-	if (USMTransitionInstance* TransitionInstance = Cast<USMTransitionInstance>(NodeInstance))
+	if (CanExecuteEventLogic())
 	{
-		TransitionInstance->OnTransitionEnteredEvent.Broadcast(TransitionInstance);
-	}
+		if (NodeStructInstance)
+		{
+			NodeStructInstance->OnTransitionEntered(*this);
+		}
+		else if (USMTransitionInstance* TransitionInstance = Cast<USMTransitionInstance>(NodeInstance))
+		{
+			TransitionInstance->OnTransitionEnteredEvent.Broadcast(TransitionInstance);
+		}
 	
-	TransitionEnteredGraphEvaluator.Execute();
+		TransitionEnteredGraphEvaluator.Execute();
+	}
 	SetActive(false);
 
 	if (GetToState()->IsConduit())
@@ -165,7 +180,11 @@ bool FSMTransition::CanTransitionFromEvent()
 	{
 		bIsEvaluating = false;
 #if WITH_EDITORONLY_DATA
-		bWasEvaluating = true; // Will be set to false from the editor.
+		bWasEvaluating = true;
+		if (OwningInstance)
+		{
+			OwningInstance->RecordDebugEvent(*this, ESMDebugEventType::Evaluated);
+		}
 #endif
 	}
 	
@@ -181,44 +200,24 @@ bool FSMTransition::CanTransition(TArray<FSMTransition*>& Transitions)
 		return false;
 	}
 
-	bool bSuccess = false;
-
-	// Additional transitions that occur after this transition.
-	TArray<TArray<FSMTransition*>> NextTransitions;
+	// Conduits append the rest of the chain after this transition, so add it first and roll back on failure.
+	const int32 ChainStart = Transitions.Add(const_cast<FSMTransition*>(this));
 
 	FSMState_Base* NextState = GetToState();
-	if (!NextState->IsConduit())
-	{
-		// Normal state, we're good to transition.
-		bSuccess = true;
-	}
-	else
+	if (NextState->IsConduit())
 	{
-		// This is a conduit.
 		FSMConduit* Conduit = (FSMConduit*)NextState;
-		if (!Conduit->IsConfiguredAsTransition())
-		{
-			// We can enter this conduit as a state, doesn't matter if we're stuck here.
-			bSuccess = true;
-		}
-		else if (Conduit->GetValidTransition(NextTransitions))
-		{
-			bSuccess = true;
-		}
-		// else conduit couldn't complete a valid transition.
-	}
 
-	if (bSuccess)
-	{
-		Transitions.Add(const_cast<FSMTransition*>(this));
-		if (NextTransitions.Num() > 0)
+		// A conduit not configured as a transition is entered as a state, doesn't matter if we're stuck there.
+		if (Conduit->IsConfiguredAsTransition() && !Conduit->GetValidTransitionChain(Transitions))
 		{
-			// Conduits will only have possible transition chain since they don't support starting parallel states.
-			Transitions.Append(NextTransitions[0]);
+			// Conduit couldn't complete a valid transition.
+			Transitions.SetNum(ChainStart, false);
+			return false;
 		}
 	}
 
-	return bSuccess;
+	return true;
 }
 
 void FSMTransition::GetConnectedTransitions(TArray<FSMTransition*>& Transitions) const
@@ -266,6 +265,78 @@ void FSMTransition::SetToState(FSMState_Base* State)
 	ToState->AddIncomingTransition(this);
 }
 
+void FSMTransition::AddGlobalFromState(FSMState_Base* State)
+{
+	check(bIsGlobalTransition);
+	GlobalFromStates.AddUnique(State);
+	State->GlobalTransitions.AddUnique(this);
+	
+	// Never leave the from state null so read states and debug info remain valid before the first evaluation.
+	if (!FromState)
+	{
+		FromState = State;
+	}
+}
+
+void FSMTransition::SetGlobalFromState(FSMState_Base* State)
+{
+	checkSlow(CanTransitionFromGlobalState(State));
+	FromState = State;
+}
+
+bool FSMTransition::TrySetGlobalFromActiveState()
+{
+	if (!bIsGlobalTransition)
+	{
+		return false;
+	}
+
+	if (FromState && FromState->IsActive())
+	{
+		return true;
+	}
+	
+	const FSMStateMachine* Owner = (FSMStateMachine*)GetOwnerNode();
+	for (FSMState_Base* State : GlobalFromStates)
+	{
+		if (State->IsActive() || (Owner && Owner->IsStateInActiveList(State)))
+		{
+			FromState = State;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FSMTransition::NotifyGlobalFromStateStarted(FSMState_Base* State)
+{
+	SetGlobalFromState(State);
+	
+	if (NumActiveGlobalFromStates++ == 0)
+	{
+		TArray<FSMTransition*> Chain;
+		GetConnectedTransitions(Chain);
+		for (FSMTransition* Transition : Chain)
+		{
+			Transition->ExecuteInitializeNodes();
+		}
+	}
+}
+
+void FSMTransition::NotifyGlobalFromStateEnded(FSMState_Base* State)
+{
+	if (NumActiveGlobalFromStates > 0 && --NumActiveGlobalFromStates == 0)
+	{
+		TArray<FSMTransition*> Chain;
+		GetConnectedTransitions(Chain);
+		for (FSMTransition* Transition : Chain)
+		{
+			Transition->ExecuteShutdownNodes();
+		}
+	}
+}
+
 bool FSMTransition::CanEvaluateWithStartState(const TArray<FSMTransition*>& TransitionChain)
 {
 	for (FSMTransition* Transition : TransitionChain)
@@ -1,6 +1,7 @@
 // Copyright Recursoft LLC 2019-2020. All Rights Reserved.
 #include "SMBlueprintFunctions.h"
 #include "SMLogging.h"
+#include "UObject/Stack.h"
 
 
 void FSMExposedFunctionHandler::Initialize(UObject* StateMachineObject)
@@ -30,11 +31,13 @@ void FSMExposedFunctionHandler::Initialize(UObject* StateMachineObject)
 			check(Function);
 		}
 
+		bIsNativeFunction = Function->HasAnyFunctionFlags(FUNC_Native) && Function->ParmsSize == 0;
 		bInitialized = true;
 	}
 	else
 	{
 		Function = nullptr;
+		bIsNativeFunction = false;
 	}
 }
 
@@ -57,5 +60,14 @@ void FSMExposedFunctionHandler::Execute(void* Parms) const
 	}
 
 	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("SMBlueprintFunction::GraphEvaluation"), STAT_SMBlueprintFunctionHandler_Execute, STATGROUP_LogicDriver);
+
+	if (bIsNativeFunction)
+	{
+		// Same as ProcessEvent for a native function without parameters, minus the script and networking checks.
+		FFrame Stack(OwnerObject, Function, nullptr, nullptr, Function->ChildProperties);
+		Function->Invoke(OwnerObject, Stack, nullptr);
+		return;
+	}
+
 	OwnerObject->ProcessEvent(Function, Parms);
 }
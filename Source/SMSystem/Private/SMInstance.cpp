@@ -6,6 +6,8 @@
 #include "SMLogging.h"
 #include "SMUtils.h"
 #include "SMStateMachineComponent.h"
+#include "SMTraceRecorder.h"
+#include "Engine/BlueprintGeneratedClass.h"
 
 #define LOCTEXT_NAMESPACE "SMInstance"
 
@@ -20,11 +22,20 @@
 		} \
 
 
-USMInstance::USMInstance() : Super()
+USMInstance::USMInstance() : Super(), NodeStructMemory(nullptr), NodeStructMemorySize(0), NodeStructMemoryUsed(0)
 {
+	MasterReferenceOwner = nullptr;
 	bCanEvaluateTransitionsLocally = true;
 	bCanTakeTransitionsLocally = true;
 	bCanExecuteStateLogic = true;
+	PreviousTransactionCapacity = 0;
+	bLODAllowsStateUpdateLogic = true;
+	bLODAllowsTickTransitionEvaluation = true;
+	CurrentTickLOD = INDEX_NONE;
+	TickIntervalBeforeLOD = 0.f;
+	TimeSinceTickLODUpdate = 0.f;
+	FixedStepAccumulator = 0.f;
+	FixedStepFrame = 0;
 }
 
 bool USMInstance::IsTickable() const
@@ -79,7 +90,16 @@ void USMInstance::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifet
 
 void USMInstance::BeginDestroy()
 {
+	if (FSMTraceRecorder::IsRecording())
+	{
+		FSMTraceRecorder::Get().RemoveInstance(this);
+	}
+	
 	Shutdown();
+
+	// Initialization may have failed after nodes were created.
+	DestroyNodeStructInstances();
+	
 	Super::BeginDestroy();
 }
 
@@ -112,6 +132,9 @@ void USMInstance::Initialize(UObject* Context)
 		return;
 	}
 
+	// Struct nodes are constructed while initializing.
+	AllocateNodeStructMemory();
+	
 	// Initialize the graph function calls.
 	RootStateMachine.Initialize(this);
 
@@ -120,20 +143,47 @@ void USMInstance::Initialize(UObject* Context)
 	RootStateMachine.CalculatePathGuid(Paths);
 
 	/* Build out a map of the state machine to use with node retrieval. */
+	ReserveNodeMaps(Properties);
 	TSet<USMInstance*> InstancesMapped;
 	BuildStateMachineMap(&RootStateMachine, InstancesMapped);
 	
 #if WITH_EDITORONLY_DATA
 	// Load debug object for this instance.
-	DebugStateMachine = FSMDebugStateMachine();
+	DebugStateMachine.ResetMappedNodes();
 	for (const auto& KeyVal : GuidNodeMap)
 	{
 		DebugStateMachine.UpdateRuntimeNode(KeyVal.Value);
 	}
 #endif
 	
+	if (bUseFixedTimeStep)
+	{
+		SetUseFixedTimeStep(true, FixedTimeStep);
+	}
+	
+	if (bEnableRewind && !ReferenceOwner)
+	{
+		InitializeRewind();
+	}
+	
+	if (bEnableTickLOD)
+	{
+		SortTickLODTiers();
+
+		if (!TickLODProvider)
+		{
+			TickLODProvider = NewObject<USMTickLODProvider_ViewDistance>(this);
+		}
+	}
+	
+	bStateChangedEventOverridden = USMUtils::IsFunctionOverridden(GetClass(), USMInstance::StaticClass(), GET_FUNCTION_NAME_CHECKED(USMInstance, OnStateMachineStateChanged));
+	bTransitionTakenEventOverridden = USMUtils::IsFunctionOverridden(GetClass(), USMInstance::StaticClass(), GET_FUNCTION_NAME_CHECKED(USMInstance, OnStateMachineTransitionTaken));
+	
 	bInitialized = true;
 
+	// Bind persistent auto-bound events now that the context is available.
+	ExecuteInstanceNodes(true);
+
 	OnStateMachineInitialized();
 	OnStateMachineInitializedEvent.Broadcast(this);
 }
@@ -192,12 +242,277 @@ void USMInstance::Update(float DeltaSeconds)
 		Tick(DeltaSeconds);
 	}
 
-	Internal_Update(DeltaSeconds);
+	// Fixed steps are driven by the master instance only. References are updated through their owner's steps.
+	if (bUseFixedTimeStep && !ReferenceOwner)
+	{
+		UpdateFixedTimeStep(DeltaSeconds);
+	}
+	else
+	{
+		Internal_Update(DeltaSeconds);
+	}
 
 	// End update.
 	bIsUpdating = false;
 }
 
+void USMInstance::UpdateFixedTimeStep(float DeltaSeconds)
+{
+	FixedStepAccumulator += DeltaSeconds;
+
+	int32 NumSteps = FMath::FloorToInt(FixedStepAccumulator / FixedTimeStep);
+	FixedStepAccumulator -= NumSteps * FixedTimeStep;
+
+	if (NumSteps > MaxFixedSubsteps)
+	{
+		NumSteps = MaxFixedSubsteps;
+	}
+
+	for (int32 Step = 0; Step < NumSteps && RootStateMachine.IsActive(); ++Step)
+	{
+		RunFixedStep();
+	}
+}
+
+void USMInstance::RunFixedStep()
+{
+	Internal_Update(FixedTimeStep);
+	++FixedStepFrame;
+
+	if (RewindBuffer.Num() > 0)
+	{
+		RecordSnapshot();
+	}
+}
+
+void USMInstance::AdvanceFixedSteps(int32 NumSteps)
+{
+	if (bIsUpdating || !CheckIsInitialized() || !RootStateMachine.IsActive())
+	{
+		return;
+	}
+
+	if (!ensureAlwaysMsgf(bUseFixedTimeStep, TEXT("AdvanceFixedSteps called on %s when fixed time step is not enabled."), *GetName()))
+	{
+		return;
+	}
+
+	bIsUpdating = true;
+	
+	for (int32 Step = 0; Step < NumSteps && RootStateMachine.IsActive(); ++Step)
+	{
+		RunFixedStep();
+	}
+	
+	bIsUpdating = false;
+}
+
+bool USMInstance::RewindTo(int32 Frame)
+{
+	if (bIsUpdating || !CheckIsInitialized())
+	{
+		return false;
+	}
+
+	if (!CanRewindTo(Frame))
+	{
+		LD_LOG_WARNING(TEXT("Could not rewind %s to frame %d. The frame is not in the rewind buffer."), *GetName(), Frame);
+		return false;
+	}
+
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("SMInstance::RewindTo"), STAT_SMInstance_RewindTo, STATGROUP_LogicDriver);
+
+	ApplySnapshot(RewindBuffer[Frame % RewindBuffer.Num()]);
+
+	// Frames after this point are no longer valid and will be recorded again on resimulation.
+	for (FSMInstanceSnapshot& Snapshot : RewindBuffer)
+	{
+		if (Snapshot.Frame > Frame)
+		{
+			Snapshot.Reset();
+		}
+	}
+
+	return true;
+}
+
+void USMInstance::Resimulate(int32 NumFrames)
+{
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("SMInstance::Resimulate"), STAT_SMInstance_Resimulate, STATGROUP_LogicDriver);
+	
+	bIsResimulating = true;
+	AdvanceFixedSteps(NumFrames);
+	bIsResimulating = false;
+}
+
+void USMInstance::SetRewindEnabled(bool bEnable)
+{
+	bEnableRewind = bEnable;
+	
+	RewindBuffer.Empty();
+	RewindStates.Empty();
+	RewindTransitions.Empty();
+
+	if (bEnableRewind && IsInitialized() && !ReferenceOwner)
+	{
+		InitializeRewind();
+	}
+}
+
+bool USMInstance::CanExecuteStateEventLogic() const
+{
+	const USMInstance* Master = GetMasterReferenceOwnerConst();
+	return !Master->bIsResimulating || Master->bRunStateLogicOnResimulate;
+}
+
+bool USMInstance::CanRewindTo(int32 Frame) const
+{
+	return Frame >= 0 && RewindBuffer.Num() > 0 && RewindBuffer[Frame % RewindBuffer.Num()].Frame == Frame;
+}
+
+void USMInstance::InitializeRewind()
+{
+	if (!bUseFixedTimeStep)
+	{
+		LD_LOG_WARNING(TEXT("Rewind is enabled for %s but fixed time step is not. Rewind requires a fixed time step."), *GetName());
+		return;
+	}
+
+	GuidStateMap.GenerateValueArray(RewindStates);
+	GuidTransitionMap.GenerateValueArray(RewindTransitions);
+
+	RewindBuffer.SetNum(FMath::Max(RewindBufferSize, 1));
+}
+
+void USMInstance::RecordSnapshot()
+{
+	FSMInstanceSnapshot& Snapshot = RewindBuffer[FixedStepFrame % RewindBuffer.Num()];
+	Snapshot.Reset();
+	Snapshot.Frame = FixedStepFrame;
+
+	for (int32 Idx = 0; Idx < RewindStates.Num(); ++Idx)
+	{
+		FSMState_Base* State = RewindStates[Idx];
+		const FSMStateMachine* Owner = (FSMStateMachine*)State->GetOwnerNode();
+		
+		if (State->IsActive() || (Owner && Owner->IsStateInActiveList(State)))
+		{
+			FSMStateSnapshot& StateSnapshot = Snapshot.ActiveStates.AddDefaulted_GetRef();
+			StateSnapshot.StateIndex = Idx;
+			StateSnapshot.TimeInState = State->GetActiveTime();
+			StateSnapshot.FixedStepsInState = State->GetActiveFixedSteps();
+			StateSnapshot.bHasUpdated = State->HasUpdated();
+			StateSnapshot.bIsActive = State->IsActive();
+		}
+	}
+
+	for (int32 Idx = 0; Idx < RewindTransitions.Num(); ++Idx)
+	{
+		if (RewindTransitions[Idx]->bCanEnterTransitionFromEvent)
+		{
+			Snapshot.EventTransitions.Add(Idx);
+		}
+	}
+}
+
+void USMInstance::ApplySnapshot(const FSMInstanceSnapshot& Snapshot)
+{
+	TBitArray<> WasActive(false, RewindStates.Num());
+	TBitArray<> ActiveInSnapshot(false, RewindStates.Num());
+	for (const FSMStateSnapshot& StateSnapshot : Snapshot.ActiveStates)
+	{
+		ActiveInSnapshot[StateSnapshot.StateIndex] = StateSnapshot.bIsActive;
+	}
+
+	for (int32 Idx = 0; Idx < RewindStates.Num(); ++Idx)
+	{
+		FSMState_Base* State = RewindStates[Idx];
+		WasActive[Idx] = State->IsActive();
+
+		if (bRunStateLogicOnRewind && WasActive[Idx] && !ActiveInSnapshot[Idx] && !State->IsStateMachine())
+		{
+			State->EndState(0.f);
+		}
+	}
+
+	// Clear everything without running logic.
+	for (FSMState_Base* State : RewindStates)
+	{
+		State->RestoreFromSnapshot(false, 0.f, 0, false);
+
+		if (State->IsStateMachine())
+		{
+			FSMStateMachine* StateMachine = (FSMStateMachine*)State;
+			StateMachine->ClearActiveStatesForSnapshot();
+			
+			if (USMInstance* Reference = StateMachine->GetInstanceReference())
+			{
+				Reference->GetRootStateMachine().RestoreFromSnapshot(false, 0.f, 0, false);
+				Reference->GetRootStateMachine().ClearActiveStatesForSnapshot();
+			}
+		}
+	}
+
+	for (const FSMStateSnapshot& StateSnapshot : Snapshot.ActiveStates)
+	{
+		FSMState_Base* State = RewindStates[StateSnapshot.StateIndex];
+		if (FSMStateMachine* Owner = (FSMStateMachine*)State->GetOwnerNode())
+		{
+			Owner->AddActiveStateForSnapshot(State);
+		}
+
+		if (bRunStateLogicOnRewind && StateSnapshot.bIsActive && !WasActive[StateSnapshot.StateIndex] && !State->IsStateMachine())
+		{
+			State->StartState();
+		}
+		
+		State->RestoreFromSnapshot(StateSnapshot.bIsActive, StateSnapshot.TimeInState, StateSnapshot.FixedStepsInState, StateSnapshot.bHasUpdated);
+
+		if (State->IsStateMachine())
+		{
+			if (USMInstance* Reference = ((FSMStateMachine*)State)->GetInstanceReference())
+			{
+				Reference->GetRootStateMachine().RestoreFromSnapshot(StateSnapshot.bIsActive, StateSnapshot.TimeInState, StateSnapshot.FixedStepsInState, StateSnapshot.bHasUpdated);
+			}
+		}
+	}
+
+	for (FSMTransition* Transition : RewindTransitions)
+	{
+		Transition->bCanEnterTransitionFromEvent = false;
+		Transition->bIsEvaluating = false;
+	}
+
+	for (const int32 TransitionIdx : Snapshot.EventTransitions)
+	{
+		RewindTransitions[TransitionIdx]->bCanEnterTransitionFromEvent = true;
+	}
+
+	FixedStepFrame = Snapshot.Frame;
+	FixedStepAccumulator = 0.f;
+
+	ReplicateStates();
+}
+
+void USMInstance::SetUseFixedTimeStep(bool bEnable, float StepSeconds)
+{
+	if (bEnable && !ensureAlwaysMsgf(StepSeconds > 0.f, TEXT("Fixed time step must be greater than 0.")))
+	{
+		return;
+	}
+	
+	bUseFixedTimeStep = bEnable;
+	FixedTimeStep = StepSeconds;
+	FixedStepAccumulator = 0.f;
+
+	// References record time in state using the same step.
+	for (USMInstance* Reference : GetAllReferencedInstances(true))
+	{
+		Reference->bUseFixedTimeStep = bEnable;
+		Reference->FixedTimeStep = StepSeconds;
+	}
+}
+
 void USMInstance::Internal_Update(float DeltaSeconds)
 {
 	// It's okay to do a full update if this wasn't called by Update.
@@ -240,6 +555,37 @@ void USMInstance::Internal_EventCleanup(const FGuid& NodeGuid)
 	}
 }
 
+bool USMInstance::Internal_IsTransitionEventActive(const FGuid& NodeGuid) const
+{
+	if (const FSMNode_Base* Node = GetNodeByGuid(NodeGuid))
+	{
+		return Node->AreTransitionNodesInitialized();
+	}
+
+	return false;
+}
+
+void USMInstance::ExecuteInstanceNodes(bool bInitialize)
+{
+	for (const auto& KeyVal : GuidNodeMap)
+	{
+		FSMNode_Base* Node = KeyVal.Value;
+		if (Node->GetOwningInstance() != this)
+		{
+			continue;
+		}
+
+		if (bInitialize)
+		{
+			Node->ExecuteInstanceInitializedNodes();
+		}
+		else
+		{
+			Node->ExecuteInstanceShutdownNodes();
+		}
+	}
+}
+
 void USMInstance::Stop()
 {
 	if (!CheckIsInitialized())
@@ -283,20 +629,40 @@ void USMInstance::Shutdown()
 	{
 		Stop();
 	}
+
+	ExecuteInstanceNodes(false);
 	
 	for (FSMNode_Base* Node : RootStateMachine.GetAllNodes())
 	{
 		Node->Reset();
 	}
+	DestroyNodeStructInstances();
+
+	SetTickLOD(INDEX_NONE);
+	TimeSinceTickLODUpdate = 0.f;
+
+	RewindBuffer.Empty();
+	RewindStates.Empty();
+	RewindTransitions.Empty();
 
-	StateMachineGuids.Empty();
-	GuidNodeMap.Empty();
-	GuidStateMap.Empty();
-	GuidTransitionMap.Empty();
+	ResetNodeMaps();
 
 	bInitialized = false;
 }
 
+#if WITH_EDITORONLY_DATA
+bool USMInstance::StartRecordingDebugEvents(const void* Consumer)
+{
+	DebugEvents.AddConsumer(Consumer);
+	return DebugEvents.HasConsumer(Consumer);
+}
+
+void USMInstance::StopRecordingDebugEvents(const void* Consumer)
+{
+	DebugEvents.RemoveConsumer(Consumer);
+}
+#endif
+
 void USMInstance::StartWithNewContext(UObject* Context)
 {
 	SetContext(Context);
@@ -693,6 +1059,13 @@ void USMInstance::SetCanTickWhenPaused(bool Value)
 
 void USMInstance::SetTickInterval(float Value)
 {
+	if (CurrentTickLOD != INDEX_NONE)
+	{
+		// Applied once the LOD is cleared.
+		TickIntervalBeforeLOD = Value;
+		return;
+	}
+	
 	TickInterval = Value;
 }
 
@@ -706,6 +1079,64 @@ void USMInstance::SetStopOnEndState(bool Value)
 	bStopOnEndState = Value;
 }
 
+void USMInstance::SetMaxTransitionsPerUpdate(int32 Value)
+{
+	MaxTransitionsPerUpdate = FMath::Max(Value, 0);
+}
+
+void USMInstance::SetTickLOD(int32 NewLOD)
+{
+	if (!TickLODTiers.IsValidIndex(NewLOD))
+	{
+		NewLOD = INDEX_NONE;
+	}
+
+	if (NewLOD == CurrentTickLOD)
+	{
+		return;
+	}
+
+	if (CurrentTickLOD == INDEX_NONE)
+	{
+		TickIntervalBeforeLOD = TickInterval;
+	}
+
+	CurrentTickLOD = NewLOD;
+
+	if (CurrentTickLOD == INDEX_NONE)
+	{
+		TickInterval = TickIntervalBeforeLOD;
+		SetLODLogicAllowed(true, true);
+	}
+	else
+	{
+		const FSMTickLODTier& Tier = TickLODTiers[CurrentTickLOD];
+		TickInterval = Tier.TickInterval;
+		SetLODLogicAllowed(Tier.bRunStateUpdateLogic, Tier.bEvaluateTransitionsOnTick);
+	}
+}
+
+void USMInstance::SetTickLODTiers(const TArray<FSMTickLODTier>& NewTiers)
+{
+	SetTickLOD(INDEX_NONE);
+	TickLODTiers = NewTiers;
+	SortTickLODTiers();
+}
+
+void USMInstance::SetTickLODEnabled(bool Value)
+{
+	bEnableTickLOD = Value;
+
+	if (!bEnableTickLOD)
+	{
+		SetTickLOD(INDEX_NONE);
+	}
+	else if (!TickLODProvider)
+	{
+		TickLODProvider = NewObject<USMTickLODProvider_ViewDistance>(this);
+	}
+}
+
 bool USMInstance::IsInEndState() const
 {
 	return RootStateMachine.IsInEndState();
@@ -761,10 +1192,35 @@ bool USMInstance::IsReferenceTemplate() const
 void USMInstance::SetReferenceOwner(USMInstance* Owner)
 {
 	ReferenceOwner = Owner;
+	RefreshMasterReferenceOwner();
+}
+
+void USMInstance::RefreshMasterReferenceOwner()
+{
+	MasterReferenceOwner = ReferenceOwner ? ReferenceOwner->GetMasterReferenceOwner() : nullptr;
+
+	// References this instance created already have their owner but their master changed.
+	for (USMInstance* Reference : GetAllReferencedInstances(false))
+	{
+		if (Reference->GetReferenceOwner() == this)
+		{
+			Reference->RefreshMasterReferenceOwner();
+		}
+	}
 }
 
 const USMInstance* USMInstance::GetMasterReferenceOwnerConst() const
 {
+	if (!ReferenceOwner)
+	{
+		return this;
+	}
+
+	if (MasterReferenceOwner)
+	{
+		return MasterReferenceOwner;
+	}
+	
 	const USMInstance* Parent = ReferenceOwner;
 	while(Parent)
 	{
@@ -781,26 +1237,34 @@ const USMInstance* USMInstance::GetMasterReferenceOwnerConst() const
 
 USMInstance* USMInstance::GetMasterReferenceOwner()
 {
-	USMInstance* Parent = ReferenceOwner;
-	while (Parent)
-	{
-		USMInstance* Next = Parent->GetReferenceOwner();
-		if (!Next)
-		{
-			return Parent;
-		}
-		Parent = Next;
-	}
-
-	return this;
+	return const_cast<USMInstance*>(GetMasterReferenceOwnerConst());
 }
 
 void USMInstance::NotifyTransitionTaken(const FSMTransition& Transition)
 {
+	// References notify their owner as well, only record for the instance owning the node.
+	if (FSMTraceRecorder::IsRecording() && Transition.GetOwningInstance() == this)
+	{
+		FSMTraceRecorder::Get().RecordEvent(Transition, ESMTraceEventType::TransitionTaken);
+	}
+
+	OnStateMachineTransitionTakenNative.Broadcast(this, Transition);
+
+	// Only build the info struct when something can receive it.
+	bool bNeedsTransitionInfo = bTransitionTakenEventOverridden || OnStateMachineTransitionTakenEvent.IsBound();
+#if WITH_EDITORONLY_DATA
+	const bool bLogTransition = IsLoggingEnabled() && bLogTransitionTaken;
+	bNeedsTransitionInfo |= bLogTransition;
+#endif
+	if (!bNeedsTransitionInfo)
+	{
+		return;
+	}
+	
 	const FSMTransitionInfo TransitionInfo(Transition);
 
 #if WITH_EDITORONLY_DATA
-	if (IsLoggingEnabled() && bLogTransitionTaken)
+	if (bLogTransition)
 	{
 		LD_LOG_INFO(TEXT("[%s] Transition taken: %s"), *GetName(), *TransitionInfo.ToString());
 	}
@@ -812,11 +1276,36 @@ void USMInstance::NotifyTransitionTaken(const FSMTransition& Transition)
 
 void USMInstance::NotifyStateChange(FSMState_Base* ToState, FSMState_Base* FromState)
 {
+	if (FSMTraceRecorder::IsRecording())
+	{
+		if (FromState && FromState->GetOwningInstance() == this)
+		{
+			FSMTraceRecorder::Get().RecordEvent(*FromState, ESMTraceEventType::StateExited, FromState->GetActiveTime());
+		}
+		if (ToState && ToState->GetOwningInstance() == this)
+		{
+			FSMTraceRecorder::Get().RecordEvent(*ToState, ESMTraceEventType::StateEntered);
+		}
+	}
+
+	OnStateMachineStateChangedNative.Broadcast(this, ToState, FromState);
+
+	// Only build the info structs when something can receive them.
+	bool bNeedsStateInfo = bStateChangedEventOverridden || OnStateMachineStateChangedEvent.IsBound();
+#if WITH_EDITORONLY_DATA
+	const bool bLogState = IsLoggingEnabled() && bLogStateChange;
+	bNeedsStateInfo |= bLogState;
+#endif
+	if (!bNeedsStateInfo)
+	{
+		return;
+	}
+	
 	const FSMStateInfo ToStateInfo(ToState ? *ToState : FSMState_Base());
 	const FSMStateInfo FromStateInfo(FromState ? *FromState : FSMState_Base());
 
 #if WITH_EDITORONLY_DATA
-	if (IsLoggingEnabled() && bLogStateChange)
+	if (bLogState)
 	{
 		LD_LOG_INFO(TEXT("[%s] State change: from %s to %s"), *GetName(), *FromStateInfo.ToString(), *ToStateInfo.ToString());
 	}
@@ -840,6 +1329,10 @@ void USMInstance::UpdateNetworkConditions()
 		else
 		{
 			Node->SetNetworkedConditions(ActiveTransactions, bCanEvaluateTransitionsLocally, bCanTakeTransitionsLocally, MaxTimeToWaitForUpdate, bCanExecuteStateLogic);
+			if (PreviousTransactionCapacity > 0)
+			{
+				Node->SetPreviousTransactionCapacity(PreviousTransactionCapacity);
+			}
 		}
 	}
 }
@@ -849,6 +1342,7 @@ void USMInstance::CopyNetworkConditionsFrom(USMInstance* OtherInstance, bool bUp
 	SetServerInstance(OtherInstance->ServerStateMachine);
 	SetAllowTransitionsLocally(OtherInstance->bCanEvaluateTransitionsLocally, OtherInstance->bCanTakeTransitionsLocally, OtherInstance->MaxTimeToWaitForUpdate);
 	SetAllowStateLogic(OtherInstance->bCanExecuteStateLogic);
+	SetPreviousTransactionCapacity(OtherInstance->PreviousTransactionCapacity);
 
 	if (bUpdateNodes)
 	{
@@ -897,6 +1391,11 @@ void USMInstance::SetAllowStateLogic(bool bAllow)
 	bCanExecuteStateLogic = bAllow;
 }
 
+void USMInstance::SetPreviousTransactionCapacity(int32 Capacity)
+{
+	PreviousTransactionCapacity = Capacity;
+}
+
 void USMInstance::Tick_Implementation(float DeltaTime)
 {
 	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("SMInstance::TotalTick"), STAT_SMInstance_TotalTick, STATGROUP_LogicDriver);
@@ -906,6 +1405,8 @@ void USMInstance::Tick_Implementation(float DeltaTime)
 		return;
 	}
 
+	UpdateTickLOD(DeltaTime);
+
 	// Check if we are allowed to tick depending on the interval.
 	TimeSinceAllowedTick += DeltaTime;
 	if (TimeSinceAllowedTick < TickInterval)
@@ -953,6 +1454,124 @@ void USMInstance::OnStateMachineStateChanged_Implementation(const FSMStateInfo&
 {
 }
 
+/** Add the struct memory used by the nodes of a state machine and its nested state machines. References allocate their own. */
+static void AddNodeStructMemorySize(const FSMStateMachine& StateMachine, int32& NumBytes, int32& Alignment)
+{
+	FSMNodeStructRegistry::FEntry Entry;
+	for (const FSMNode_Base* Node : StateMachine.GetAllNodes())
+	{
+		if (FSMNodeStructRegistry::Find(Node->GetNodeInstanceClass(), Entry))
+		{
+			NumBytes = Align(NumBytes, Entry.Alignment) + Entry.Size;
+			Alignment = FMath::Max(Alignment, Entry.Alignment);
+		}
+	}
+
+	for (const FSMState_Base* State : StateMachine.GetStates())
+	{
+		if (State->IsStateMachine() && !((const FSMStateMachine*)State)->GetInstanceReference())
+		{
+			AddNodeStructMemorySize(*(const FSMStateMachine*)State, NumBytes, Alignment);
+		}
+	}
+}
+
+void USMInstance::AllocateNodeStructMemory()
+{
+	// A failed initialization doesn't shut down and may have left structs behind.
+	DestroyNodeStructInstances();
+
+	if (!FSMNodeStructRegistry::HasRegistrations())
+	{
+		return;
+	}
+
+	int32 NumBytes = 0;
+	int32 Alignment = 1;
+
+	FSMNodeStructRegistry::FEntry RootEntry;
+	if (FSMNodeStructRegistry::Find(RootStateMachine.GetNodeInstanceClass(), RootEntry))
+	{
+		NumBytes = RootEntry.Size;
+		Alignment = RootEntry.Alignment;
+	}
+	AddNodeStructMemorySize(RootStateMachine, NumBytes, Alignment);
+
+	if (NumBytes > 0)
+	{
+		NodeStructMemory = (uint8*)FMemory::Malloc(NumBytes, Alignment);
+		NodeStructMemorySize = NumBytes;
+	}
+}
+
+FSMNodeStructInstance* USMInstance::CreateNodeStructInstance(FSMNode_Base& Node, const FSMNodeStructRegistry::FEntry& Entry)
+{
+	const int32 Offset = Align(NodeStructMemoryUsed, Entry.Alignment);
+	if (!ensureMsgf(NodeStructMemory && Offset + Entry.Size <= NodeStructMemorySize,
+		TEXT("Struct memory of %s wasn't sized for node %s. Creating a node instance instead."), *GetName(), *Node.GetNodeName()))
+	{
+		return nullptr;
+	}
+	
+	NodeStructMemoryUsed = Offset + Entry.Size;
+	
+	FSMNodeStructInstance* StructInstance = Entry.Construct(NodeStructMemory + Offset);
+	NodeStructInstances.Add({ &Node, StructInstance });
+	return StructInstance;
+}
+
+void USMInstance::DestroyNodeStructInstances()
+{
+	for (int32 Idx = NodeStructInstances.Num() - 1; Idx >= 0; --Idx)
+	{
+		NodeStructInstances[Idx].Value->~FSMNodeStructInstance();
+
+		// Nested nodes aren't reset on shutdown.
+		NodeStructInstances[Idx].Key->ReleaseNodeStructInstance();
+	}
+	NodeStructInstances.Reset();
+
+	if (NodeStructMemory)
+	{
+		FMemory::Free(NodeStructMemory);
+		NodeStructMemory = nullptr;
+	}
+	NodeStructMemorySize = 0;
+	NodeStructMemoryUsed = 0;
+}
+
+void USMInstance::ReserveNodeMaps(const TSet<FStructProperty*>& Properties)
+{
+	// The root isn't a property. Referenced instances add their own nodes on top of this.
+	int32 NumStates = 1;
+	int32 NumStateMachines = 1;
+	for (const FStructProperty* Property : Properties)
+	{
+		if (Property->Struct->IsChildOf(FSMStateMachine::StaticStruct()))
+		{
+			NumStateMachines++;
+		}
+		if (Property->Struct->IsChildOf(FSMState_Base::StaticStruct()))
+		{
+			NumStates++;
+		}
+	}
+
+	StateMachineGuids.Reserve(NumStateMachines);
+	GuidNodeMap.Reserve(Properties.Num() + 1);
+	GuidStateMap.Reserve(NumStates);
+	GuidTransitionMap.Reserve(Properties.Num() + 1 - NumStates);
+}
+
+void USMInstance::ResetNodeMaps()
+{
+	// Keep the allocations so initializing again doesn't reallocate them.
+	StateMachineGuids.Reset();
+	GuidNodeMap.Reset();
+	GuidStateMap.Reset();
+	GuidTransitionMap.Reset();
+}
+
 void USMInstance::BuildStateMachineMap(FSMStateMachine* StateMachine, TSet<USMInstance*>& InstancesMapped)
 {
 	InstancesMapped.Add(this);
@@ -1059,9 +1678,84 @@ void USMInstance::ReplicateStates()
 	}
 }
 
+void USMInstance::UpdateTickLOD(float DeltaTime)
+{
+	if (!bEnableTickLOD || !TickLODProvider || TickLODTiers.Num() == 0 || !IsInitialized())
+	{
+		return;
+	}
+
+	TimeSinceTickLODUpdate += DeltaTime;
+	if (CurrentTickLOD != INDEX_NONE && TimeSinceTickLODUpdate < TickLODUpdateInterval)
+	{
+		return;
+	}
+
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("SMInstance::UpdateTickLOD"), STAT_SMInstance_UpdateTickLOD, STATGROUP_LogicDriver);
+	
+	TimeSinceTickLODUpdate = 0.f;
+
+	const float Distance = TickLODProvider->CalculateLODDistance(this);
+	SetTickLOD(CalculateTickLOD(Distance));
+}
+
+int32 USMInstance::CalculateTickLOD(float Distance) const
+{
+	auto FindTier = [&](float ForDistance)
+	{
+		// Tiers are sorted by distance, the first tier is used for anything closer than its MinDistance.
+		for (int32 Idx = TickLODTiers.Num() - 1; Idx > 0; --Idx)
+		{
+			if (ForDistance >= TickLODTiers[Idx].MinDistance)
+			{
+				return Idx;
+			}
+		}
+
+		return 0;
+	};
+
+	const int32 NewLOD = FindTier(Distance);
+	if (CurrentTickLOD == INDEX_NONE || NewLOD == CurrentTickLOD)
+	{
+		return NewLOD;
+	}
+
+	// Only switch once the distance is past the boundary by the hysteresis amount.
+	if (NewLOD > CurrentTickLOD)
+	{
+		return FMath::Max(FindTier(Distance - TickLODHysteresis), CurrentTickLOD);
+	}
+
+	return FMath::Min(FindTier(Distance + TickLODHysteresis), CurrentTickLOD);
+}
+
+void USMInstance::SortTickLODTiers()
+{
+	TickLODTiers.Sort([](const FSMTickLODTier& lhs, const FSMTickLODTier& rhs)
+	{
+		return lhs.MinDistance < rhs.MinDistance;
+	});
+}
+
+void USMInstance::SetLODLogicAllowed(bool bAllowStateUpdateLogic, bool bAllowTickTransitionEvaluation)
+{
+	bLODAllowsStateUpdateLogic = bAllowStateUpdateLogic;
+	bLODAllowsTickTransitionEvaluation = bAllowTickTransitionEvaluation;
+
+	// References run under the LOD of their owner.
+	for (USMInstance* Reference : GetAllReferencedInstances(true))
+	{
+		Reference->bLODAllowsStateUpdateLogic = bAllowStateUpdateLogic;
+		Reference->bLODAllowsTickTransitionEvaluation = bAllowTickTransitionEvaluation;
+	}
+}
+
 void USMInstance::DoStart()
 {
 	TimeSinceAllowedTick = 0.f;
+	FixedStepAccumulator = 0.f;
+	FixedStepFrame = 0;
 	OnStateMachineStart();
 	OnStateMachineStartedEvent.Broadcast(this);
 
@@ -1074,6 +1768,15 @@ void USMInstance::DoStart()
 	RootStateMachine.StartState();
 	UpdateTime();
 
+	if (RewindBuffer.Num() > 0)
+	{
+		for (FSMInstanceSnapshot& Snapshot : RewindBuffer)
+		{
+			Snapshot.Reset();
+		}
+		RecordSnapshot();
+	}
+
 	ReplicateStates();
 }
 
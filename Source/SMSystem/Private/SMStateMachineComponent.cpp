@@ -4,11 +4,32 @@
 #include "UObject/PropertyPortFlags.h"
 #include "UObject/UObjectHash.h"
 #include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
 #include "SMUtils.h"
 #include "SMLogging.h"
 
 #define LOCTEXT_NAMESPACE "SMStateMachineComponent"
 
+namespace SMTransactionBatching
+{
+	/** Components with client transactions waiting for the next batch. Kept per world so PIE clients never share a batch. */
+	static TMap<const UWorld*, TArray<TWeakObjectPtr<USMStateMachineComponent>>> ComponentsPendingBatch;
+
+	/** World time each actor last sent a batch, used to send at most once per net update of the actor. */
+	static TMap<const UWorld*, TMap<TWeakObjectPtr<AActor>, float>> LastActorFlushTimes;
+
+	static FDelegateHandle PostActorTickHandle;
+	static FDelegateHandle WorldCleanupHandle;
+
+	static void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+	{
+		ComponentsPendingBatch.Remove(World);
+		LastActorFlushTimes.Remove(World);
+	}
+}
+
 USMStateMachineComponent::USMStateMachineComponent(class FObjectInitializer const & ObjectInitializer)
 {
 	R_Instance = nullptr;
@@ -21,11 +42,17 @@ USMStateMachineComponent::USMStateMachineComponent(class FObjectInitializer cons
 	NetworkTransitionConfig = SM_Client;
 	NetworkStateConfig = SM_ClientAndServer;
 	TransitionResetTimeSeconds = 2.f;
+	PreviousTransactionCapacity = FSMNetworkedTransactionHistory::DefaultCapacity;
 	bReplicateStatesOnLoad = true;
 	bTakeTransitionsFromServerOnly = false;
 	bDiscardTransitionsBeforeInitialize = false;
 	bIncludeSimulatedProxies = false;
 	MaxTimeToWaitForTransitionUpdate = 2.f;
+	bPredictTransitions = false;
+	LastPredictionKey = 0;
+	bBatchClientTransactions = false;
+	bSendBatchedTransactionsUnreliable = false;
+	UnreliableRedundantSends = 2;
 	
 	PrimaryComponentTick.bCanEverTick = true;
 	bCanInstanceNetworkTick = true;
@@ -64,6 +91,9 @@ void USMStateMachineComponent::BeginPlay()
 		}
 	}
 
+	// Clients enable the tick once the instance has replicated and started.
+	RefreshComponentTickEnabled(R_Instance && R_Instance->IsActive());
+
 	// Blueprint BeginPlay is called here.
 	Super::BeginPlay();
 }
@@ -313,6 +343,9 @@ bool USMStateMachineComponent::CanTickForEnvironment() const
 
 void USMStateMachineComponent::Internal_OnStateMachineStarted(USMInstance* Instance)
 {
+	// Called before the root state machine is active.
+	RefreshComponentTickEnabled(true);
+	
 	OnStateMachineStartedEvent.Broadcast(Instance);
 }
 
@@ -323,18 +356,25 @@ void USMStateMachineComponent::Internal_OnStateMachineUpdated(USMInstance* Insta
 
 void USMStateMachineComponent::Internal_OnStateMachineStopped(USMInstance* Instance)
 {
+	RefreshComponentTickEnabled(false);
+	
 	OnStateMachineStoppedEvent.Broadcast(Instance);
 }
 
-void USMStateMachineComponent::Internal_OnStateMachineTransitionTaken(USMInstance* Instance, FSMTransitionInfo Transition)
+void USMStateMachineComponent::Internal_OnStateMachineTransitionTaken(USMInstance* Instance, const FSMTransition& Transition)
 {
-	OnStateMachineTransitionTakenEvent.Broadcast(Instance, Transition);
+	if (OnStateMachineTransitionTakenEvent.IsBound())
+	{
+		OnStateMachineTransitionTakenEvent.Broadcast(Instance, FSMTransitionInfo(Transition));
+	}
 }
 
-void USMStateMachineComponent::Internal_OnStateMachineStateChanged(USMInstance* Instance, FSMStateInfo ToState,
-	FSMStateInfo FromState)
+void USMStateMachineComponent::Internal_OnStateMachineStateChanged(USMInstance* Instance, FSMState_Base* ToState, FSMState_Base* FromState)
 {
-	OnStateMachineStateChangedEvent.Broadcast(Instance, ToState, FromState);
+	if (OnStateMachineStateChangedEvent.IsBound())
+	{
+		OnStateMachineStateChangedEvent.Broadcast(Instance, FSMStateInfo(ToState ? *ToState : FSMState_Base()), FSMStateInfo(FromState ? *FromState : FSMState_Base()));
+	}
 }
 
 void USMStateMachineComponent::PostInitialize()
@@ -347,11 +387,16 @@ void USMStateMachineComponent::PostInitialize()
 	R_Instance->OnStateMachineStartedEvent.AddUniqueDynamic(this, &USMStateMachineComponent::Internal_OnStateMachineStarted);
 	R_Instance->OnStateMachineUpdatedEvent.AddUniqueDynamic(this, &USMStateMachineComponent::Internal_OnStateMachineUpdated);
 	R_Instance->OnStateMachineStoppedEvent.AddUniqueDynamic(this, &USMStateMachineComponent::Internal_OnStateMachineStopped);
-	R_Instance->OnStateMachineTransitionTakenEvent.AddUniqueDynamic(this, &USMStateMachineComponent::Internal_OnStateMachineTransitionTaken);
-	R_Instance->OnStateMachineStateChangedEvent.AddUniqueDynamic(this, &USMStateMachineComponent::Internal_OnStateMachineStateChanged);
+
+	// Native bindings so the instance doesn't build info structs for the component unless the component's events are bound.
+	R_Instance->OnStateMachineTransitionTakenNative.RemoveAll(this);
+	R_Instance->OnStateMachineTransitionTakenNative.AddUObject(this, &USMStateMachineComponent::Internal_OnStateMachineTransitionTaken);
+	R_Instance->OnStateMachineStateChangedNative.RemoveAll(this);
+	R_Instance->OnStateMachineStateChangedNative.AddUObject(this, &USMStateMachineComponent::Internal_OnStateMachineStateChanged);
 	
 	// Configure network settings after initialization.
 	ConfigureInstanceNetworkSettings();
+	RefreshComponentTickEnabled(R_Instance->IsActive());
 
 	// Allow child blueprint components to run specific initalize logic.
 	OnPostInitialize();
@@ -359,6 +404,26 @@ void USMStateMachineComponent::PostInitialize()
 	OnStateMachineInitializedEvent.Broadcast(R_Instance);
 }
 
+void USMStateMachineComponent::RefreshComponentTickEnabled(bool bInstanceRunning)
+{
+	if (!PrimaryComponentTick.bCanEverTick || IsTemplate())
+	{
+		return;
+	}
+
+	bool bShouldTick = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(USMStateMachineComponent, ReceiveTick));
+	if (!bShouldTick && R_Instance)
+	{
+		const bool bCanTickInstance = IsConfiguredForNetworking() ? bCanInstanceNetworkTick : !bLetInstanceManageTick && R_Instance->CanEverTick();
+
+		// A stopped instance only updates when running, unless Tick may have been overridden.
+		bShouldTick = bCanTickInstance && (bInstanceRunning ||
+			USMUtils::IsFunctionOverridden(R_Instance->GetClass(), USMInstance::StaticClass(), GET_FUNCTION_NAME_CHECKED(USMInstance, Tick)));
+	}
+
+	SetComponentTickEnabled(bShouldTick);
+}
+
 void USMStateMachineComponent::ConfigureInstanceNetworkSettings()
 {
 	if (!IsConfiguredForNetworking())
@@ -421,7 +486,10 @@ void USMStateMachineComponent::ConfigureInstanceNetworkSettings()
 			}
 		}
 
-		if (bLimitedTransitionAccess)
+		// Predicting clients always evaluate and take transitions, the server will correct them if necessary.
+		const bool bPredictLocally = bPredictTransitions && !bHasAuth && !bIsProxy;
+		
+		if (bLimitedTransitionAccess && !bPredictLocally)
 		{
 			R_Instance->SetAllowTransitionsLocally(false, (!bTakeTransitionsFromServerOnly && !bIsProxy) || bHasAuth, MaxTimeToWaitForTransitionUpdate);
 		}
@@ -454,6 +522,8 @@ void USMStateMachineComponent::ConfigureInstanceNetworkSettings()
 	// Notify the instance that there is a server instance.
 	R_Instance->SetServerInstance(this);
 
+	R_Instance->SetPreviousTransactionCapacity(PreviousTransactionCapacity);
+	
 	// Refresh instance settings.
 	R_Instance->UpdateNetworkConditions();
 }
@@ -535,6 +605,36 @@ void USMStateMachineComponent::ProcessTransaction(const TArray<FSMNetworkedTrans
 		return;
 	}
 
+	if (bPredictTransitions)
+	{
+		// Transitions have already been taken locally. Tag them so the server can confirm or reject them.
+		TArray<FSMNetworkedTransaction> PredictedTransactions = Transactions;
+		for (FSMNetworkedTransaction& Transaction : PredictedTransactions)
+		{
+			if (Transaction.IsTransition())
+			{
+				Transaction.PredictionKey = ++LastPredictionKey;
+				PendingPredictions.Add(Transaction);
+			}
+		}
+
+		if (bBatchClientTransactions)
+		{
+			QueueTransactionsForBatch(PredictedTransactions);
+		}
+		else
+		{
+			SERVER_ProcessTransaction(PredictedTransactions);
+		}
+		return;
+	}
+
+	if (bBatchClientTransactions)
+	{
+		QueueTransactionsForBatch(Transactions);
+		return;
+	}
+	
 	SERVER_ProcessTransaction(Transactions);
 }
 
@@ -683,6 +783,8 @@ void USMStateMachineComponent::DoStop()
 void USMStateMachineComponent::DoShutdown()
 {
 	PendingTransactions.Empty();
+	PendingPredictions.Empty();
+	QueuedBatchTransactions.Empty();
 	
 	if (!R_Instance)
 	{
@@ -690,6 +792,7 @@ void USMStateMachineComponent::DoShutdown()
 	}
 
 	R_Instance->Shutdown();
+	RefreshComponentTickEnabled(false);
 }
 
 void USMStateMachineComponent::DoProcessTransactions(const TArray<FSMNetworkedTransaction>& Transactions)
@@ -707,7 +810,7 @@ void USMStateMachineComponent::DoProcessTransactions(const TArray<FSMNetworkedTr
 	const TMap<FGuid, FSMTransition*>& TransitionMap = R_Instance->GetTransitionMap();
 	const TMap<FGuid, FSMState_Base*>& StateMap = R_Instance->GetStateMap();
 	
-	FDateTime CurrentTime = FDateTime::UtcNow();
+	const double CurrentTime = FPlatformTime::Seconds();
 	for (const FSMNetworkedTransaction& NetworkedTransaction : Transactions)
 	{
 		if (FSMStateMachine* OwningStateMachine = (FSMStateMachine*)StateMap.FindRef(NetworkedTransaction.StateMachineGuid))
@@ -718,6 +821,18 @@ void USMStateMachineComponent::DoProcessTransactions(const TArray<FSMNetworkedTr
 				// TODO: See about refactoring out previous transaction checks from the FSM to the component, similar to state transactions.
 				if (FSMTransition* Transition = (FSMTransition*)TransitionMap.FindRef(NetworkedTransaction.BaseGuid))
 				{
+					if (NetworkedTransaction.IsPredicted() && PendingPredictions.Num() > 0)
+					{
+						// Our own prediction coming back from the server. It was already taken locally.
+						ConfirmPredictedTransactions(NetworkedTransaction.PredictionKey);
+					}
+					else if (bPredictTransitions && !HasAuthority() && !Transition->GetFromState()->IsActive() && Transition->GetToState()->IsActive())
+					{
+						// A predicted transition already reached the same result.
+						OwningStateMachine->GetPreviousTransactions().Add(NetworkedTransaction.TransactionGuid, CurrentTime);
+						continue;
+					}
+					
 					if (OwningStateMachine->ProcessTransition(Transition, &NetworkedTransaction, 0.f, &CurrentTime))
 					{
 						OwningStateMachine->ProcessStates(0.f);
@@ -727,7 +842,7 @@ void USMStateMachineComponent::DoProcessTransactions(const TArray<FSMNetworkedTr
 			else if (NetworkedTransaction.IsState())
 			{
 				// State networked transactions just switch it from active to not active.
-				TMap<FGuid, FSMNetworkedTransaction>& PreviousTransactions = OwningStateMachine->GetPreviousTransactions();
+				FSMNetworkedTransactionHistory& PreviousTransactions = OwningStateMachine->GetPreviousTransactions();
 				if (!PreviousTransactions.Contains(NetworkedTransaction.TransactionGuid))
 				{
 					if (FSMState_Base* State = (FSMState_Base*)StateMap.FindRef(NetworkedTransaction.BaseGuid))
@@ -741,7 +856,7 @@ void USMStateMachineComponent::DoProcessTransactions(const TArray<FSMNetworkedTr
 							OwningStateMachine->RemoveActiveState(State);
 						}
 
-						PreviousTransactions.Add(NetworkedTransaction.TransactionGuid, NetworkedTransaction);
+						PreviousTransactions.Add(NetworkedTransaction.TransactionGuid, CurrentTime);
 					}
 				}
 			}
@@ -751,6 +866,298 @@ void USMStateMachineComponent::DoProcessTransactions(const TArray<FSMNetworkedTr
 	}
 }
 
+bool USMStateMachineComponent::ShouldSendTransactionsUnreliable() const
+{
+	// Predictions are rejected in order and can't tolerate lost transactions.
+	return bSendBatchedTransactionsUnreliable && !bPredictTransitions;
+}
+
+void USMStateMachineComponent::QueueTransactionsForBatch(const TArray<FSMNetworkedTransaction>& Transactions)
+{
+	const int32 NumSends = ShouldSendTransactionsUnreliable() ? 1 + FMath::Max(UnreliableRedundantSends, 0) : 1;
+	for (const FSMNetworkedTransaction& Transaction : Transactions)
+	{
+		QueuedBatchTransactions.Add({ Transaction, NumSends });
+	}
+
+	if (const UWorld* World = GetWorld())
+	{
+		SMTransactionBatching::ComponentsPendingBatch.FindOrAdd(World).AddUnique(this);
+	}
+}
+
+void USMStateMachineComponent::RegisterTransactionBatching()
+{
+	using namespace SMTransactionBatching;
+
+	if (!PostActorTickHandle.IsValid())
+	{
+		PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddStatic(&USMStateMachineComponent::FlushTransactionBatches);
+		WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddStatic(&SMTransactionBatching::OnWorldCleanup);
+	}
+}
+
+void USMStateMachineComponent::UnregisterTransactionBatching()
+{
+	using namespace SMTransactionBatching;
+
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+	PostActorTickHandle.Reset();
+	WorldCleanupHandle.Reset();
+	ComponentsPendingBatch.Empty();
+	LastActorFlushTimes.Empty();
+}
+
+int32 USMStateMachineComponent::GetNumComponentsPendingBatch(const UWorld* World)
+{
+	const TArray<TWeakObjectPtr<USMStateMachineComponent>>* Components = SMTransactionBatching::ComponentsPendingBatch.Find(World);
+	return Components ? Components->Num() : 0;
+}
+
+void USMStateMachineComponent::FlushTransactionBatches(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	TArray<TWeakObjectPtr<USMStateMachineComponent>>* PendingComponents = SMTransactionBatching::ComponentsPendingBatch.Find(World);
+	if (!PendingComponents || PendingComponents->Num() == 0)
+	{
+		return;
+	}
+
+	// Transactions are only ever queued on clients. Without a server connection there is nobody to send them to.
+	const UNetDriver* NetDriver = World->GetNetDriver();
+	UNetConnection* ServerConnection = NetDriver ? NetDriver->ServerConnection : nullptr;
+	if (!ServerConnection)
+	{
+		for (const TWeakObjectPtr<USMStateMachineComponent>& WeakComponent : *PendingComponents)
+		{
+			if (USMStateMachineComponent* Component = WeakComponent.Get())
+			{
+				Component->QueuedBatchTransactions.Reset();
+			}
+		}
+
+		PendingComponents->Reset();
+		SMTransactionBatching::LastActorFlushTimes.Remove(World);
+		return;
+	}
+
+	// Keep growing the batches while the connection is saturated.
+	if (!ServerConnection->IsNetReady(false))
+	{
+		return;
+	}
+
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("SMStateMachineComponent::FlushTransactionBatches"), STAT_SMStateMachineComponent_FlushTransactionBatches, STATGROUP_LogicDriver);
+
+	struct FActorBatch
+	{
+		/** The first component of the actor, used to send the RPC. */
+		USMStateMachineComponent* Sender = nullptr;
+		TArray<FSMComponentTransactionBatch> Batches;
+	};
+
+	TMap<AActor*, FActorBatch> ReliableBatches;
+	TMap<AActor*, FActorBatch> UnreliableBatches;
+	TArray<TWeakObjectPtr<USMStateMachineComponent>> StillPending;
+
+	TMap<TWeakObjectPtr<AActor>, float>& LastFlushTimes = SMTransactionBatching::LastActorFlushTimes.FindOrAdd(World);
+	const float CurrentTime = World->GetTimeSeconds();
+
+	for (const TWeakObjectPtr<USMStateMachineComponent>& WeakComponent : *PendingComponents)
+	{
+		USMStateMachineComponent* Component = WeakComponent.Get();
+		if (!Component || Component->QueuedBatchTransactions.Num() == 0)
+		{
+			continue;
+		}
+
+		AActor* Owner = Component->GetOwner();
+		if (!Owner)
+		{
+			Component->QueuedBatchTransactions.Reset();
+			continue;
+		}
+
+		// Send at most once per net update of the owner. Components of an actor share its flush time so they stay in one batch.
+		if (!ReliableBatches.Contains(Owner) && !UnreliableBatches.Contains(Owner))
+		{
+			const float* LastFlushTime = LastFlushTimes.Find(Owner);
+			const float NetUpdateInterval = Owner->NetUpdateFrequency > 0.f ? 1.f / Owner->NetUpdateFrequency : 0.f;
+			if (LastFlushTime && CurrentTime - *LastFlushTime < NetUpdateInterval)
+			{
+				StillPending.Add(WeakComponent);
+				continue;
+			}
+
+			LastFlushTimes.Add(Owner, CurrentTime);
+		}
+
+		FActorBatch& ActorBatch = (Component->ShouldSendTransactionsUnreliable() ? UnreliableBatches : ReliableBatches).FindOrAdd(Owner);
+		if (!ActorBatch.Sender)
+		{
+			ActorBatch.Sender = Component;
+		}
+
+		FSMComponentTransactionBatch& Batch = ActorBatch.Batches.AddDefaulted_GetRef();
+		Batch.Component = Component;
+		Batch.Transactions.Reserve(Component->QueuedBatchTransactions.Num());
+		
+		for (FQueuedTransaction& QueuedTransaction : Component->QueuedBatchTransactions)
+		{
+			Batch.Transactions.Add(QueuedTransaction.Transaction);
+			QueuedTransaction.SendsRemaining--;
+		}
+
+		Component->QueuedBatchTransactions.RemoveAll([](const FQueuedTransaction& QueuedTransaction)
+		{
+			return QueuedTransaction.SendsRemaining <= 0;
+		});
+
+		// Redundant copies go out with the next batches.
+		if (Component->QueuedBatchTransactions.Num() > 0)
+		{
+			StillPending.Add(WeakComponent);
+		}
+	}
+
+	*PendingComponents = MoveTemp(StillPending);
+
+	for (auto It = LastFlushTimes.CreateIterator(); It; ++It)
+	{
+		if (!It->Key.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (const TPair<AActor*, FActorBatch>& ActorBatch : ReliableBatches)
+	{
+		ActorBatch.Value.Sender->SERVER_ProcessTransactionBatch(ActorBatch.Value.Batches);
+	}
+
+	for (const TPair<AActor*, FActorBatch>& ActorBatch : UnreliableBatches)
+	{
+		ActorBatch.Value.Sender->SERVER_ProcessTransactionBatchUnreliable(ActorBatch.Value.Batches);
+	}
+}
+
+bool USMStateMachineComponent::HasReceivedTransaction(const FSMNetworkedTransaction& Transaction) const
+{
+	const bool bAlreadyReplicated = R_NetworkedTransactions.ContainsByPredicate([&](const FSMNetworkedTransaction& ReplicatedTransaction)
+	{
+		return ReplicatedTransaction.TransactionGuid == Transaction.TransactionGuid;
+	});
+
+	if (bAlreadyReplicated)
+	{
+		return true;
+	}
+
+	if (R_Instance)
+	{
+		if (FSMStateMachine* OwningStateMachine = (FSMStateMachine*)R_Instance->GetStateByGuid(Transaction.StateMachineGuid))
+		{
+			return OwningStateMachine->GetPreviousTransactions().Contains(Transaction.TransactionGuid);
+		}
+	}
+
+	return false;
+}
+
+bool USMStateMachineComponent::CanAcceptPredictedTransaction(const FSMNetworkedTransaction& Transaction) const
+{
+	if (!R_Instance)
+	{
+		return false;
+	}
+
+	FSMTransition* Transition = R_Instance->GetTransitionByGuid(Transaction.BaseGuid);
+	if (!Transition || !R_Instance->GetStateByGuid(Transaction.StateMachineGuid))
+	{
+		return false;
+	}
+
+	// Conduits in a chain will be in the active list but won't have started.
+	Transition->TrySetGlobalFromActiveState();
+	FSMState_Base* FromState = Transition->GetFromState();
+	const FSMStateMachine* FromOwner = (FSMStateMachine*)FromState->GetOwnerNode();
+	if (!FromState->IsActive() && !(FromOwner && FromOwner->IsStateInActiveList(FromState)))
+	{
+		return false;
+	}
+
+	// Only validate against authoritative state. Running the condition graph here would evaluate it outside of the
+	// server's own update and could trigger its side effects several times per frame.
+	if (Transition->bAlwaysFalse)
+	{
+		return false;
+	}
+
+	return !HasReceivedTransaction(Transaction);
+}
+
+void USMStateMachineComponent::ConfirmPredictedTransactions(int32 PredictionKey)
+{
+	PendingPredictions.RemoveAll([PredictionKey](const FSMNetworkedTransaction& Transaction)
+	{
+		return Transaction.PredictionKey <= PredictionKey;
+	});
+}
+
+void USMStateMachineComponent::ReconcileToStates(const TArray<FGuid>& AuthoritativeStates)
+{
+	if (!R_Instance || !R_Instance->IsActive())
+	{
+		return;
+	}
+
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("SMStateMachineComponent::ReconcileToStates"), STAT_SMStateMachineComponent_ReconcileToStates, STATGROUP_LogicDriver);
+	
+	const TSet<FGuid> TargetStates(AuthoritativeStates);
+
+	// End mispredicted states.
+	for (FSMState_Base* State : R_Instance->GetAllActiveStates())
+	{
+		if (TargetStates.Contains(State->GetGuid()))
+		{
+			continue;
+		}
+
+		FSMStateMachine* Owner = (FSMStateMachine*)State->GetOwnerNode();
+		if (Owner && Owner->IsStateInActiveList(State))
+		{
+			Owner->RemoveActiveState(State);
+		}
+	}
+
+	// Activate the server's states. State machines which aren't active yet will start from them.
+	TArray<FSMStateMachine*> StateMachinesToProcess;
+	for (const FGuid& Guid : AuthoritativeStates)
+	{
+		FSMState_Base* State = R_Instance->GetStateByGuid(Guid);
+		FSMStateMachine* Owner = State ? (FSMStateMachine*)State->GetOwnerNode() : nullptr;
+		if (!Owner || State->IsActive() || Owner->IsStateInActiveList(State))
+		{
+			continue;
+		}
+
+		if (Owner->IsActive())
+		{
+			Owner->AddActiveState(State);
+			StateMachinesToProcess.AddUnique(Owner);
+		}
+		else
+		{
+			Owner->AddTemporaryInitialState(State);
+		}
+	}
+
+	for (FSMStateMachine* StateMachine : StateMachinesToProcess)
+	{
+		StateMachine->ProcessStates(0.f);
+	}
+}
+
 void USMStateMachineComponent::SendTransactionsToClients(const TArray<FSMNetworkedTransaction>& Transactions)
 {
 	const FDateTime CurrentTime = FDateTime::UtcNow();
@@ -846,8 +1253,109 @@ bool USMStateMachineComponent::SERVER_ProcessTransaction_Validate(const TArray<F
 
 void USMStateMachineComponent::SERVER_ProcessTransaction_Implementation(const TArray<FSMNetworkedTransaction>& Transactions)
 {
-	SendTransactionsToClients(Transactions);
-	DoProcessTransactions(Transactions);
+	ServerProcessClientTransactions(Transactions);
+}
+
+bool USMStateMachineComponent::SERVER_ProcessTransactionBatch_Validate(const TArray<FSMComponentTransactionBatch>& Batches)
+{
+	return Batches.Num() > 0;
+}
+
+void USMStateMachineComponent::SERVER_ProcessTransactionBatch_Implementation(const TArray<FSMComponentTransactionBatch>& Batches)
+{
+	for (const FSMComponentTransactionBatch& Batch : Batches)
+	{
+		// Only components of this actor are driven through its connection.
+		if (Batch.Component && Batch.Component->GetOwner() == GetOwner() && Batch.Transactions.Num() > 0)
+		{
+			Batch.Component->ServerProcessClientTransactions(Batch.Transactions);
+		}
+	}
+}
+
+bool USMStateMachineComponent::SERVER_ProcessTransactionBatchUnreliable_Validate(const TArray<FSMComponentTransactionBatch>& Batches)
+{
+	return Batches.Num() > 0;
+}
+
+void USMStateMachineComponent::SERVER_ProcessTransactionBatchUnreliable_Implementation(const TArray<FSMComponentTransactionBatch>& Batches)
+{
+	TArray<FSMNetworkedTransaction> NewTransactions;
+	for (const FSMComponentTransactionBatch& Batch : Batches)
+	{
+		if (!Batch.Component || Batch.Component->GetOwner() != GetOwner())
+		{
+			continue;
+		}
+
+		// Transactions are repeated in later batches, only process the first copy received.
+		NewTransactions.Reset();
+		for (const FSMNetworkedTransaction& Transaction : Batch.Transactions)
+		{
+			if (!Batch.Component->HasReceivedTransaction(Transaction))
+			{
+				NewTransactions.Add(Transaction);
+			}
+		}
+
+		if (NewTransactions.Num() > 0)
+		{
+			Batch.Component->ServerProcessClientTransactions(NewTransactions);
+		}
+	}
+}
+
+void USMStateMachineComponent::ServerProcessClientTransactions(const TArray<FSMNetworkedTransaction>& Transactions)
+{
+	if (!bPredictTransitions)
+	{
+		SendTransactionsToClients(Transactions);
+		DoProcessTransactions(Transactions);
+		return;
+	}
+
+	// Validate each prediction in order against the authoritative state. Once one fails every later prediction depends on it.
+	TArray<FSMNetworkedTransaction> AcceptedTransactions;
+	TArray<FSMNetworkedTransaction> SingleTransaction;
+	int32 RejectedKey = 0;
+	
+	for (const FSMNetworkedTransaction& Transaction : Transactions)
+	{
+		if (Transaction.IsPredicted() && (RejectedKey != 0 || !CanAcceptPredictedTransaction(Transaction)))
+		{
+			if (RejectedKey == 0)
+			{
+				RejectedKey = Transaction.PredictionKey;
+			}
+			continue;
+		}
+
+		SingleTransaction.Reset();
+		SingleTransaction.Add(Transaction);
+		DoProcessTransactions(SingleTransaction);
+		
+		AcceptedTransactions.Add(Transaction);
+	}
+
+	if (AcceptedTransactions.Num() > 0)
+	{
+		SendTransactionsToClients(AcceptedTransactions);
+	}
+
+	if (RejectedKey != 0 && R_Instance)
+	{
+		CLIENT_RejectPredictedTransactions(RejectedKey, R_Instance->GetAllActiveStateGuidsCopy());
+	}
+}
+
+void USMStateMachineComponent::CLIENT_RejectPredictedTransactions_Implementation(int32 PredictionKey, const TArray<FGuid>& AuthoritativeStates)
+{
+	PendingPredictions.RemoveAll([PredictionKey](const FSMNetworkedTransaction& Transaction)
+	{
+		return Transaction.PredictionKey >= PredictionKey;
+	});
+
+	ReconcileToStates(AuthoritativeStates);
 }
 
 void USMStateMachineComponent::REP_OnInstanceLoaded()
@@ -1,6 +1,9 @@
 // Copyright Recursoft LLC 2019-2020. All Rights Reserved.
 #include "ISMSystemModule.h"
 #include "SMLogging.h"
+#include "SMTraceRecorder.h"
+#include "SMStateMachineComponent.h"
+#include "SMUtils.h"
 
 DEFINE_LOG_CATEGORY(LogLogicDriver);
 
@@ -17,6 +20,16 @@ IMPLEMENT_MODULE(FSMSystemModule, SMSystem)
 void FSMSystemModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory (but after global variables are initialized, of course.)
+
+	// Record the whole session. -SMTrace=Path writes to a specific file.
+	FString TracePath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("SMTrace="), TracePath) || FParse::Param(FCommandLine::Get(), TEXT("SMTrace")))
+	{
+		FSMTraceRecorder::Get().StartRecording(TracePath);
+	}
+
+	USMStateMachineComponent::RegisterTransactionBatching();
+	USMUtils::RegisterTemplateCacheCleanup();
 }
 
 
@@ -24,4 +37,7 @@ void FSMSystemModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FSMTraceRecorder::Get().StopRecording();
+	USMStateMachineComponent::UnregisterTransactionBatching();
+	USMUtils::UnregisterTemplateCacheCleanup();
 }
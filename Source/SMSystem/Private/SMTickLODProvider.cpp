@@ -0,0 +1,78 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+
+#include "SMTickLODProvider.h"
+#include "SMInstance.h"
+#include "SMStateMachineComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+float USMTickLODProvider::CalculateLODDistance_Implementation(USMInstance* Instance) const
+{
+	return 0.f;
+}
+
+float USMTickLODProvider_ViewDistance::CalculateLODDistance_Implementation(USMInstance* Instance) const
+{
+	AActor* LocationActor = FindLocationActor(Instance);
+	UWorld* World = Instance ? Instance->GetWorld() : nullptr;
+	if (!LocationActor || !World)
+	{
+		// Without a location the instance is treated as fully significant.
+		return 0.f;
+	}
+
+	const FVector Location = LocationActor->GetActorLocation();
+
+	float MinDistanceSquared = MAX_flt;
+	bool bFoundPlayer = false;
+
+	for (int32 Pass = 0; Pass < 2 && !bFoundPlayer; ++Pass)
+	{
+		// First pass only checks local players, second pass checks all players if none were local.
+		const bool bLocalOnly = Pass == 0;
+
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			const APlayerController* PlayerController = It->Get();
+			if (!PlayerController || (bLocalOnly && !PlayerController->IsLocalController()))
+			{
+				continue;
+			}
+
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+			MinDistanceSquared = FMath::Min(MinDistanceSquared, FVector::DistSquared(Location, ViewLocation));
+			bFoundPlayer = true;
+		}
+	}
+
+	return bFoundPlayer ? FMath::Sqrt(MinDistanceSquared) : 0.f;
+}
+
+AActor* USMTickLODProvider_ViewDistance::FindLocationActor(USMInstance* Instance) const
+{
+	if (!Instance)
+	{
+		return nullptr;
+	}
+
+	UObject* Context = Instance->GetMasterReferenceOwner()->GetContext();
+	if (AActor* Actor = Cast<AActor>(Context))
+	{
+		return Actor;
+	}
+
+	if (UActorComponent* Component = Cast<UActorComponent>(Context))
+	{
+		return Component->GetOwner();
+	}
+
+	if (USMStateMachineComponent* ComponentOwner = Instance->GetMasterReferenceOwner()->GetComponentOwner())
+	{
+		return ComponentOwner->GetOwner();
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,518 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "SMTraceRecorder.h"
+#include "SMInstance.h"
+#include "SMLogging.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformTLS.h"
+
+bool FSMTraceRecorder::bIsRecording = false;
+
+static FAutoConsoleCommand CVarSMTraceStart(
+	TEXT("sm.Trace.Start"),
+	TEXT("Begin recording state machine activity to a trace file. Optionally pass the file path."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FSMTraceRecorder::Get().StartRecording(Args.Num() > 0 ? Args[0] : FString());
+	}));
+
+static FAutoConsoleCommand CVarSMTraceStop(
+	TEXT("sm.Trace.Stop"),
+	TEXT("Stop recording state machine activity."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FSMTraceRecorder::Get().StopRecording();
+	}));
+
+/** Writes full trace buffers to disk off the recording threads. */
+class FSMTraceWriter : public FRunnable
+{
+public:
+	explicit FSMTraceWriter(FArchive* InArchive) : Archive(InArchive), Thread(nullptr), WorkEvent(nullptr), PendingBuffers(0), bStopping(false)
+	{
+		if (FPlatformProcess::SupportsMultithreading())
+		{
+			WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+			Thread = FRunnableThread::Create(this, TEXT("SMTraceWriter"), 0, TPri_BelowNormal);
+		}
+	}
+
+	/** Writes everything queued before returning. */
+	virtual ~FSMTraceWriter() override
+	{
+		if (Thread)
+		{
+			bStopping = true;
+			WorkEvent->Trigger();
+			Thread->WaitForCompletion();
+			delete Thread;
+			FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+		}
+
+		WriteQueued();
+	}
+
+	void Enqueue(TArray<uint8>&& Data)
+	{
+		PendingBuffers++;
+		Queue.Enqueue(MoveTemp(Data));
+
+		if (Thread)
+		{
+			WorkEvent->Trigger();
+		}
+		else
+		{
+			WriteQueued();
+		}
+	}
+
+	/** Buffers queued but not yet written. */
+	int32 GetNumPendingBuffers() const { return PendingBuffers; }
+
+	// FRunnable
+	virtual uint32 Run() override
+	{
+		while (!bStopping)
+		{
+			WorkEvent->Wait();
+			WriteQueued();
+		}
+
+		return 0;
+	}
+	// ~FRunnable
+
+private:
+	void WriteQueued()
+	{
+		TArray<uint8> Data;
+		while (Queue.Dequeue(Data))
+		{
+			Archive->Serialize(Data.GetData(), Data.Num());
+			PendingBuffers--;
+		}
+	}
+
+	FArchive* Archive;
+	FRunnableThread* Thread;
+	FEvent* WorkEvent;
+	TQueue<TArray<uint8>, EQueueMode::Mpsc> Queue;
+	TAtomic<int32> PendingBuffers;
+	TAtomic<bool> bStopping;
+};
+
+FSMTraceRecorder& FSMTraceRecorder::Get()
+{
+	static FSMTraceRecorder Recorder;
+	return Recorder;
+}
+
+FSMTraceRecorder::FSMTraceRecorder(): MaxBufferSize(DefaultBufferSize), MaxFileSize(DefaultMaxFileSize), BytesSubmitted(0), StartTime(0.0),
+                                      NextInstanceId(0), ThreadBufferTlsSlot(FPlatformTLS::AllocTlsSlot()), Generation(0), NumEventsRecorded(0),
+                                      NumEventsDropped(0)
+{
+}
+
+FSMTraceRecorder::~FSMTraceRecorder()
+{
+	StopRecording();
+	FPlatformTLS::FreeTlsSlot(ThreadBufferTlsSlot);
+}
+
+FString FSMTraceRecorder::GetDefaultTraceDirectory()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Traces"));
+}
+
+bool FSMTraceRecorder::StartRecording(const FString& InFilePath, int32 BufferSize, int64 InMaxFileSize)
+{
+	StopRecording();
+
+	FScopeLock Lock(&CriticalSection);
+
+	FilePath = InFilePath.IsEmpty() ?
+		FPaths::Combine(GetDefaultTraceDirectory(), FString::Printf(TEXT("SMTrace_%s.smtrace"), *FDateTime::Now().ToString())) : InFilePath;
+
+	FileWriter.Reset(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!FileWriter.IsValid())
+	{
+		LD_LOG_ERROR(TEXT("Could not create state machine trace file %s."), *FilePath);
+		return false;
+	}
+
+	MaxBufferSize = FMath::Max(BufferSize, 1024);
+	MaxFileSize = InMaxFileSize;
+	NextInstanceId = 0;
+	NumEventsRecorded = 0;
+	NumEventsDropped = 0;
+	Instances.Reset();
+	MetadataBuffer.Reset();
+
+	// Ids from a previous recording aren't valid in this one.
+	Generation++;
+
+	TArray<uint8> Header;
+	WriteValue(Header, SMTraceFormat::Magic);
+	WriteValue(Header, SMTraceFormat::Version);
+	WriteValue(Header, FDateTime::UtcNow().GetTicks());
+	FileWriter->Serialize(Header.GetData(), Header.Num());
+	BytesSubmitted = Header.Num();
+
+	Writer = MakeUnique<FSMTraceWriter>(FileWriter.Get());
+
+	StartTime = FPlatformTime::Seconds();
+	bIsRecording = true;
+
+	LD_LOG_INFO(TEXT("Recording state machine trace to %s."), *FilePath);
+	return true;
+}
+
+void FSMTraceRecorder::StopRecording()
+{
+	TArray<FThreadBuffer*> BuffersToFlush;
+	{
+		FScopeLock Lock(&CriticalSection);
+
+		if (!FileWriter.IsValid())
+		{
+			return;
+		}
+
+		bIsRecording = false;
+
+		for (const TUniquePtr<FThreadBuffer>& ThreadBuffer : ThreadBuffers)
+		{
+			BuffersToFlush.Add(ThreadBuffer.Get());
+		}
+	}
+
+	// Thread buffers are locked without holding the recorder lock, since recording threads take them in the opposite order.
+	for (FThreadBuffer* ThreadBuffer : BuffersToFlush)
+	{
+		FScopeLock BufferLock(&ThreadBuffer->CriticalSection);
+		if (ThreadBuffer->Data.Num() > 0 && !SubmitBuffer(ThreadBuffer->Data))
+		{
+			ThreadBuffer->Data.Reset();
+		}
+	}
+
+	FScopeLock Lock(&CriticalSection);
+
+	if (MetadataBuffer.Num() > 0)
+	{
+		SubmitBuffer(MetadataBuffer);
+	}
+
+	// Waits for the remaining buffers to be written.
+	Writer.Reset();
+	
+	FileWriter->Close();
+	FileWriter.Reset();
+
+	Instances.Empty();
+	MetadataBuffer.Empty();
+	Generation++;
+
+	LD_LOG_INFO(TEXT("Stopped state machine trace %s. %lld events recorded, %lld dropped."), *FilePath, GetNumEventsRecorded(), GetNumEventsDropped());
+}
+
+void FSMTraceRecorder::RecordEvent(const FSMNode_Base& Node, ESMTraceEventType Type, float Duration)
+{
+	if (!Node.GetOwningInstance())
+	{
+		return;
+	}
+
+	const double Time = FPlatformTime::Seconds() - StartTime;
+	
+	FThreadBuffer& ThreadBuffer = GetThreadBuffer();
+	FScopeLock BufferLock(&ThreadBuffer.CriticalSection);
+
+	if (!bIsRecording)
+	{
+		return;
+	}
+
+	const uint32 CurrentGeneration = Generation;
+	if (ThreadBuffer.Generation != CurrentGeneration)
+	{
+		ThreadBuffer.NodeIds.Reset();
+		ThreadBuffer.Generation = CurrentGeneration;
+	}
+
+	FNodeId NodeId;
+	if (const FNodeId* KnownNodeId = ThreadBuffer.NodeIds.Find(&Node))
+	{
+		NodeId = *KnownNodeId;
+	}
+	else if (FindOrAddNode(Node, NodeId))
+	{
+		ThreadBuffer.NodeIds.Add(&Node, NodeId);
+	}
+	else
+	{
+		NumEventsDropped++;
+		return;
+	}
+
+	if (ThreadBuffer.Data.Num() + SMTraceFormat::EventRecordSize > MaxBufferSize && !SubmitBuffer(ThreadBuffer.Data))
+	{
+		NumEventsDropped++;
+		return;
+	}
+
+	TArray<uint8>& Data = ThreadBuffer.Data;
+	WriteValue(Data, static_cast<uint8>(SMTraceFormat::Record_Event));
+	WriteValue(Data, static_cast<uint8>(Type));
+	WriteValue(Data, NodeId.InstanceId);
+	WriteValue(Data, NodeId.NodeIndex);
+	WriteValue(Data, Time);
+	WriteValue(Data, Duration);
+
+	NumEventsRecorded++;
+}
+
+void FSMTraceRecorder::RemoveInstance(const USMInstance* Instance)
+{
+	FScopeLock Lock(&CriticalSection);
+	if (Instances.Remove(Instance) > 0)
+	{
+		// Threads may have cached the instance's nodes by address.
+		Generation++;
+	}
+}
+
+FSMTraceRecorder::FThreadBuffer& FSMTraceRecorder::GetThreadBuffer()
+{
+	if (FThreadBuffer* ThreadBuffer = static_cast<FThreadBuffer*>(FPlatformTLS::GetTlsValue(ThreadBufferTlsSlot)))
+	{
+		return *ThreadBuffer;
+	}
+
+	FScopeLock Lock(&CriticalSection);
+	FThreadBuffer* ThreadBuffer = ThreadBuffers.Add_GetRef(MakeUnique<FThreadBuffer>()).Get();
+	FPlatformTLS::SetTlsValue(ThreadBufferTlsSlot, ThreadBuffer);
+	return *ThreadBuffer;
+}
+
+bool FSMTraceRecorder::FindOrAddNode(const FSMNode_Base& Node, FNodeId& OutNodeId)
+{
+	const USMInstance* Instance = Node.GetOwningInstance();
+	
+	FScopeLock Lock(&CriticalSection);
+
+	FInstanceEntry* Entry = Instances.Find(Instance);
+	if (!Entry)
+	{
+		Entry = &Instances.Add(Instance);
+		Entry->InstanceId = NextInstanceId++;
+
+		FString ClassPath = Instance->GetClass()->GetPathName();
+		FString Name = Instance->GetName();
+
+		TArray<uint8> Record;
+		FMemoryWriter Writer(Record);
+		uint8 RecordType = SMTraceFormat::Record_Instance;
+		Writer << RecordType;
+		Writer << Entry->InstanceId;
+		Writer << ClassPath;
+		Writer << Name;
+		AppendMetadata(Record);
+	}
+
+	OutNodeId.InstanceId = Entry->InstanceId;
+	
+	if (const uint16* NodeIndex = Entry->NodeIndices.Find(&Node))
+	{
+		OutNodeId.NodeIndex = *NodeIndex;
+		return true;
+	}
+
+	if (Entry->NodeIndices.Num() >= MAX_uint16)
+	{
+		return false;
+	}
+
+	uint16 NodeIndex = static_cast<uint16>(Entry->NodeIndices.Num());
+	Entry->NodeIndices.Add(&Node, NodeIndex);
+	OutNodeId.NodeIndex = NodeIndex;
+
+	FGuid NodeGuid = Node.GetNodeGuid();
+	FString NodeName = Node.GetNodeName();
+
+	TArray<uint8> Record;
+	FMemoryWriter Writer(Record);
+	uint8 RecordType = SMTraceFormat::Record_Node;
+	Writer << RecordType;
+	Writer << Entry->InstanceId;
+	Writer << NodeIndex;
+	Writer << NodeGuid;
+	Writer << NodeName;
+	AppendMetadata(Record);
+
+	return true;
+}
+
+void FSMTraceRecorder::AppendMetadata(const TArray<uint8>& Record)
+{
+	if (MetadataBuffer.Num() + Record.Num() > MaxBufferSize)
+	{
+		SubmitBuffer(MetadataBuffer);
+	}
+
+	MetadataBuffer.Append(Record);
+}
+
+bool FSMTraceRecorder::SubmitBuffer(TArray<uint8>& Data)
+{
+	if (!Writer.IsValid() || Writer->GetNumPendingBuffers() >= MaxPendingBuffers)
+	{
+		return false;
+	}
+
+	if (BytesSubmitted.AddExchange(Data.Num()) + Data.Num() > MaxFileSize)
+	{
+		if (bIsRecording)
+		{
+			LD_LOG_WARNING(TEXT("State machine trace %s reached the maximum size of %lld bytes. Further events are dropped."), *FilePath, MaxFileSize);
+
+			// Keep the file open so buffers already submitted are written when recording stops.
+			bIsRecording = false;
+		}
+
+		Data.Reset();
+		return false;
+	}
+
+	Writer->Enqueue(MoveTemp(Data));
+	Data.Reset(MaxBufferSize);
+	return true;
+}
+
+bool FSMTrace::LoadFromFile(const FString& InFilePath)
+{
+	Reset();
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *InFilePath))
+	{
+		LD_LOG_ERROR(TEXT("Could not read state machine trace %s."), *InFilePath);
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int64 StartTicks = 0;
+	Reader << Magic;
+	Reader << Version;
+	Reader << StartTicks;
+
+	if (Reader.IsError() || Magic != SMTraceFormat::Magic || Version != SMTraceFormat::Version)
+	{
+		LD_LOG_ERROR(TEXT("%s is not a supported state machine trace."), *InFilePath);
+		return false;
+	}
+
+	StartTime = FDateTime(StartTicks);
+
+	while (!Reader.AtEnd())
+	{
+		uint8 RecordType = 0;
+		Reader << RecordType;
+
+		// Records are only added once fully read. A trace from a session which didn't shut down cleanly may end with a partial record.
+		switch (RecordType)
+		{
+		case SMTraceFormat::Record_Instance:
+			{
+				FSMTraceInstance Instance;
+				Reader << Instance.InstanceId;
+				Reader << Instance.ClassPath;
+				Reader << Instance.Name;
+				if (!Reader.IsError())
+				{
+					Instances.Add(MoveTemp(Instance));
+				}
+				break;
+			}
+		case SMTraceFormat::Record_Node:
+			{
+				FSMTraceNode Node;
+				Reader << Node.InstanceId;
+				Reader << Node.NodeIndex;
+				Reader << Node.NodeGuid;
+				Reader << Node.NodeName;
+				if (!Reader.IsError())
+				{
+					NodeLookup.Add(MakeNodeKey(Node.InstanceId, Node.NodeIndex), Nodes.Add(MoveTemp(Node)));
+				}
+				break;
+			}
+		case SMTraceFormat::Record_Event:
+			{
+				uint8 EventType = 0;
+				FSMTraceEvent Event;
+				Reader << EventType;
+				Reader << Event.InstanceId;
+				Reader << Event.NodeIndex;
+				Reader << Event.Time;
+				Reader << Event.Duration;
+				Event.Type = static_cast<ESMTraceEventType>(EventType);
+				if (!Reader.IsError())
+				{
+					Events.Add(Event);
+				}
+				break;
+			}
+		default:
+			{
+				LD_LOG_ERROR(TEXT("Unknown record in state machine trace %s. The remaining file is ignored."), *InFilePath);
+				Reader.Seek(Reader.TotalSize());
+				break;
+			}
+		}
+
+		if (Reader.IsError())
+		{
+			LD_LOG_WARNING(TEXT("State machine trace %s is truncated."), *InFilePath);
+			break;
+		}
+	}
+
+	// Threads buffer their events separately so they are only in order per thread.
+	Events.StableSort([](const FSMTraceEvent& A, const FSMTraceEvent& B)
+	{
+		return A.Time < B.Time;
+	});
+
+	return true;
+}
+
+void FSMTrace::Reset()
+{
+	Instances.Reset();
+	Nodes.Reset();
+	Events.Reset();
+	NodeLookup.Reset();
+	StartTime = FDateTime();
+}
+
+const FSMTraceNode* FSMTrace::FindNode(uint32 InstanceId, uint16 NodeIndex) const
+{
+	if (const int32* Index = NodeLookup.Find(MakeNodeKey(InstanceId, NodeIndex)))
+	{
+		return &Nodes[*Index];
+	}
+
+	return nullptr;
+}
@@ -3,6 +3,9 @@
 #include "SMUtils.h"
 //#include "Blueprints/SMBlueprintGeneratedClass.h"
 #include "Engine/World.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/UObjectGlobals.h"
 #include "SMLogging.h"
 
 
@@ -38,6 +41,34 @@ USMInstance* USMBlueprintUtils::CreateStateMachineInstanceInternal(TSubclassOf<U
 	return Instance;
 }
 
+/** Node counts of every state machine in a class. Node guids are compiled so each instance of the class has the same counts. */
+struct FSMClassNodeCounts
+{
+	struct FStateMachineCounts
+	{
+		int32 NumStates = 0;
+		int32 NumTransitions = 0;
+		int32 NumGlobalTransitions = 0;
+	};
+
+	struct FTransitionCounts
+	{
+		int32 Outgoing = 0;
+		int32 Incoming = 0;
+	};
+
+	/** By state machine node guid. */
+	TMap<FGuid, FStateMachineCounts> StateMachines;
+
+	/** By state node guid. */
+	TMap<FGuid, FTransitionCounts> TransitionsPerState;
+};
+
+typedef TSharedPtr<const FSMClassNodeCounts, ESPMode::ThreadSafe> FSMClassNodeCountsPtr;
+
+static FSMClassNodeCountsPtr CountClassNodes(UObject* Instance, const TSet<FStructProperty*>& RunTimeProperties);
+static FSMClassNodeCountsPtr FindOrCountClassNodes(UObject* Instance, const TSet<FStructProperty*>& RunTimeProperties);
+
 bool USMUtils::GenerateStateMachine(UObject* Instance, FSMStateMachine& StateMachineOut,
 	const TSet<FStructProperty*>& RunTimeProperties, bool bDryRun)
 {
@@ -184,9 +215,19 @@ bool USMUtils::GenerateStateMachine(UObject* Instance, FSMStateMachine& StateMac
 	// Only match properties belonging to this state machine.
 	const FGuid& StateMachineNodeGuid = StateMachineOut.GetNodeGuid();
 
+	// Allocate every container below once at its final size. A dry run is for a class being compiled so it isn't cached.
+	const FSMClassNodeCountsPtr NodeCounts = bDryRun ? CountClassNodes(Instance, RunTimeProperties) : FindOrCountClassNodes(Instance, RunTimeProperties);
+	const FSMClassNodeCounts::FStateMachineCounts* StateMachineCounts = NodeCounts->StateMachines.Find(StateMachineNodeGuid);
+	const int32 NumStates = StateMachineCounts ? StateMachineCounts->NumStates : 0;
+	const int32 NumTransitions = StateMachineCounts ? StateMachineCounts->NumTransitions : 0;
+	
+	StateMachineOut.ReserveNodes(NumStates, NumTransitions, StateMachineCounts ? StateMachineCounts->NumGlobalTransitions : 0);
+	
 	// Used for quick lookup when linking to states.
 	TMap<FGuid, FSMState_Base*> MappedStates;
 	TMap<FGuid, FSMTransition*> MappedTransitions;
+	MappedStates.Reserve(NumStates);
+	MappedTransitions.Reserve(NumTransitions);
 	// Retrieve pointers to the runtime states and store in state machine for quick access.
 	for (auto& Property : RunTimeProperties)
 	{
@@ -201,6 +242,11 @@ bool USMUtils::GenerateStateMachine(UObject* Instance, FSMStateMachine& StateMac
 
 			StateMachineOut.AddState(State);
 
+			if (const FSMClassNodeCounts::FTransitionCounts* TransitionCounts = NodeCounts->TransitionsPerState.Find(State->GetNodeGuid()))
+			{
+				State->ReserveTransitions(TransitionCounts->Outgoing, TransitionCounts->Incoming);
+			}
+
 			/*
 			 * Unique GUID check 1:
 			 * The NodeGuid at this stage should always be unique and the ensure should never be tripped.
@@ -239,13 +285,6 @@ bool USMUtils::GenerateStateMachine(UObject* Instance, FSMStateMachine& StateMac
 			}
 
 			// Convert linked guids to the actual states.
-			FSMState_Base* FromState = MappedStates.FindRef(Transition->FromGuid);
-			if (!FromState)
-			{
-				LD_LOG_ERROR(TEXT("Critical error creating state machine %s for package %s. The transition %s could not locate the FromState using Guid %s."), *StateMachineOut.GetNodeName(), *Instance->GetName(),
-					*Transition->GetNodeName(), *Transition->FromGuid.ToString());
-				return false;
-			}
 			FSMState_Base* ToState = MappedStates.FindRef(Transition->ToGuid);
 			if (!ToState)
 			{
@@ -254,11 +293,43 @@ bool USMUtils::GenerateStateMachine(UObject* Instance, FSMStateMachine& StateMac
 				return false;
 			}
 
-			// The transition will handle updating the state.
-			Transition->SetFromState(FromState);
-			Transition->SetToState(ToState);
+			if (Transition->bIsGlobalTransition)
+			{
+				// Compiled from an Any State node. Shared by every state it can be taken from.
+				for (const FGuid& FromGuid : Transition->GlobalFromGuids)
+				{
+					if (FSMState_Base* FromState = MappedStates.FindRef(FromGuid))
+					{
+						Transition->AddGlobalFromState(FromState);
+					}
+				}
+
+				if (!Transition->GetFromState())
+				{
+					LD_LOG_WARNING(TEXT("Global transition %s in state machine %s for package %s can't be taken from any state and was skipped."),
+						*Transition->GetNodeName(), *StateMachineOut.GetNodeName(), *Instance->GetName());
+					continue;
+				}
+
+				Transition->SetToState(ToState);
+				StateMachineOut.AddGlobalTransition(Transition);
+			}
+			else
+			{
+				FSMState_Base* FromState = MappedStates.FindRef(Transition->FromGuid);
+				if (!FromState)
+				{
+					LD_LOG_ERROR(TEXT("Critical error creating state machine %s for package %s. The transition %s could not locate the FromState using Guid %s."), *StateMachineOut.GetNodeName(), *Instance->GetName(),
+						*Transition->GetNodeName(), *Transition->FromGuid.ToString());
+					return false;
+				}
 
-			StateMachineOut.AddTransition(Transition);
+				// The transition will handle updating the state.
+				Transition->SetFromState(FromState);
+				Transition->SetToState(ToState);
+
+				StateMachineOut.AddTransition(Transition);
+			}
 			
 			/*
 			 * Unique GUID check 1:
@@ -376,32 +447,228 @@ void USMUtils::ExecuteGraphFunctions(TArray<FSMExposedFunctionHandler>& GraphFun
 	}
 }
 
-UObject* USMUtils::FindTemplateFromInstance(USMInstance* Instance, const FName& TemplateName)
+/** Templates owned by a class default object and its parents. */
+struct FSMClassTemplateCache
+{
+	/** The class default objects the templates were gathered from, most derived first. A recompile or reload of any class creates a new one. */
+	TArray<TWeakObjectPtr<UObject>, TInlineAllocator<4>> DefaultObjects;
+
+	/** Template archetypes by name. The most derived class wins when names match. */
+	TMap<FName, TWeakObjectPtr<UObject>> Templates;
+
+	/** Reference templates of the class default object. */
+	TArray<TWeakObjectPtr<USMInstance>> ReferenceTemplates;
+
+	/** Counted the first time an instance of the class generates its state machines. */
+	FSMClassNodeCountsPtr NodeCounts;
+
+	/** If the templates were gathered from the current class default objects of the class and every parent. */
+	bool IsCurrent(const UClass* Class) const
+	{
+		int32 Idx = 0;
+		for (const UClass* CurrentClass = Class; CurrentClass; CurrentClass = CurrentClass->GetSuperClass(), ++Idx)
+		{
+			if (!DefaultObjects.IsValidIndex(Idx) || DefaultObjects[Idx].Get() != CurrentClass->GetDefaultObject(false))
+			{
+				return false;
+			}
+		}
+
+		return Idx == DefaultObjects.Num();
+	}
+};
+
+/** Keyed weakly so entries of garbage collected classes can be found and removed. */
+static TMap<TWeakObjectPtr<const UClass>, FSMClassTemplateCache> ClassTemplateCache;
+
+/**
+ * Instances may be created off the game thread. Lookups of current entries share the read lock and only building an entry
+ * takes the write lock. Only read the cache through ReadClassTemplateCache.
+ */
+static FRWLock ClassTemplateCacheLock;
+
+static FDelegateHandle PostGarbageCollectHandle;
+
+/** Call with the write lock held. The returned reference is only valid while the lock is held. */
+static FSMClassTemplateCache& FindOrBuildClassTemplateCache(UClass* Class)
 {
-	UClass* CurrentClass = Instance->GetClass();
-	while (CurrentClass)
+	// Another thread may have built the entry while waiting for the lock.
+	FSMClassTemplateCache* ExistingCache = ClassTemplateCache.Find(Class);
+	if (ExistingCache && ExistingCache->IsCurrent(Class))
 	{
-		if (UObject* FoundTemplate = Cast<UObject>(CurrentClass->GetDefaultSubobjectByName(TemplateName)))
+		return *ExistingCache;
+	}
+
+	FSMClassTemplateCache& Cache = ClassTemplateCache.FindOrAdd(Class);
+	Cache.DefaultObjects.Reset();
+	Cache.Templates.Reset();
+	Cache.ReferenceTemplates.Reset();
+	Cache.NodeCounts.Reset();
+
+	TArray<UObject*> Subobjects;
+	for (UClass* CurrentClass = Class; CurrentClass; CurrentClass = CurrentClass->GetSuperClass())
+	{
+		UObject* DefaultObject = CurrentClass->GetDefaultObject();
+		Cache.DefaultObjects.Add(DefaultObject);
+
+		Subobjects.Reset();
+		DefaultObject->GetDefaultSubobjects(Subobjects);
+		for (UObject* Subobject : Subobjects)
 		{
-			return FoundTemplate;
+			if (!Cache.Templates.Contains(Subobject->GetFName()))
+			{
+				Cache.Templates.Add(Subobject->GetFName(), Subobject);
+			}
 		}
-		CurrentClass = CurrentClass->GetSuperClass();
 	}
 
-	return nullptr;
+	if (USMInstance* DefaultInstance = Cast<USMInstance>(Class->GetDefaultObject()))
+	{
+		for (UObject* Template : DefaultInstance->ReferenceTemplates)
+		{
+			if (USMInstance* ReferenceTemplate = Cast<USMInstance>(Template))
+			{
+				Cache.ReferenceTemplates.Add(ReferenceTemplate);
+			}
+		}
+	}
+	
+	return Cache;
 }
 
-bool USMUtils::TryGetAllReferenceTemplatesFromInstance(USMInstance* Instance, TSet<USMInstance*>& TemplatesOut, bool bIncludeNested)
+/** Call Read with the current cache of the class, building it first when missing or stale. */
+template<typename FunctionType>
+static void ReadClassTemplateCache(UClass* Class, FunctionType&& Read)
 {
-	for (UObject* Template : Instance->ReferenceTemplates)
 	{
-		USMInstance* ReferenceTemplate = Cast<USMInstance>(Template);
+		FRWScopeLock Lock(ClassTemplateCacheLock, SLT_ReadOnly);
 		
-		if(!ReferenceTemplate)
+		const FSMClassTemplateCache* Cache = ClassTemplateCache.Find(Class);
+		if (Cache && Cache->IsCurrent(Class))
 		{
-			continue;
+			Read(*Cache);
+			return;
+		}
+	}
+
+	FRWScopeLock Lock(ClassTemplateCacheLock, SLT_Write);
+	Read(FindOrBuildClassTemplateCache(Class));
+}
+
+static FSMClassNodeCountsPtr CountClassNodes(UObject* Instance, const TSet<FStructProperty*>& RunTimeProperties)
+{
+	TSharedRef<FSMClassNodeCounts, ESPMode::ThreadSafe> NodeCounts = MakeShared<FSMClassNodeCounts, ESPMode::ThreadSafe>();
+	for (FStructProperty* Property : RunTimeProperties)
+	{
+		if (Property->Struct->IsChildOf(FSMState_Base::StaticStruct()))
+		{
+			const FSMState_Base* State = Property->ContainerPtrToValuePtr<FSMState_Base>(Instance);
+			NodeCounts->StateMachines.FindOrAdd(State->GetOwnerNodeGuid()).NumStates++;
+		}
+		else if (Property->Struct->IsChildOf(FSMTransition::StaticStruct()))
+		{
+			const FSMTransition* Transition = Property->ContainerPtrToValuePtr<FSMTransition>(Instance);
+			FSMClassNodeCounts::FStateMachineCounts& StateMachineCounts = NodeCounts->StateMachines.FindOrAdd(Transition->GetOwnerNodeGuid());
+			
+			StateMachineCounts.NumTransitions++;
+			NodeCounts->TransitionsPerState.FindOrAdd(Transition->ToGuid).Incoming++;
+			if (Transition->bIsGlobalTransition)
+			{
+				StateMachineCounts.NumGlobalTransitions++;
+			}
+			else
+			{
+				NodeCounts->TransitionsPerState.FindOrAdd(Transition->FromGuid).Outgoing++;
+			}
 		}
+	}
+
+	return NodeCounts;
+}
+
+static FSMClassNodeCountsPtr FindOrCountClassNodes(UObject* Instance, const TSet<FStructProperty*>& RunTimeProperties)
+{
+	UClass* Class = Instance->GetClass();
+	{
+		FRWScopeLock Lock(ClassTemplateCacheLock, SLT_ReadOnly);
 		
+		const FSMClassTemplateCache* Cache = ClassTemplateCache.Find(Class);
+		if (Cache && Cache->NodeCounts.IsValid() && Cache->IsCurrent(Class))
+		{
+			return Cache->NodeCounts;
+		}
+	}
+
+	// Count outside of the lock. If another thread counted the class first its counts are kept.
+	const FSMClassNodeCountsPtr NodeCounts = CountClassNodes(Instance, RunTimeProperties);
+	
+	FRWScopeLock Lock(ClassTemplateCacheLock, SLT_Write);
+	
+	FSMClassTemplateCache& Cache = FindOrBuildClassTemplateCache(Class);
+	if (!Cache.NodeCounts.IsValid())
+	{
+		Cache.NodeCounts = NodeCounts;
+	}
+
+	return Cache.NodeCounts;
+}
+
+static void RemoveStaleClassTemplateCacheEntries()
+{
+	FRWScopeLock Lock(ClassTemplateCacheLock, SLT_Write);
+	for (auto It = ClassTemplateCache.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+UObject* USMUtils::FindTemplateFromInstance(USMInstance* Instance, const FName& TemplateName)
+{
+	UObject* FoundTemplate = nullptr;
+	ReadClassTemplateCache(Instance->GetClass(), [&](const FSMClassTemplateCache& Cache)
+	{
+		if (const TWeakObjectPtr<UObject>* Template = Cache.Templates.Find(TemplateName))
+		{
+			FoundTemplate = Template->Get();
+		}
+	});
+
+	return FoundTemplate;
+}
+
+bool USMUtils::TryGetAllReferenceTemplatesFromInstance(USMInstance* Instance, TSet<USMInstance*>& TemplatesOut, bool bIncludeNested)
+{
+	TArray<USMInstance*> ReferenceTemplates;
+	if (Instance->HasAnyFlags(RF_ClassDefaultObject))
+	{
+		// Other instances may have had their templates changed, such as when cleaning nested templates during compile.
+		ReadClassTemplateCache(Instance->GetClass(), [&](const FSMClassTemplateCache& Cache)
+		{
+			for (const TWeakObjectPtr<USMInstance>& Template : Cache.ReferenceTemplates)
+			{
+				if (USMInstance* ReferenceTemplate = Template.Get())
+				{
+					ReferenceTemplates.Add(ReferenceTemplate);
+				}
+			}
+		});
+	}
+	else
+	{
+		for (UObject* Template : Instance->ReferenceTemplates)
+		{
+			if (USMInstance* ReferenceTemplate = Cast<USMInstance>(Template))
+			{
+				ReferenceTemplates.Add(ReferenceTemplate);
+			}
+		}
+	}
+	
+	for (USMInstance* ReferenceTemplate : ReferenceTemplates)
+	{
 		TemplatesOut.Add(ReferenceTemplate);
 
 		if (bIncludeNested)
@@ -413,6 +680,61 @@ bool USMUtils::TryGetAllReferenceTemplatesFromInstance(USMInstance* Instance, TS
 	return TemplatesOut.Num() > 0;
 }
 
+void USMUtils::InvalidateTemplateCache(const UClass* Class)
+{
+	FRWScopeLock Lock(ClassTemplateCacheLock, SLT_Write);
+	
+	if (Class)
+	{
+		ClassTemplateCache.Remove(Class);
+	}
+	else
+	{
+		ClassTemplateCache.Empty();
+	}
+}
+
+bool USMUtils::IsTemplateCached(const UClass* Class)
+{
+	FRWScopeLock Lock(ClassTemplateCacheLock, SLT_ReadOnly);
+	
+	const FSMClassTemplateCache* Cache = ClassTemplateCache.Find(Class);
+	return Cache && Cache->IsCurrent(Class);
+}
+
+void USMUtils::RegisterTemplateCacheCleanup()
+{
+	if (!PostGarbageCollectHandle.IsValid())
+	{
+		PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddStatic(&RemoveStaleClassTemplateCacheEntries);
+	}
+}
+
+void USMUtils::UnregisterTemplateCacheCleanup()
+{
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+	PostGarbageCollectHandle.Reset();
+	InvalidateTemplateCache();
+}
+
+bool USMUtils::IsFunctionOverridden(const UClass* Class, const UClass* BaseClass, const FName& FunctionName)
+{
+	if (Class->IsFunctionImplementedInScript(FunctionName))
+	{
+		return true;
+	}
+
+	for (const UClass* SuperClass = Class; SuperClass && SuperClass != BaseClass; SuperClass = SuperClass->GetSuperClass())
+	{
+		if (!SuperClass->IsA<UBlueprintGeneratedClass>())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 bool USMUtils::FinishStateMachineGeneration(bool bIsTopLevel, TMap<uint32, GeneratingStateMachines>& ThreadMap, uint32 ThreadId)
 {
 	if (bIsTopLevel)
@@ -0,0 +1,73 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SMLogging.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("SMNodeStructInstances"), STAT_NodeStructInstances, STATGROUP_LogicDriver, SMSYSTEM_API);
+
+struct FSMState_Base;
+struct FSMTransition;
+
+/**
+ * Native node logic which doesn't require a UObject per node.
+ *
+ * Register a derived struct against a node instance class with FSMNodeStructRegistry. Nodes using that class then
+ * construct the struct in their state machine instance's memory instead of creating a USMNodeInstance. The class is still
+ * what is assigned to nodes in the editor.
+ *
+ * Struct instances aren't visible to reflection or garbage collection. Node templates aren't loaded for them and
+ * GetNodeInstance() returns null for their nodes.
+ */
+struct SMSYSTEM_API FSMNodeStructInstance
+{
+	FSMNodeStructInstance();
+	virtual ~FSMNodeStructInstance();
+
+	/** Called when a state, conduit or state machine using this struct starts. */
+	virtual void OnStateBegin(FSMState_Base& State) {}
+
+	/** Called when the state updates. */
+	virtual void OnStateUpdate(FSMState_Base& State, float DeltaSeconds) {}
+
+	/** Called when the state ends. */
+	virtual void OnStateEnd(FSMState_Base& State) {}
+
+	/** Called when a transition using this struct is taken. */
+	virtual void OnTransitionEntered(FSMTransition& Transition) {}
+};
+
+/**
+ * Maps node instance classes to the struct which should be constructed in their place.
+ * Registration should happen on module startup. Instances may initialize off the game thread so every access is locked.
+ * Classes are keyed by pointer, register again if a hot reload replaces the class.
+ */
+class SMSYSTEM_API FSMNodeStructRegistry
+{
+public:
+	typedef FSMNodeStructInstance* (*FConstructFunction)(void* Memory);
+
+	struct FEntry
+	{
+		int32 Size;
+		int32 Alignment;
+		FConstructFunction Construct;
+	};
+
+	/** Construct T for all nodes of NodeInstanceClass. Child classes aren't affected. */
+	template<typename T>
+	static void Register(const UClass* NodeInstanceClass)
+	{
+		static_assert(TIsDerivedFrom<T, FSMNodeStructInstance>::IsDerived, "Node struct instances must derive from FSMNodeStructInstance.");
+		Register(NodeInstanceClass, { (int32)sizeof(T), (int32)alignof(T), [](void* Memory) -> FSMNodeStructInstance* { return new(Memory) T(); } });
+	}
+
+	static void Register(const UClass* NodeInstanceClass, const FEntry& Entry);
+	static void Unregister(const UClass* NodeInstanceClass);
+
+	/** If any class is registered. Instances skip sizing struct memory when none are. */
+	static bool HasRegistrations();
+
+	/** Copy the entry for a class. False if it should create a USMNodeInstance. */
+	static bool Find(const UClass* NodeInstanceClass, FEntry& OutEntry);
+};
@@ -7,6 +7,7 @@
 
 class USMInstance;
 class USMNodeInstance;
+struct FSMNodeStructInstance;
 
 UENUM()
 enum class ESMTransactionType : uint8
@@ -25,7 +26,7 @@ public:
 	FSMNetworkedTransaction() : FSMNetworkedTransaction(FGuid(), FGuid()) {}
 	
 	FSMNetworkedTransaction(const FGuid& SMGuid, const FGuid& TGuid, ESMTransactionType Type = ESMTransactionType::SM_Transition) :
-	StateMachineGuid(SMGuid), BaseGuid(TGuid), TransactionGuid(FGuid::NewGuid()), Timestamp(0), TransactionType((int32)Type), bIsActive(false) {}
+	StateMachineGuid(SMGuid), BaseGuid(TGuid), TransactionGuid(FGuid::NewGuid()), Timestamp(0), TransactionType((int32)Type), bIsActive(false), PredictionKey(0) {}
 
 	/** The owning state machine. */
 	UPROPERTY()
@@ -51,8 +52,68 @@ public:
 	UPROPERTY()
 	uint32 bIsActive:1;
 
+	/** Assigned by a client predicting this transaction so the server can confirm or reject it. 0 if not predicted. */
+	UPROPERTY()
+	int32 PredictionKey;
+
 	bool IsTransition() const { return (ESMTransactionType)TransactionType == ESMTransactionType::SM_Transition; }
 	bool IsState() const { return (ESMTransactionType)TransactionType == ESMTransactionType::SM_State; }
+	bool IsPredicted() const { return PredictionKey != 0; }
+};
+
+/**
+ * Record of transactions which have already been applied. Entries are kept in insertion order in a ring buffer and expire by
+ * monotonic time (FPlatformTime::Seconds). A full buffer overwrites its oldest entry only once it has expired, otherwise it
+ * doubles in size, so it has no upper bound while transactions arrive faster than they expire.
+ * Lookups go through a set of the recorded guids.
+ */
+struct SMSYSTEM_API FSMNetworkedTransactionHistory
+{
+	enum { DefaultCapacity = 64 };
+
+	FSMNetworkedTransactionHistory() : Head(0), Count(0), Timeout(-1.0) {}
+
+	/** Resize the buffer. Existing entries are discarded. */
+	void SetCapacity(int32 NewCapacity);
+	int32 GetCapacity() const { return Entries.Num(); }
+
+	/** The number of recorded transactions. */
+	int32 Num() const { return Count; }
+
+	bool Contains(const FGuid& TransactionGuid) const;
+
+	/**
+	 * Record a transaction. A transaction already recorded is ignored. When full the oldest entry is overwritten only if it
+	 * has expired, otherwise the buffer grows. Allocates only if no capacity has been set or the buffer has to grow.
+	 */
+	void Add(const FGuid& TransactionGuid, double CurrentTime);
+
+	/** Remove entries recorded at least InTimeout seconds ago. Stops at the first entry that hasn't expired. The timeout is kept for Add. */
+	void RemoveExpired(double CurrentTime, double InTimeout);
+
+	void Reset();
+
+private:
+	/** Double the capacity keeping all entries. */
+	void Grow();
+
+	struct FEntry
+	{
+		FGuid TransactionGuid;
+		double Time;
+	};
+
+	TArray<FEntry> Entries;
+
+	/** Guids of every entry in the buffer. Reserved to the capacity. */
+	TSet<FGuid> RecordedGuids;
+
+	/** Index of the oldest entry. */
+	int32 Head;
+	int32 Count;
+
+	/** The timeout from the last RemoveExpired. Negative until known, in which case nothing is considered expired. */
+	double Timeout;
 };
 
 /**
@@ -90,6 +151,14 @@ public:
 	/** Entry point to when a transition is shutdown. */
 	UPROPERTY()
 	TArray<FSMExposedFunctionHandler> TransitionShutdownGraphEvaluators;
+
+	/** Entry point to when the owning instance is initialized. Used to bind auto-bound events once when compiled with persistent bindings. */
+	UPROPERTY()
+	TArray<FSMExposedFunctionHandler> InstanceInitializedGraphEvaluators;
+
+	/** Entry point to when the owning instance is shutdown. Used to remove persistent auto-bound event bindings. */
+	UPROPERTY()
+	TArray<FSMExposedFunctionHandler> InstanceShutdownGraphEvaluators;
 	
 	/** Special indicator in case this node is a duplicate within the same blueprint. If this isn't 0 then the NodeGuid will have been adjusted. */
 	UPROPERTY()
@@ -152,6 +221,15 @@ public:
 	/** Return the current node instance. Only valid after initialization and may be nullptr. */
 	virtual USMNodeInstance* GetNodeInstance() const { return NodeInstance; }
 
+	/** Return the native struct instance used in place of a node instance when the node class is registered with FSMNodeStructRegistry. */
+	FSMNodeStructInstance* GetNodeStructInstance() const { return NodeStructInstance; }
+
+	/** Called by the owning instance when it destroys the struct instance. */
+	void ReleaseNodeStructInstance() { NodeStructInstance = nullptr; }
+
+	/** The node instance class, or the default class when none is set. */
+	UClass* GetNodeInstanceClass() const { return NodeInstanceClass ? NodeInstanceClass : GetDefaultNodeInstanceClass(); }
+
 	/** The default node instance class. Each derived node class needs to implement. */
 	virtual UClass* GetDefaultNodeInstanceClass() const { return nullptr; }
 
@@ -164,9 +242,20 @@ public:
 	/** If this node is active. */
 	virtual bool IsActive() const { return bIsActive; }
 
+	/** If begin, end and entered logic should run. False while the owning instance resimulates unless it is configured to run it. */
+	bool CanExecuteEventLogic() const;
+
 	virtual void ExecuteInitializeNodes();
 	virtual void ExecuteShutdownNodes();
 
+	/** If the transition initialize nodes have run without a shutdown since. Persistent auto-bound events only fire while this is true. */
+	bool AreTransitionNodesInitialized() const { return bTransitionNodesInitialized; }
+
+	/** Run once by the owning instance after it has initialized. */
+	void ExecuteInstanceInitializedNodes();
+	/** Run once by the owning instance before it shuts down. */
+	void ExecuteInstanceShutdownNodes();
+
 #if WITH_EDITORONLY_DATA
 	virtual bool IsDebugActive() const { return bIsActive; }
 	virtual bool WasDebugActive() const { return bWasActive; }
@@ -223,7 +312,12 @@ protected:
 	UPROPERTY(BlueprintReadWrite, Category = "Node Class")
 	UClass* NodeInstanceClass;
 
+	/** Owned and destroyed by the owning instance. */
+	FSMNodeStructInstance* NodeStructInstance;
+
 	bool bInitialized;
 
 	bool bIsActive;
+
+	bool bTransitionNodesInitialized;
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "CoreMinimal.h"
 #include "SMState.h"
+#include "SMTransition.h"
 #include "SMConduit.generated.h"
 
 
@@ -32,6 +33,10 @@ struct SMSYSTEM_API FSMConduit : public FSMState_Base
 	UPROPERTY()
 	uint32 bEvalWithTransitions: 1;
 
+	/** The conditional evaluation type which determines if the conduit graph needs to run. */
+	UPROPERTY()
+	ESMConditionalEvaluationType ConditionalEvaluationType;
+
 	/** Entry point when the conduit is entered. */
 	UPROPERTY()
 	FSMExposedFunctionHandler ConduitEnteredGraphEvaluator;
@@ -59,6 +64,13 @@ public:
 	virtual bool GetValidTransition(TArray<TArray<FSMTransition*>>& Transitions) override;
 	// ~FSMState_Base
 	
+	/**
+	 * Evaluate the conduit and append the first passing transition chain leading out of it.
+	 * Conduits never start parallel states so only a single chain is needed.
+	 * @return True if a valid path is found. OutChain is unchanged otherwise.
+	 */
+	bool GetValidTransitionChain(TArray<FSMTransition*>& OutChain);
+
 	/** Should this be considered an extension to a transition? */
 	bool IsConfiguredAsTransition() const { return bEvalWithTransitions; }
 
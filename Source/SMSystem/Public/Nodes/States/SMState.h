@@ -74,9 +74,15 @@ public:
 
 	/** The transitions leading to this state. */
 	const TArray<FSMTransition*>& GetIncomingTransitions() const { return IncomingTransitions; }
+
+	/** Size the transition lists for the transitions about to be added so each is allocated once. */
+	void ReserveTransitions(int32 NumOutgoing, int32 NumIncoming);
 	
 	/** Returns all connected transitions from this state, including ones connected to transition conduits. */
 	void GetAllTransitionChains(TArray<FSMTransition*>& OutTransitions) const;
+
+	/** All connected transitions from this state, including ones connected to transition conduits. Built once after the state machine is linked. */
+	const TArray<FSMTransition*>& GetAllTransitionChains() const;
 	
 	/** Sets the state as active and begins execution. */
 	virtual bool StartState();
@@ -121,12 +127,21 @@ public:
 	/** Current time in seconds this state has been active. */
 	float GetActiveTime() const { return TimeInState; }
 
+	/** Fixed steps this state has been active for. Only valid when the owning instance uses a fixed time step. */
+	int32 GetActiveFixedSteps() const { return FixedStepsInState; }
+
+	/** Restore runtime values from a rewind snapshot. No state logic is executed. */
+	void RestoreFromSnapshot(bool bActive, float InTimeInState, int32 InFixedStepsInState, bool bInHasUpdated);
+
 	/** Set if this state is allowed to execute its logic. */
 	void SetCanExecuteLogic(bool bValue);
 
 	/** If this state is allowed to execute logic. */
 	bool CanExecuteLogic() const { return bCanExecuteLogic; }
 
+	/** If this state is allowed to execute update logic. Considers the tick LOD of the owning instance. */
+	bool CanExecuteUpdateLogic() const;
+
 	/** If this state is allowed to evaluate its transitions on tick. This can return true even when tick evaluation is false in the event
 	 * an outgoing transition has just completed from an event. */
 	bool CanEvaluateTransitionsOnTick() const;
@@ -149,6 +164,16 @@ public:
 
 	/** True while the state is ending and graph execution is occurring. Prevents restarting this state when it triggers transitions while ending. */
 	bool IsStateEnding() const { return bIsStateEnding; }
+
+	/** If a global transition of the owning state machine can be taken from this state. */
+	bool HasGlobalTransitions() const { return GlobalTransitions.Num() > 0; }
+
+	/** Global transitions of the owning state machine which can be taken from this state, sorted lowest to highest priority. */
+	const TArray<FSMTransition*>& GetGlobalTransitions() const { return GlobalTransitions; }
+
+	/** Index of this state in the owning state machine. INDEX_NONE if it hasn't been added to one. */
+	int32 GetStateIndex() const { return StateIndex; }
+	void SetStateIndex(int32 Index) { StateIndex = Index; }
 	
 protected:
 	friend struct FSMTransition;
@@ -168,11 +193,24 @@ protected:
 
 	/** True while the state is ending and graph execution is occurring. Prevents restarting this state when it triggers transitions while ending. */
 	bool bIsStateEnding = false;
+
+	/** Integer time in state used for fixed time steps. TimeInState is derived from this to avoid accumulating float error. */
+	int32 FixedStepsInState = 0;
+
+	/** Added by global transitions which can be taken from this state so evaluation doesn't search every global transition. */
+	TArray<FSMTransition*> GlobalTransitions;
+
+	/** Set by the owning state machine when this state is added. */
+	int32 StateIndex = INDEX_NONE;
 	
 private:
 	const FSMTransition* NextTransition;
 	TArray<FSMTransition*> IncomingTransitions;
 	TArray<FSMTransition*> OutgoingTransitions;
+
+	/** Cached result of GetAllTransitionChains, used each time the state starts and ends. */
+	mutable TArray<FSMTransition*> TransitionChains;
+	mutable bool bTransitionChainsCached = false;
 };
 
 /**
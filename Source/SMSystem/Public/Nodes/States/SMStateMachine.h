@@ -5,6 +5,85 @@
 #include "SMTransition.h"
 #include "SMStateMachine.generated.h"
 
+/**
+ * Set of states belonging to a state machine. Membership of the state machine's own states is a bit per state index so no
+ * hashing or allocation occurs once sized. Members are iterated in slot order where freed slots are reused most recent first,
+ * the same order the TSet previously used had, keeping the processing order of parallel states.
+ */
+struct SMSYSTEM_API FSMStateSet
+{
+	FSMStateSet() : NumStates(0) {}
+
+	/** Size the membership bits for the states of the owning state machine. Existing members are kept. */
+	void Init(int32 NumIndices);
+
+	/**
+	 * Membership functions take the index of the state in the owning state machine.
+	 * An index of INDEX_NONE is accepted for states of another state machine and falls back to searching the members.
+	 */
+	bool Contains(const FSMState_Base* State, int32 Index) const;
+	
+	/** Add a state if it isn't a member. */
+	void Add(FSMState_Base* State, int32 Index);
+	void Remove(FSMState_Base* State, int32 Index);
+
+	/** Remove all members without releasing memory. */
+	void Reset();
+
+	int32 Num() const { return NumStates; }
+
+	/** A copy of the members in iteration order. */
+	TArray<FSMState_Base*> Array() const;
+
+	class FConstIterator
+	{
+	public:
+		FConstIterator(const FSMStateSet& InSet, int32 InSlot) : Set(InSet), Slot(InSlot) { SkipEmptySlots(); }
+
+		FSMState_Base* operator*() const { return Set.Slots[Slot].State; }
+		FConstIterator& operator++() { ++Slot; SkipEmptySlots(); return *this; }
+		bool operator!=(const FConstIterator& Other) const { return Slot != Other.Slot; }
+
+	private:
+		void SkipEmptySlots()
+		{
+			while (Slot < Set.Slots.Num() && Set.Slots[Slot].State == nullptr)
+			{
+				++Slot;
+			}
+		}
+
+		const FSMStateSet& Set;
+		int32 Slot;
+	};
+
+	friend FConstIterator begin(const FSMStateSet& Set) { return FConstIterator(Set, 0); }
+	friend FConstIterator end(const FSMStateSet& Set) { return FConstIterator(Set, Set.Slots.Num()); }
+
+private:
+	struct FSlot
+	{
+		FSMState_Base* State;
+
+		/** The state index the member was added with, INDEX_NONE for states of another state machine. */
+		int32 Index;
+	};
+
+	/** Members by slot. Removed members leave an empty slot. */
+	TArray<FSlot, TInlineAllocator<4>> Slots;
+
+	/** Empty slots, the last one is reused first. */
+	TArray<int32, TInlineAllocator<4>> FreeSlots;
+
+	/** Membership by state index. */
+	TBitArray<> Bits;
+
+	/** The slot of each member by state index. Only valid where the membership bit is set. */
+	TArray<int32> SlotsByIndex;
+
+	int32 NumStates;
+};
+
 
 /**
  * State machines contain states and transitions. When a transition succeeds the current state advances to the next.
@@ -77,12 +156,18 @@ public:
 	virtual FSMNode_Base* GetOwnerNode() const override;
 	// ~FSMState_Base
 
+	/** Size the node lists for the nodes about to be added so each is allocated once. */
+	void ReserveNodes(int32 NumStates, int32 NumTransitions, int32 NumGlobalTransitions);
+
 	/** Add a state to this State Machine. */
 	void AddState(FSMState_Base* State);
 
 	/** Add a transition to this State Machine. */
 	void AddTransition(FSMTransition* Transition);
 
+	/** Add a global transition, which is also added as a normal transition. Its states must already be registered with it. */
+	void AddGlobalTransition(FSMTransition* Transition);
+
 	/** The first state to execute. Even with parallel states there is always a single root entry point. */
 	void AddInitialState(FSMState_Base* State);
 
@@ -120,6 +205,23 @@ public:
 	/** Retrieve nodes of only transitions. */
 	const TArray<FSMTransition*>& GetTransitions() const { return Transitions; }
 
+	/** Transitions compiled from Any State nodes which are shared by every state they impact, sorted lowest to highest priority. */
+	const TArray<FSMTransition*>& GetGlobalTransitions() const { return GlobalTransitions; }
+
+	/**
+	 * Evaluate a state's transitions together with the global transitions it can take, in priority order.
+	 * @param State The active state to evaluate from.
+	 * @param Transitions Valid paths in the same format as FSMState_Base::GetValidTransition.
+	 * @return True if a valid path is found.
+	 */
+	bool GetValidTransitionIncludingGlobal(FSMState_Base* State, TArray<TArray<FSMTransition*>>& Transitions);
+
+	/** Initialize global transitions a state can take when it starts. */
+	void NotifyGlobalTransitionsOfStateStart(FSMState_Base* State);
+
+	/** Shutdown global transitions once no state which can take them is active. */
+	void NotifyGlobalTransitionsOfStateEnd(FSMState_Base* State);
+
 	/** Returns only the original entry states. */
 	const TSet<FSMState_Base*>& GetEntryStates() const;
 	
@@ -150,12 +252,15 @@ public:
 	 * @param Transition The transition to process.
 	 * @param Transaction A network transaction if one exists. May be null.
 	 * @param DeltaSeconds The time in seconds since the last update.
-	 * @param CurrentTime The current UTC time. Only utilized in networked environments when checking for expired previous transitions.
+	 * @param CurrentTime The current FPlatformTime::Seconds. Only utilized in networked environments when recording previous transactions.
 	 */
-	bool ProcessTransition(FSMTransition* Transition, const FSMNetworkedTransaction* Transaction, float DeltaSeconds, FDateTime* CurrentTime = nullptr);
+	bool ProcessTransition(FSMTransition* Transition, const FSMNetworkedTransaction* Transaction, float DeltaSeconds, const double* CurrentTime = nullptr);
 
 	/** Check for and remove expired transactions. */
-	void CleanupPreviousTransactions(const FDateTime& CurrentTime, float PreviousTransactionTimeout);
+	void CleanupPreviousTransactions(double CurrentTime, float PreviousTransactionTimeout);
+
+	/** Set the maximum number of previous transactions to remember. Existing records are cleared. */
+	void SetPreviousTransactionCapacity(int32 Capacity);
 	
 	/** State Machine is currently waiting for a transition update from the server. */
 	bool IsWaitingForUpdate() const { return bWaitingForTransitionUpdate; }
@@ -190,7 +295,7 @@ public:
 	bool IsNetworked() const { return AllActiveTransactions != nullptr; }
 
 	/** Accessor for retrieving any previous transactions. */
-	TMap<FGuid, FSMNetworkedTransaction>& GetPreviousTransactions() { return PreviousTransactions; }
+	FSMNetworkedTransactionHistory& GetPreviousTransactions() { return PreviousTransactions; }
 	
 	/**
 	 * Forcibly add an active state.
@@ -207,6 +312,15 @@ public:
 	 * @param bReplicate If this should be replicated.
 	 */
 	void RemoveActiveState(FSMState_Base* State, bool bReplicate = false);
+
+	/** If the state is in this state machine's active list. The state may not have started yet. */
+	bool IsStateInActiveList(FSMState_Base* State) const { return ActiveStates.Contains(State, GetLocalStateIndex(State)); }
+
+	/** Clear the active list without ending any states or sending notifications. Used when restoring a snapshot. */
+	void ClearActiveStatesForSnapshot();
+
+	/** Add to the active list without starting the state or sending notifications. Used when restoring a snapshot. */
+	void AddActiveStateForSnapshot(FSMState_Base* State);
 protected:
 	/**
 	 * Switches the current state and notifies the owning instance.
@@ -215,15 +329,25 @@ protected:
 	 * @param FromState: The state we are switching from. If not null it will be removed from the active list if bStayActiveOnStateChange is false.
 	 */
 	void SetCurrentState(FSMState_Base* ToState, FSMState_Base* FromState);
+
+	/** The index of a state in States for state set membership. INDEX_NONE if the state belongs to another state machine. */
+	int32 GetLocalStateIndex(const FSMState_Base* State) const
+	{
+		const int32 Index = State->GetStateIndex();
+		return States.IsValidIndex(Index) && States[Index] == State ? Index : INDEX_NONE;
+	}
 	
 protected:
 	TArray<FSMState_Base*> States;
 	TArray<FSMTransition*> Transitions;
+
+	/** Subset of Transitions evaluated against whichever state is active. */
+	TArray<FSMTransition*> GlobalTransitions;
+	
 	TArray<FSMNetworkedTransaction>* AllActiveTransactions;
 
-	/* The transaction ID mapped to the transaction. */
-	UPROPERTY(Transient)
-	TMap<FGuid, FSMNetworkedTransaction> PreviousTransactions;
+	/* Transactions already applied by this state machine. */
+	FSMNetworkedTransactionHistory PreviousTransactions;
 
 	/** The default root entry point. */
 	TSet<FSMState_Base*> EntryStates;
@@ -232,10 +356,10 @@ protected:
 	TSet<FSMState_Base*> TemporaryEntryStates;
 
 	/** In most cases this should be of size 0 or 1. Greater than 1 implies the sm is configured for multiple active states */
-	TSet<FSMState_Base*> ActiveStates;
+	FSMStateSet ActiveStates;
 
 	/** Keeps track of states currently processing. Helps with possible infinite recursion when using multiple states that can re-enter each other. */
-	TSet<FSMState_Base*> ProcessingStates;
+	FSMStateSet ProcessingStates;
 	
 	UPROPERTY()
 	UClass* ReferencedStateMachineClass;
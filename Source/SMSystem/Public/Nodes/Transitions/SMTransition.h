@@ -89,6 +89,17 @@ public:
 	/** Guid to the state this transition is leading to. Kismet compiler will convert this into a state link. */
 	UPROPERTY()
 	FGuid ToGuid;
+
+	/**
+	 * Compiled once from an Any State transition. The state machine evaluates it against each active state in GlobalFromGuids
+	 * instead of the states owning a copy of it. FromGuid is not used.
+	 */
+	UPROPERTY()
+	uint32 bIsGlobalTransition: 1;
+
+	/** Guids of the states a global transition can be taken from. */
+	UPROPERTY()
+	TArray<FGuid> GlobalFromGuids;
 	
 	/** The conditional evaluation type which determines the type of evaluation required if any. */
 	UPROPERTY()
@@ -145,6 +156,27 @@ public:
 	/** Sets the state leading to this transition. This will update the state with this transition. */
 	void SetFromState(FSMState_Base* State);
 	void SetToState(FSMState_Base* State);
+
+	/** Register a state a global transition can be taken from. The state doesn't store the transition. */
+	void AddGlobalFromState(FSMState_Base* State);
+
+	/** If this is a global transition which can be taken from the state. */
+	bool CanTransitionFromGlobalState(const FSMState_Base* State) const { return GlobalFromStates.Contains(State); }
+
+	/** Evaluate a global transition from one of its states. GetFromState() returns this state until changed again. */
+	void SetGlobalFromState(FSMState_Base* State);
+
+	/**
+	 * Point a global transition at the first of its states which is active or about to start.
+	 * Used when the transition is taken outside of evaluation, such as from a network transaction.
+	 */
+	bool TrySetGlobalFromActiveState();
+
+	/** Initialize a global transition when the first of its states starts. */
+	void NotifyGlobalFromStateStarted(FSMState_Base* State);
+
+	/** Shutdown a global transition once none of its states are active. */
+	void NotifyGlobalFromStateEnded(FSMState_Base* State);
 	
 #if WITH_EDITORONLY_DATA
 	virtual bool IsDebugActive() const override { return bIsEvaluating ? bIsEvaluating : Super::IsDebugActive(); }
@@ -164,4 +196,10 @@ public:
 private:
 	FSMState_Base* FromState;
 	FSMState_Base* ToState;
+
+	/** States a global transition can be taken from. */
+	TArray<FSMState_Base*> GlobalFromStates;
+
+	/** Number of GlobalFromStates currently active. */
+	int32 NumActiveGlobalFromStates;
 };
\ No newline at end of file
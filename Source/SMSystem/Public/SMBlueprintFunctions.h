@@ -13,7 +13,7 @@ struct SMSYSTEM_API FSMExposedFunctionHandler
 	FSMExposedFunctionHandler()
 		: BoundFunction(NAME_None)
 		  , Function(nullptr)
-		  , OwnerObject(nullptr), bInitialized(false)
+		  , OwnerObject(nullptr), bInitialized(false), bIsNativeFunction(false)
 	{
 	}
 
@@ -36,4 +36,7 @@ private:
 	UObject* OwnerObject;
 
 	bool bInitialized;
+
+	/** Bound to a native function without parameters, such as one from an exported native state machine class. Called without ProcessEvent. */
+	bool bIsNativeFunction;
 };
\ No newline at end of file
@@ -0,0 +1,139 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class ESMDebugEventType : uint8
+{
+	/** A state started or a transition was taken. */
+	Entered,
+	/** A state ended or a transition finished being taken. */
+	Exited,
+	/** A transition or conduit evaluated its conditions. */
+	Evaluated
+};
+
+struct FSMDebugEvent
+{
+	/** The NodeGuid of the runtime node, matching the editor graph node. */
+	FGuid NodeGuid;
+
+	/** The PathGuid of the runtime node. Tells apart runtime nodes sharing a NodeGuid. */
+	FGuid PathGuid;
+
+	/** FPlatformTime::Seconds when the event occurred. */
+	double Time;
+
+	ESMDebugEventType Type;
+};
+
+/**
+ * Fixed size ring buffer of debug events read by any number of consumers, each with its own read index.
+ * Nodes push events as they change on the game thread and each blueprint editor drains them on the game thread.
+ * When a consumer falls more than a full buffer behind the oldest events are overwritten and counted as dropped for that consumer.
+ */
+class FSMDebugEventBuffer
+{
+public:
+	enum { DefaultCapacity = 1024 };
+
+	FSMDebugEventBuffer() : WriteIndex(0)
+	{
+		static_assert((DefaultCapacity & (DefaultCapacity - 1)) == 0, "Capacity must be a power of two.");
+	}
+
+	/** If any consumers are registered. */
+	bool HasConsumers() const { return Consumers.Num() > 0; }
+
+	bool HasConsumer(const void* Consumer) const
+	{
+		return Consumers.ContainsByPredicate([Consumer](const FConsumer& Entry) { return Entry.Consumer == Consumer; });
+	}
+
+	/** Register a consumer. It only receives events pushed after this call. Returns false if already registered. */
+	bool AddConsumer(const void* Consumer)
+	{
+		if (!Consumer || HasConsumer(Consumer))
+		{
+			return false;
+		}
+
+		if (Events.Num() == 0)
+		{
+			Events.SetNum(DefaultCapacity);
+		}
+
+		Consumers.Add({ Consumer, WriteIndex, 0 });
+		return true;
+	}
+
+	void RemoveConsumer(const void* Consumer)
+	{
+		Consumers.RemoveAllSwap([Consumer](const FConsumer& Entry) { return Entry.Consumer == Consumer; });
+		if (Consumers.Num() == 0)
+		{
+			Events.Empty();
+			WriteIndex = 0;
+		}
+	}
+
+	/** Record an event for all consumers. */
+	void Push(const FSMDebugEvent& Event)
+	{
+		if (Consumers.Num() > 0)
+		{
+			Events[WriteIndex & (DefaultCapacity - 1)] = Event;
+			WriteIndex++;
+		}
+	}
+
+	/** Calls Func for each event the consumer hasn't read yet in order and returns the number drained. */
+	template<typename FunctorType>
+	int32 Drain(const void* Consumer, FunctorType&& Func)
+	{
+		FConsumer* Entry = Consumers.FindByPredicate([Consumer](const FConsumer& Other) { return Other.Consumer == Consumer; });
+		if (!Entry)
+		{
+			return 0;
+		}
+
+		// Skip events which have been overwritten.
+		if (WriteIndex - Entry->ReadIndex > static_cast<uint32>(DefaultCapacity))
+		{
+			const uint32 NewReadIndex = WriteIndex - DefaultCapacity;
+			Entry->NumDropped += NewReadIndex - Entry->ReadIndex;
+			Entry->ReadIndex = NewReadIndex;
+		}
+
+		const int32 NumEvents = static_cast<int32>(WriteIndex - Entry->ReadIndex);
+		for (uint32 Read = Entry->ReadIndex; Read != WriteIndex; ++Read)
+		{
+			Func(Events[Read & (DefaultCapacity - 1)]);
+		}
+
+		Entry->ReadIndex = WriteIndex;
+		return NumEvents;
+	}
+
+	/** Events the consumer missed because it fell behind. */
+	uint32 GetNumDropped(const void* Consumer) const
+	{
+		const FConsumer* Entry = Consumers.FindByPredicate([Consumer](const FConsumer& Other) { return Other.Consumer == Consumer; });
+		return Entry ? Entry->NumDropped : 0;
+	}
+
+private:
+	struct FConsumer
+	{
+		const void* Consumer;
+		uint32 ReadIndex;
+		uint32 NumDropped;
+	};
+
+	/** Only allocated while there are consumers. */
+	TArray<FSMDebugEvent> Events;
+	TArray<FConsumer> Consumers;
+
+	/** Free running index of the next event to write. */
+	uint32 WriteIndex;
+};
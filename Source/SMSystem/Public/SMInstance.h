@@ -9,6 +9,10 @@
 #include "SMTransitionInstance.h"
 #include "ISMStateMachineInterface.h"
 #include "SMNode_Info.h"
+#include "SMTickLODProvider.h"
+#include "SMInstanceSnapshot.h"
+#include "SMDebugEventBuffer.h"
+#include "SMNodeStructInstance.h"
 #include "SMInstance.generated.h"
 
 
@@ -19,6 +23,10 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnStateMachineStoppedSignature, cla
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnStateMachineTransitionTakenSignature, class USMInstance*, Instance, struct FSMTransitionInfo, Transition);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnStateMachineStateChangedSignature, class USMInstance*, Instance, struct FSMStateInfo, NewState, struct FSMStateInfo, PreviousState);
 
+/** Native versions of the transition and state change events. They pass the runtime nodes directly so no info structs are built. */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnStateMachineTransitionTakenNativeSignature, class USMInstance* /*Instance*/, const struct FSMTransition& /*Transition*/);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnStateMachineStateChangedNativeSignature, class USMInstance* /*Instance*/, struct FSMState_Base* /*NewState*/, struct FSMState_Base* /*PreviousState*/);
+
 
 USTRUCT()
 struct FSMDebugStateMachine
@@ -28,48 +36,78 @@ struct FSMDebugStateMachine
 #if WITH_EDITORONLY_DATA
 	const FSMNode_Base* GetRuntimeNode(const FGuid& Guid) const
 	{
-		if(const TArray<FSMNode_Base*>* Nodes = MappedNodes.Find(Guid))
+		if(const TArray<FSMNode_Base*>* Nodes = FindRuntimeNodes(Guid))
 		{
-			if (Nodes->Num() == 0)
-			{
-				return nullptr;
-			}
-			
-			if(Nodes->Num() == 1)
+			return ResolveRuntimeNode(*Nodes);
+		}
+
+		return nullptr;
+	}
+
+	/** All runtime nodes mapped to a NodeGuid. The pointer remains valid until the mapping version changes, which happens whenever a node is added or the map is reset. */
+	const TArray<FSMNode_Base*>* FindRuntimeNodes(const FGuid& Guid) const
+	{
+		return MappedNodes.Find(Guid);
+	}
+
+	/** Select the runtime node to display from nodes sharing the same NodeGuid. */
+	static const FSMNode_Base* ResolveRuntimeNode(const TArray<FSMNode_Base*>& Nodes)
+	{
+		if (Nodes.Num() == 0)
+		{
+			return nullptr;
+		}
+
+		if(Nodes.Num() == 1)
+		{
+			return Nodes[0];
+		}
+
+		// In the case of duplicate nodes find the most recent active one.
+		// This can occur when referencing parent state machine nodes multiple times
+		// and from any state transitions.
+		FSMNode_Base* LastActiveNode = nullptr;
+		for(FSMNode_Base* Node : Nodes)
+		{
+			if(Node->IsDebugActive())
 			{
-				return (*Nodes)[0];
+				return Node;
 			}
 
-			// In the case of duplicate nodes find the most recent active one.
-			// This can occur when referencing parent state machine nodes multiple times
-			// and from any state transitions.
-			FSMNode_Base* LastActiveNode = nullptr;
-			for(FSMNode_Base* Node : *Nodes)
+			if(Node->WasDebugActive())
 			{
-				if(Node->IsDebugActive())
-				{
-					return Node;
-				}
-				if(Node->WasDebugActive())
-				{
-					LastActiveNode = Node;
-				}
+				LastActiveNode = Node;
 			}
-
-			return LastActiveNode ? LastActiveNode : (*Nodes)[0];
 		}
 
-		return nullptr;
+		return LastActiveNode ? LastActiveNode : Nodes[0];
+	}
+
+	/** Incremented each time the node map is rebuilt. */
+	uint32 GetMappingVersion() const { return MappingVersion; }
+
+	void ResetMappedNodes()
+	{
+		MappedNodes.Reset();
+		MappingVersion++;
 	}
 
 	void UpdateRuntimeNode(FSMNode_Base* RuntimeNode)
 	{
 		TArray<FSMNode_Base*>& Nodes = MappedNodes.FindOrAdd(RuntimeNode->GetNodeGuid());
-		Nodes.AddUnique(RuntimeNode);
+		if (!Nodes.Contains(RuntimeNode))
+		{
+			// Adding to the map may move existing node lists.
+			Nodes.Add(RuntimeNode);
+			MappingVersion++;
+		}
 	}
 
+private:
 	/** All states including nested state machine states. These are only NodeGuids and not PathGuids. */
 	TMap<FGuid, TArray<FSMNode_Base*>> MappedNodes;
+
+	uint32 MappingVersion = 0;
 #endif
 };
 
@@ -377,6 +415,103 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances")
 	void SetStopOnEndState(bool Value);
 
+	/** The maximum number of transitions each state machine may take in one update. 0 for no limit. */
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances")
+	void SetMaxTransitionsPerUpdate(int32 Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances")
+	int32 GetMaxTransitionsPerUpdate() const { return MaxTransitionsPerUpdate; }
+
+	/**
+	 * Enable or disable fixed time step mode. Applies to all references.
+	 * @param bEnable Use fixed time steps.
+	 * @param StepSeconds The fixed time of each step. Must be greater than 0.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|Fixed Step")
+	void SetUseFixedTimeStep(bool bEnable, float StepSeconds = 0.0333333f);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Logic Driver|State Machine Instances|Fixed Step")
+	bool IsUsingFixedTimeStep() const { return bUseFixedTimeStep; }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Logic Driver|State Machine Instances|Fixed Step")
+	float GetFixedTimeStep() const { return FixedTimeStep; }
+
+	/** The total number of fixed steps this instance has run since it was started. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Logic Driver|State Machine Instances|Fixed Step")
+	int32 GetFixedStepFrame() const { return FixedStepFrame; }
+
+	/**
+	 * Run an exact number of fixed steps, ignoring accumulated time and the substep limit.
+	 * Intended for lockstep simulations where the caller owns the frame count.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|Fixed Step")
+	void AdvanceFixedSteps(int32 NumSteps = 1);
+
+	/**
+	 * Restore the instance to a recorded fixed step frame. Requires fixed time step and rewind to be enabled.
+	 * State begin and end logic is not executed unless bRunStateLogicOnRewind is set.
+	 *
+	 * @param Frame The fixed step frame to restore. Must still be in the rewind buffer.
+	 * @return True if the frame was restored.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|Rewind")
+	bool RewindTo(int32 Frame);
+
+	/** Run fixed steps from the current frame, recording new snapshots over any previous ones. Usually called after RewindTo. */
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|Rewind")
+	void Resimulate(int32 NumFrames);
+
+	/** Enable recording snapshots for rewind. Requires a fixed time step to be set first. */
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|Rewind")
+	void SetRewindEnabled(bool bEnable);
+
+	/** True while Resimulate is running. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Logic Driver|State Machine Instances|Rewind")
+	bool IsResimulating() const { return bIsResimulating; }
+
+	/** Set if Begin, End and transition Entered logic run while resimulating. */
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|Rewind")
+	void SetRunStateLogicOnResimulate(bool bValue) { bRunStateLogicOnResimulate = bValue; }
+
+	/** If node begin, end and entered logic can run. False while the master instance resimulates unless bRunStateLogicOnResimulate is set. */
+	bool CanExecuteStateEventLogic() const;
+
+	/** If a snapshot exists for the given frame. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Logic Driver|State Machine Instances|Rewind")
+	bool CanRewindTo(int32 Frame) const;
+
+	/**
+	 * Force a tick LOD tier. This is normally selected automatically from the TickLODProvider when tick LOD is enabled.
+	 * Applies the tier's tick interval and logic settings to this instance and all references.
+	 *
+	 * @param NewLOD The index into TickLODTiers. INDEX_NONE restores full rate settings.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|LOD")
+	void SetTickLOD(int32 NewLOD);
+
+	/** The current tick LOD tier index. INDEX_NONE if tick LOD isn't in use. */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Logic Driver|State Machine Instances|LOD")
+	int32 GetTickLOD() const { return CurrentTickLOD; }
+
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|LOD")
+	void SetTickLODEnabled(bool Value);
+
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|LOD")
+	bool IsTickLODEnabled() const { return bEnableTickLOD; }
+
+	/** Replace the available LOD tiers. The current tier is cleared and will be recalculated on the next tick. */
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|LOD")
+	void SetTickLODTiers(const TArray<FSMTickLODTier>& NewTiers);
+
+	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances|LOD")
+	const TArray<FSMTickLODTier>& GetTickLODTiers() const { return TickLODTiers; }
+
+	/** If the current tick LOD allows state update graphs to execute. */
+	bool CanExecuteStateUpdateLogicForLOD() const { return bLODAllowsStateUpdateLogic; }
+
+	/** If the current tick LOD allows conditional transitions to be evaluated on tick. */
+	bool CanEvaluateTransitionsOnTickForLOD() const { return bLODAllowsTickTransitionEvaluation; }
+
 	/** True if the root state machine is in an end state. */
 	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances")
 	bool IsInEndState() const;
@@ -424,6 +559,9 @@ public:
 	/** Notifies state machines if they are allowed to execute state logic locally. */
 	void SetAllowStateLogic(bool bAllow);
 
+	/** The maximum number of applied network transactions each state machine remembers. Applied on UpdateNetworkConditions. */
+	void SetPreviousTransactionCapacity(int32 Capacity);
+
 	/** True if the instance has started. */
 	UFUNCTION(BlueprintCallable, Category = "Logic Driver|State Machine Instances")
 	bool HasStarted() const { return R_bHasStarted; }
@@ -440,7 +578,7 @@ public:
 	/** Get the instance owning this reference. If null this is not a reference. */
 	const USMInstance* GetReferenceOwnerConst() const { return ReferenceOwner; }
 
-	/** Look up the owners to find the root. */
+	/** Look up the owners to find the root. Cached when the owner is set. */
 	const USMInstance* GetMasterReferenceOwnerConst() const;
 
 	/** Get the instance owning this reference. If null this is not a reference. */
@@ -520,13 +658,49 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Logic Driver|State Machine Instances")
 	FOnStateMachineStateChangedSignature OnStateMachineStateChangedEvent;
 
+	/** Called when a transition is being taken. Passes the runtime transition directly instead of building an FSMTransitionInfo. */
+	FOnStateMachineTransitionTakenNativeSignature OnStateMachineTransitionTakenNative;
+
+	/** Called when a state machine has switched states. Either state may be null. Passes the runtime states directly instead of building FSMStateInfos. */
+	FOnStateMachineStateChangedNativeSignature OnStateMachineStateChangedNative;
+
 #if WITH_EDITORONLY_DATA
 	FSMDebugStateMachine& GetDebugStateMachine() { return DebugStateMachine; }
 	const FSMDebugStateMachine& GetDebugStateMachineConst() const { return DebugStateMachine; }
 
 	bool IsLoggingEnabled() const { return bEnableLogging; }
+
+	/**
+	 * Begin recording node activity for a consumer such as a blueprint editor. Events are only recorded while a consumer is registered.
+	 * Any number of consumers may record from the same instance and each drains events independently.
+	 * Returns true if the consumer is recording.
+	 */
+	bool StartRecordingDebugEvents(const void* Consumer);
+	void StopRecordingDebugEvents(const void* Consumer);
+	bool IsRecordingDebugEventsFor(const void* Consumer) const { return DebugEvents.HasConsumer(Consumer); }
+
+	/** Called by nodes when their debug state changes. Reference owners display the same nodes so they record the event as well. */
+	void RecordDebugEvent(const FSMNode_Base& Node, ESMDebugEventType Type)
+	{
+		for (USMInstance* Instance = this; Instance; Instance = Instance->ReferenceOwner)
+		{
+			if (Instance->DebugEvents.HasConsumers())
+			{
+				Instance->DebugEvents.Push({ Node.GetNodeGuid(), Node.GetGuid(), FPlatformTime::Seconds(), Type });
+			}
+		}
+	}
+
+	/** Consumers drain the buffer with their own read index. */
+	FSMDebugEventBuffer& GetDebugEventBuffer() { return DebugEvents; }
 #endif
 
+	/**
+	 * Construct a native struct in place of a node instance. It is destroyed when the instance shuts down.
+	 * Returns null if the struct memory wasn't sized for the node, in which case a node instance should be created.
+	 */
+	FSMNodeStructInstance* CreateNodeStructInstance(FSMNode_Base& Node, const FSMNodeStructRegistry::FEntry& Entry);
+
 protected:
 	virtual void Tick_Implementation(float DeltaTime);
 	virtual void OnStateMachineInitialized_Implementation();
@@ -536,6 +710,9 @@ protected:
 	virtual void OnStateMachineTransitionTaken_Implementation(const FSMTransitionInfo& Transition);
 	virtual void OnStateMachineStateChanged_Implementation(const FSMStateInfo& ToState, const FSMStateInfo& FromState);
 	
+	/** Cache the master reference owner for this instance and every reference it owns. */
+	void RefreshMasterReferenceOwner();
+	
 	/** Internal update logic. Can be called during an update and used by event triggers. */
 	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "Logic Driver|State Machine Instances")
 	void Internal_Update(float DeltaSeconds);
@@ -543,7 +720,20 @@ protected:
 	/** Internal cleanup logic after an auto-bound event fires. */
 	UFUNCTION(BlueprintCallable, BlueprintInternalUseOnly, Category = "Logic Driver|State Machine Instances")
 	void Internal_EventCleanup(const FGuid& NodeGuid);
+
+	/** Internal check for persistent auto-bound events. True while the node's owning state is active and its transition events should fire. */
+	UFUNCTION(BlueprintPure, BlueprintInternalUseOnly, Category = "Logic Driver|State Machine Instances")
+	bool Internal_IsTransitionEventActive(const FGuid& NodeGuid) const;
+
+	/** Run the instance initialized or shutdown nodes of every node this instance owns. References handle their own. */
+	void ExecuteInstanceNodes(bool bInitialize);
 	
+	/** Size the guid maps for this class's nodes so BuildStateMachineMap doesn't rehash while filling them. */
+	void ReserveNodeMaps(const TSet<FStructProperty*>& Properties);
+
+	/** Empty the guid maps on shutdown, keeping their memory for the next initialize. */
+	void ResetNodeMaps();
+
 	/** Assemble a complete map of all nested nodes and state machines. Builds out GuidNodeMap and StateMachineGuids. InstancesMapped keeps track
 	 * of all instances built to prevent stack overflow in the event of state machine references that self reference. */
 	void BuildStateMachineMap(FSMStateMachine* StateMachine, TSet<USMInstance*>& InstancesMapped);
@@ -556,6 +746,32 @@ protected:
 
 	/** Update replicate states if configured. */
 	void ReplicateStates();
+
+	/** Accumulate time and run as many fixed steps as allowed. */
+	void UpdateFixedTimeStep(float DeltaSeconds);
+
+	/** Run a single fixed step. */
+	void RunFixedStep();
+
+	/** Index all states and transitions for snapshots and allocate the rewind buffer. */
+	void InitializeRewind();
+
+	/** Record the current frame into the rewind buffer. */
+	void RecordSnapshot();
+
+	/** Restore all states and transitions to the snapshot. */
+	void ApplySnapshot(const FSMInstanceSnapshot& Snapshot);
+	
+	/** Select a new tick LOD tier from the provider if enough time has passed. */
+	void UpdateTickLOD(float DeltaTime);
+
+	/** Pick the tier for the given distance, applying hysteresis against the current tier. */
+	int32 CalculateTickLOD(float Distance) const;
+
+	void SortTickLODTiers();
+
+	/** Set the LOD logic flags for this instance and all references. */
+	void SetLODLogicAllowed(bool bAllowStateUpdateLogic, bool bAllowTickTransitionEvaluation);
 	
 	void DoStart();
 
@@ -602,6 +818,12 @@ protected:
 	UPROPERTY()
 	USMInstance* ReferenceOwner;
 
+	/**
+	 * The top most reference owner, set with the owner. Nested references are created before their owner is assigned its own owner
+	 * so this is refreshed down the reference hierarchy. Not a property so duplicates fall back to looking up the owners.
+	 */
+	USMInstance* MasterReferenceOwner;
+
 	/** The custom node instance class to use for this state machine. This is not the same as USMInstance. */
 	UPROPERTY(meta = (BlueprintBaseOnly, DisplayName = "Node Class"))
 	TSubclassOf<class USMStateMachineInstance> StateMachineClass;
@@ -613,6 +835,13 @@ protected:
 	/** Should this instance stop itself once an end state has been reached. An Update call is required for this to occur. */
 	UPROPERTY(EditAnywhere, Category = "State Machine Instance")
 	bool bStopOnEndState = false;
+
+	/**
+	 * The maximum number of transitions each state machine may take in one update. Transitions which pass immediately are otherwise
+	 * followed until a state doesn't transition. Once reached the active states wait for the next update to continue. 0 for no limit.
+	 */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance", meta = (ClampMin = "0"))
+	int32 MaxTransitionsPerUpdate = 0;
 	
 	/** Should this instance tick. By default it will update the state machine. */
 	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Tick")
@@ -640,6 +869,64 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "State Machine Instance|Tick", meta = (EditCondition = "bTickRegistered"))
 	bool bTickBeforeInitialize;
 
+	/**
+	 * Adjust tick rate and logic execution based on the significance of this instance.
+	 * Significance is calculated by the TickLODProvider and matched against TickLODTiers.
+	 */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Tick|LOD", meta = (EditCondition = "bCanEverTick"))
+	bool bEnableTickLOD = false;
+
+	/** Available LOD tiers. Sorted by MinDistance on initialize. The first tier should generally have a MinDistance of 0. */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Tick|LOD", meta = (EditCondition = "bEnableTickLOD"))
+	TArray<FSMTickLODTier> TickLODTiers;
+
+	/** Calculates the significance distance. Defaults to the distance to the nearest local player view point. */
+	UPROPERTY(EditAnywhere, Instanced, Category = "State Machine Instance|Tick|LOD", meta = (EditCondition = "bEnableTickLOD"))
+	USMTickLODProvider* TickLODProvider;
+
+	/** Distance past a tier boundary required before switching tiers. Prevents rapid switching near boundaries. */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Tick|LOD", meta = (EditCondition = "bEnableTickLOD", ClampMin = "0.0"))
+	float TickLODHysteresis = 200.f;
+
+	/** Time in seconds between significance calculations. 0 calculates every tick. */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Tick|LOD", meta = (EditCondition = "bEnableTickLOD", ClampMin = "0.0"))
+	float TickLODUpdateInterval = 0.5f;
+
+	/**
+	 * Advance the state machine in exact fixed increments rather than variable delta seconds.
+	 * Time in state is tracked as an integer step count so transitions are reproducible across machines.
+	 * Event based transitions are processed on the next fixed step.
+	 */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Fixed Step")
+	bool bUseFixedTimeStep = false;
+
+	/** Time in seconds of each fixed step. */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Fixed Step", meta = (EditCondition = "bUseFixedTimeStep", ClampMin = "0.001"))
+	float FixedTimeStep = 0.0333333f;
+
+	/** The maximum fixed steps to run in a single update. Time beyond this is discarded to prevent runaway catch up. */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Fixed Step", meta = (EditCondition = "bUseFixedTimeStep", ClampMin = "1"))
+	int32 MaxFixedSubsteps = 4;
+
+	/** Record a snapshot every fixed step so the instance can be rewound and resimulated. Requires a fixed time step. */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Fixed Step", meta = (EditCondition = "bUseFixedTimeStep"))
+	bool bEnableRewind = false;
+
+	/** The number of frames which can be rewound. */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Fixed Step", meta = (EditCondition = "bEnableRewind", ClampMin = "1"))
+	int32 RewindBufferSize = 32;
+
+	/** Run End logic for states exited by a rewind and Begin logic for states entered. Nested state machines are always restored directly. */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Fixed Step", meta = (EditCondition = "bEnableRewind"))
+	bool bRunStateLogicOnRewind = false;
+
+	/**
+	 * Run Begin, End and transition Entered logic while resimulating. Off by default as those already ran for the original frames.
+	 * Update logic and transition evaluation always run. Instance state change events still fire.
+	 */
+	UPROPERTY(EditAnywhere, Category = "State Machine Instance|Fixed Step", meta = (EditCondition = "bEnableRewind"))
+	bool bRunStateLogicOnResimulate = false;
+
 #if WITH_EDITORONLY_DATA
 	/** Enable info logging for the state machine. */
 	UPROPERTY(EditDefaultsOnly, Category = "State Machine Instance|Logging")
@@ -656,6 +943,10 @@ protected:
 	
 	UPROPERTY(Transient)
 	float MaxTimeToWaitForUpdate;
+
+	/** 0 uses the default capacity. */
+	UPROPERTY(Transient)
+	int32 PreviousTransactionCapacity;
 	
 	/** Time since the last valid tick occurred. */
 	UPROPERTY()
@@ -692,6 +983,34 @@ protected:
 	UPROPERTY(Transient, ReplicatedUsing = REP_StartChanged)
 	uint32 R_bHasStarted: 1;
 
+	/** If the current tick LOD allows state update graphs to execute. */
+	UPROPERTY(Transient)
+	uint32 bLODAllowsStateUpdateLogic: 1;
+
+	/** If the current tick LOD allows conditional transitions to be evaluated on tick. */
+	UPROPERTY(Transient)
+	uint32 bLODAllowsTickTransitionEvaluation: 1;
+
+	/** The active index of TickLODTiers. */
+	UPROPERTY(Transient)
+	int32 CurrentTickLOD;
+
+	/** The tick interval set before any tick LOD was applied. */
+	UPROPERTY(Transient)
+	float TickIntervalBeforeLOD;
+
+	/** Time since the tick LOD was last calculated. */
+	UPROPERTY(Transient)
+	float TimeSinceTickLODUpdate;
+
+	/** Unconsumed time waiting for a full fixed step. */
+	UPROPERTY(Transient)
+	float FixedStepAccumulator;
+
+	/** Fixed steps run since start. */
+	UPROPERTY(Transient)
+	int32 FixedStepFrame;
+
 public:
 	/*
 	 * Archetype objects used for instantiating references. Only valid from the CDO.
@@ -705,7 +1024,42 @@ public:
 private:
 	bool bInitialized = false;
 
+	/** If the class may handle OnStateMachineStateChanged, in which case FSMStateInfo is always built. Set on initialize. */
+	bool bStateChangedEventOverridden = true;
+
+	/** If the class may handle OnStateMachineTransitionTaken, in which case FSMTransitionInfo is always built. Set on initialize. */
+	bool bTransitionTakenEventOverridden = true;
+
+	/** True during Resimulate. */
+	bool bIsResimulating = false;
+
+	/** Ring buffer of snapshots indexed by frame. */
+	TArray<FSMInstanceSnapshot> RewindBuffer;
+
+	/** Stable indexing of all states for snapshots. */
+	TArray<FSMState_Base*> RewindStates;
+
+	/** Stable indexing of all transitions for snapshots. */
+	TArray<FSMTransition*> RewindTransitions;
+
+	/** Allocate one block sized for the structs of every node of this instance using a registered class. Called before nodes initialize. */
+	void AllocateNodeStructMemory();
+	
+	/** Destroy node struct instances and release their memory at once. */
+	void DestroyNodeStructInstances();
+
+	/** Node struct instances are constructed here so they're contiguous and freed together. */
+	uint8* NodeStructMemory;
+	int32 NodeStructMemorySize;
+	int32 NodeStructMemoryUsed;
+
+	/** Struct instances in NodeStructMemory in construction order with the node using each. */
+	TArray<TPair<FSMNode_Base*, FSMNodeStructInstance*>> NodeStructInstances;
+
 #if WITH_EDITORONLY_DATA
 	FSMDebugStateMachine DebugStateMachine;
+
+	/** Node activity drained by blueprint editors. */
+	FSMDebugEventBuffer DebugEvents;
 #endif
 };
\ No newline at end of file
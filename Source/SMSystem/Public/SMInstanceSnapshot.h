@@ -0,0 +1,40 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Compact record of a single active state. */
+struct FSMStateSnapshot
+{
+	/** Index into the instance's rewind state list. */
+	int32 StateIndex;
+
+	float TimeInState;
+	int32 FixedStepsInState;
+	bool bHasUpdated;
+
+	/** False when the state is in the active list but hasn't started yet. */
+	bool bIsActive;
+};
+
+/** Compact record of all active states and pending event flags for a single fixed step frame. */
+struct FSMInstanceSnapshot
+{
+	FSMInstanceSnapshot() : Frame(INDEX_NONE) {}
+
+	/** The fixed step frame this snapshot was recorded at. INDEX_NONE if unused. */
+	int32 Frame;
+
+	/** Every active state including nested states and references. */
+	TArray<FSMStateSnapshot> ActiveStates;
+
+	/** Indices into the instance's rewind transition list which had an event pending. */
+	TArray<int32> EventTransitions;
+
+	void Reset()
+	{
+		Frame = INDEX_NONE;
+		ActiveStates.Reset();
+		EventTransitions.Reset();
+	}
+};
@@ -8,6 +8,21 @@
 #include "Engine/ActorChannel.h"
 #include "SMStateMachineComponent.generated.h"
 
+class USMStateMachineComponent;
+
+/** Client transactions of one component sent as part of a batch for the owning actor. */
+USTRUCT()
+struct FSMComponentTransactionBatch
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	USMStateMachineComponent* Component = nullptr;
+
+	UPROPERTY()
+	TArray<FSMNetworkedTransaction> Transactions;
+};
+
 /**
  * Actor Component wrapper for a State Machine Instance. Supports Replication. Will default state machine context to the owning actor of this component.
  * Call Start() when ready.
@@ -36,6 +51,13 @@ public:
 	virtual void OnComponentDestroyed(bool bDestroyingHierarchy) override;
 	// ~ UActorComponent
 
+	/** Hook client transaction batching into world ticks. Called by the module on startup and shutdown. */
+	static void RegisterTransactionBatching();
+	static void UnregisterTransactionBatching();
+
+	/** The number of components in a world with client transactions waiting for the next batch. */
+	static int32 GetNumComponentsPendingBatch(const UWorld* World);
+
 	// ISMStateMachineInstance
 
 	/**
@@ -137,11 +159,9 @@ protected:
 	UFUNCTION()
 	void Internal_OnStateMachineStopped(USMInstance* Instance);
 
-	UFUNCTION()
-	void Internal_OnStateMachineTransitionTaken(USMInstance* Instance, FSMTransitionInfo Transition);
-
-	UFUNCTION()
-	void Internal_OnStateMachineStateChanged(USMInstance* Instance, FSMStateInfo ToState, FSMStateInfo FromState);
+	/** Bound to the native instance events. The info structs are only built when the component's events are bound. */
+	void Internal_OnStateMachineTransitionTaken(USMInstance* Instance, const FSMTransition& Transition);
+	void Internal_OnStateMachineStateChanged(USMInstance* Instance, FSMState_Base* ToState, FSMState_Base* FromState);
 	
 	/** Called after the state machine has initialized either locally or by replication. */
 	virtual void PostInitialize();
@@ -153,6 +173,13 @@ protected:
 	/** Configure instance specific network properties. */
 	virtual void ConfigureInstanceNetworkSettings();
 
+	/**
+	 * Enable the component tick only while there is work for it. Disabled when there is no instance, the instance manages its own tick,
+	 * the network configuration prevents ticking, or the instance isn't running and doesn't override Tick. A blueprint tick on the
+	 * component keeps it enabled.
+	 */
+	void RefreshComponentTickEnabled(bool bInstanceRunning);
+
 #if WITH_EDITOR
 	/** Initialize the USMInstance template based on the current StateMachineClass. */
 	void InitInstanceTemplate();
@@ -173,6 +200,37 @@ protected:
 
 	/* Removes all replicated transitions that have expired. */
 	void RemoveExpiredTransactions(const FDateTime& CurrentTime);
+
+	/** Server handling of transactions sent by the owning client, either directly or through a batch. */
+	void ServerProcessClientTransactions(const TArray<FSMNetworkedTransaction>& Transactions);
+
+	/** If batched transactions are sent with the unreliable RPC. */
+	bool ShouldSendTransactionsUnreliable() const;
+
+	/** Queue client transactions to be sent with the batch for the owning actor on the next net update. */
+	void QueueTransactionsForBatch(const TArray<FSMNetworkedTransaction>& Transactions);
+
+	/**
+	 * Send the queued transactions of every batching component in the world as one RPC per actor. Called after actors tick.
+	 * An actor sends at most once every 1 / NetUpdateFrequency seconds, and not at all while the connection to the server is saturated.
+	 * Transactions queued in between are added to the actor's next batch.
+	 */
+	static void FlushTransactionBatches(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/** Server check if a client transaction was already received. Redundant unreliable batches resend transactions. */
+	bool HasReceivedTransaction(const FSMNetworkedTransaction& Transaction) const;
+
+	/**
+	 * Server check if a predicted transition is valid for the authoritative state. The from state must be active, the transition
+	 * must be able to be taken and the transaction not already received. The transition's condition is never run here.
+	 */
+	bool CanAcceptPredictedTransaction(const FSMNetworkedTransaction& Transaction) const;
+
+	/** Client removal of pending predictions up to and including the key. */
+	void ConfirmPredictedTransactions(int32 PredictionKey);
+
+	/** Client rollback of mispredicted transitions. Ends states the server doesn't have active and activates the server's states. */
+	void ReconcileToStates(const TArray<FGuid>& AuthoritativeStates);
 	
 //#pragma region Server Implementations
 	/** Signal the server to initialize state machine. */
@@ -199,6 +257,22 @@ protected:
 	UFUNCTION(Server, Reliable, WithValidation)
 	void SERVER_ProcessTransaction(const TArray<FSMNetworkedTransaction>& Transactions);
 
+	/** Signal the server of changing transitions for several components on the owning actor. */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void SERVER_ProcessTransactionBatch(const TArray<FSMComponentTransactionBatch>& Batches);
+
+	/** Unreliable version of SERVER_ProcessTransactionBatch. Each transaction is sent redundantly in later batches. */
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void SERVER_ProcessTransactionBatchUnreliable(const TArray<FSMComponentTransactionBatch>& Batches);
+
+	/**
+	 * Signal the owning client a predicted transition was rejected. All later predictions are rejected as well.
+	 * Reliable because this is the only correction a mispredicting client receives. Replicated active states are only applied on load,
+	 * so nothing else would bring the client back in line. It is sent at most once per rejected batch.
+	 */
+	UFUNCTION(Client, Reliable)
+	void CLIENT_RejectPredictedTransactions(int32 PredictionKey, const TArray<FGuid>& AuthoritativeStates);
+
 	/** When the StateMachineInstance is loaded from the server. */
 	UFUNCTION()
 	virtual void REP_OnInstanceLoaded();
@@ -263,6 +337,13 @@ public:
 	 */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, AdvancedDisplay, Category = "Network", meta = (EditCondition = "bReplicates", ClampMin="0.0"))
 	float TransitionResetTimeSeconds;
+
+	/**
+	 * The maximum number of applied transitions each state machine remembers to prevent taking them twice. Entries expire after
+	 * TransitionResetTimeSeconds. When full the oldest entry is discarded, so this should exceed the transitions taken within the reset time.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, AdvancedDisplay, Category = "Network", meta = (EditCondition = "bReplicates", ClampMin="1"))
+	int32 PreviousTransactionCapacity;
 	
 	/**
 	 * When the instance is initially replicated this will load current active states instead of the initial state. It is likely these match.
@@ -285,6 +366,32 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, AdvancedDisplay, Category = "Network", meta = (EditCondition = "bTakeTransitionsFromServerOnly") )
 	float MaxTimeToWaitForTransitionUpdate;
 
+	/**
+	 * The owning client takes transitions immediately and tags them with a prediction key. The server validates each predicted transition
+	 * against its own active states. Accepted transitions replicate normally while rejected transitions are rolled back on the client
+	 * to the server's active states. Overrides bTakeTransitionsFromServerOnly for the owning client.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Network", meta = (EditCondition = "bReplicates"))
+	bool bPredictTransitions;
+
+	/**
+	 * Client transactions of every batching component on the owning actor are sent to the server as one RPC per net update of the actor,
+	 * rather than one reliable RPC for each component update with a transaction.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, AdvancedDisplay, Category = "Network", meta = (EditCondition = "bReplicates"))
+	bool bBatchClientTransactions;
+
+	/**
+	 * Send batched transactions with an unreliable RPC. Each transaction is repeated in the following batches to survive packet loss
+	 * and the server discards copies it already received. Only suitable for non-critical state machines. Ignored when predicting transitions.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, AdvancedDisplay, Category = "Network", meta = (EditCondition = "bBatchClientTransactions"))
+	bool bSendBatchedTransactionsUnreliable;
+
+	/** The number of additional batches an unreliable transaction is repeated in. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, AdvancedDisplay, Category = "Network", meta = (EditCondition = "bSendBatchedTransactionsUnreliable", ClampMin = "0"))
+	int32 UnreliableRedundantSends;
+
 	/** Automatically initialize the state machine when the component begins play. This will set State Machine Context to the owning actor of this component. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "State Machine Components", meta = (ExposeOnSpawn = true))
 	bool bInitializeOnBeginPlay;
@@ -305,6 +412,25 @@ protected:
 	/** Transitions which couldn't be processed yet. */
 	UPROPERTY(Transient)
 	TArray<FSMNetworkedTransaction> PendingTransactions;
+
+	/** Transitions the owning client has predicted which the server hasn't confirmed yet. */
+	UPROPERTY(Transient)
+	TArray<FSMNetworkedTransaction> PendingPredictions;
+
+	struct FQueuedTransaction
+	{
+		FSMNetworkedTransaction Transaction;
+
+		/** Batches this transaction is still sent in. */
+		int32 SendsRemaining;
+	};
+
+	/** Client transactions waiting for the next batch. */
+	TArray<FQueuedTransaction> QueuedBatchTransactions;
+
+	/** The last prediction key assigned by the owning client. */
+	UPROPERTY(Transient)
+	int32 LastPredictionKey;
 	
 	/** The actual state machine instance. */
 	UPROPERTY(Transient, ReplicatedUsing = REP_OnInstanceLoaded, meta=(DisplayName = Instance))
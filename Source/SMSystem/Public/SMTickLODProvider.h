@@ -0,0 +1,77 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "SMTickLODProvider.generated.h"
+
+class USMInstance;
+
+/**
+ * A single level of detail for a ticking state machine instance. Tiers are selected by comparing the significance distance
+ * from a USMTickLODProvider against MinDistance. The tier with the largest MinDistance not exceeding the distance is used.
+ */
+USTRUCT(BlueprintType)
+struct SMSYSTEM_API FSMTickLODTier
+{
+	GENERATED_USTRUCT_BODY()
+
+	FSMTickLODTier() : MinDistance(0.f), TickInterval(0.f), bRunStateUpdateLogic(true), bEvaluateTransitionsOnTick(true) {}
+
+	/** The distance at which this tier becomes active. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LOD", meta = (ClampMin = "0.0"))
+	float MinDistance;
+
+	/** Time in seconds between native ticks while in this tier. Replaces the instance TickInterval. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LOD", meta = (ClampMin = "0.0"))
+	float TickInterval;
+
+	/** Execute the Update graphs of states while in this tier. Time in state is always recorded. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LOD")
+	bool bRunStateUpdateLogic;
+
+	/**
+	 * Evaluate conditional transitions on tick while in this tier. Transitions triggered from events
+	 * and manual calls to EvaluateTransitions are still processed.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LOD")
+	bool bEvaluateTransitionsOnTick;
+};
+
+/**
+ * Calculates the significance of a state machine instance for tick LOD selection.
+ * Lower values are more significant. Override CalculateLODDistance to provide custom significance.
+ */
+UCLASS(Abstract, Blueprintable, BlueprintType, EditInlineNew, DefaultToInstanced, classGroup = "State Machine", meta = (DisplayName = "State Machine Tick LOD Provider"))
+class SMSYSTEM_API USMTickLODProvider : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Calculate the significance distance of the instance. This is compared against the MinDistance of each FSMTickLODTier.
+	 * @param Instance The state machine instance being evaluated.
+	 * @return The distance used to select a tier.
+	 */
+	UFUNCTION(BlueprintNativeEvent, Category = "Logic Driver|State Machine Instances|LOD")
+	float CalculateLODDistance(USMInstance* Instance) const;
+
+protected:
+	virtual float CalculateLODDistance_Implementation(USMInstance* Instance) const;
+};
+
+/**
+ * Default LOD provider. Uses the distance from the instance context to the nearest local player view point.
+ * When there are no local players, such as on a dedicated server, all player view points are considered.
+ */
+UCLASS(classGroup = "State Machine", meta = (DisplayName = "View Distance"))
+class SMSYSTEM_API USMTickLODProvider_ViewDistance : public USMTickLODProvider
+{
+	GENERATED_BODY()
+
+protected:
+	virtual float CalculateLODDistance_Implementation(USMInstance* Instance) const override;
+
+	/** Find the actor representing the location of the instance. Checks the context and then the component owner. */
+	virtual AActor* FindLocationActor(USMInstance* Instance) const;
+};
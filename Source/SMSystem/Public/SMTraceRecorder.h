@@ -0,0 +1,215 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/Atomic.h"
+
+class USMInstance;
+struct FSMNode_Base;
+
+enum class ESMTraceEventType : uint8
+{
+	StateEntered,
+	/** Duration is the time spent in the state. */
+	StateExited,
+	TransitionTaken
+};
+
+/**
+ * Trace file layout. All values are little endian.
+ *
+ * Header:	uint32 Magic, uint32 Version, int64 StartTime (UTC ticks)
+ * Records:	uint8 RecordType followed by
+ *			Instance:	uint32 InstanceId, FString ClassPath, FString Name
+ *			Node:		uint32 InstanceId, uint16 NodeIndex, FGuid NodeGuid, FString NodeName
+ *			Event:		uint8 EventType, uint32 InstanceId, uint16 NodeIndex, double Time, float Duration
+ *
+ * Instance and node records are written once. Each thread buffers its own events, so records from
+ * different threads may be interleaved in any order and are resolved once the whole trace is loaded.
+ * Event time is in seconds since recording started.
+ */
+namespace SMTraceFormat
+{
+	static constexpr uint32 Magic = 0x52544D53; // SMTR
+	static constexpr uint32 Version = 2;
+
+	enum ERecordType : uint8
+	{
+		Record_Instance,
+		Record_Node,
+		Record_Event
+	};
+
+	/** Bytes written for a single event record. */
+	static constexpr int32 EventRecordSize = sizeof(uint8) * 2 + sizeof(uint32) + sizeof(uint16) + sizeof(double) + sizeof(float);
+}
+
+/**
+ * Opt-in recorder writing state machine activity of all instances to a binary trace file.
+ * Each recording thread writes events to its own buffer without locking. Full buffers are handed to a background thread
+ * which writes them to disk. Memory use is bounded by the buffer size per thread plus a fixed number of buffers waiting to
+ * be written, and events are dropped while the writer falls behind. Recording stops once the maximum file size is reached.
+ *
+ * Start with -SMTrace on the command line or the console commands sm.Trace.Start [File] and sm.Trace.Stop.
+ */
+class SMSYSTEM_API FSMTraceRecorder
+{
+public:
+	enum
+	{
+		DefaultBufferSize = 64 * 1024,
+		DefaultMaxFileSize = 256 * 1024 * 1024,
+		/** Full buffers which may wait for the writer before events are dropped. */
+		MaxPendingBuffers = 16
+	};
+
+	static FSMTraceRecorder& Get();
+
+	/** Fast check for call sites. */
+	static bool IsRecording() { return bIsRecording; }
+
+	/** Begin writing a new trace, stopping any current trace. An empty path uses Saved/Traces. */
+	bool StartRecording(const FString& FilePath = FString(), int32 BufferSize = DefaultBufferSize, int64 MaxFileSize = DefaultMaxFileSize);
+
+	/** Write all buffered events and close the current trace. */
+	void StopRecording();
+
+	/** Record an event for the node's owning instance. Safe to call from any thread. */
+	void RecordEvent(const FSMNode_Base& Node, ESMTraceEventType Type, float Duration = 0.f);
+
+	/** Forget an instance so its memory may be reused by a new instance. */
+	void RemoveInstance(const USMInstance* Instance);
+
+	const FString& GetFilePath() const { return FilePath; }
+	int64 GetNumEventsRecorded() const { return NumEventsRecorded; }
+	int64 GetNumEventsDropped() const { return NumEventsDropped; }
+
+	/** Default location for new traces. */
+	static FString GetDefaultTraceDirectory();
+
+private:
+	FSMTraceRecorder();
+	~FSMTraceRecorder();
+
+	struct FNodeId
+	{
+		uint32 InstanceId;
+		uint16 NodeIndex;
+	};
+
+	struct FInstanceEntry
+	{
+		uint32 InstanceId;
+		TMap<const FSMNode_Base*, uint16> NodeIndices;
+	};
+
+	/** Events recorded by one thread. */
+	struct FThreadBuffer
+	{
+		/** Only contended when recording stops. */
+		FCriticalSection CriticalSection;
+		TArray<uint8> Data;
+
+		/** Ids of nodes this thread has recorded. Cleared when the recorder's generation changes. */
+		TMap<const FSMNode_Base*, FNodeId> NodeIds;
+		uint32 Generation = 0;
+	};
+
+	FThreadBuffer& GetThreadBuffer();
+
+	/** Find or assign the id of a node, writing its instance and node records the first time. */
+	bool FindOrAddNode(const FSMNode_Base& Node, FNodeId& OutNodeId);
+
+	/** Append a record written while holding the lock. */
+	void AppendMetadata(const TArray<uint8>& Record);
+
+	/** Hand a full buffer to the writer. Returns false if it was dropped because the writer is behind or the file is full. */
+	bool SubmitBuffer(TArray<uint8>& Data);
+
+	template<typename T>
+	static void WriteValue(TArray<uint8>& Data, const T& Value)
+	{
+		Data.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+private:
+	static bool bIsRecording;
+
+	/** Guards instance and node registration, metadata, and the list of thread buffers. Not taken for events of known nodes. */
+	FCriticalSection CriticalSection;
+
+	TUniquePtr<FArchive> FileWriter;
+	TUniquePtr<class FSMTraceWriter> Writer;
+	FString FilePath;
+	int32 MaxBufferSize;
+	int64 MaxFileSize;
+
+	/** Bytes handed to the writer, including those not yet on disk. */
+	TAtomic<int64> BytesSubmitted;
+
+	double StartTime;
+	uint32 NextInstanceId;
+
+	TMap<const USMInstance*, FInstanceEntry> Instances;
+	TArray<uint8> MetadataBuffer;
+
+	/** Thread buffers are kept for the life of the recorder since threads hold on to them. */
+	TArray<TUniquePtr<FThreadBuffer>> ThreadBuffers;
+	uint32 ThreadBufferTlsSlot;
+
+	/** Incremented when node ids may no longer be valid. */
+	TAtomic<uint32> Generation;
+
+	TAtomic<int64> NumEventsRecorded;
+	TAtomic<int64> NumEventsDropped;
+};
+
+struct FSMTraceInstance
+{
+	uint32 InstanceId;
+	FString ClassPath;
+	FString Name;
+};
+
+struct FSMTraceNode
+{
+	uint32 InstanceId;
+	uint16 NodeIndex;
+	FGuid NodeGuid;
+	FString NodeName;
+};
+
+struct FSMTraceEvent
+{
+	uint32 InstanceId;
+	uint16 NodeIndex;
+	ESMTraceEventType Type;
+	double Time;
+	float Duration;
+};
+
+/** A trace file loaded into memory for replay. */
+struct SMSYSTEM_API FSMTrace
+{
+	TArray<FSMTraceInstance> Instances;
+	TArray<FSMTraceNode> Nodes;
+
+	/** Events ordered by time. */
+	TArray<FSMTraceEvent> Events;
+
+	FDateTime StartTime;
+
+	bool LoadFromFile(const FString& InFilePath);
+	void Reset();
+
+	const FSMTraceNode* FindNode(uint32 InstanceId, uint16 NodeIndex) const;
+
+	/** Time of the last event. */
+	double GetDuration() const { return Events.Num() > 0 ? Events.Last().Time : 0.0; }
+
+private:
+	static uint64 MakeNodeKey(uint32 InstanceId, uint16 NodeIndex) { return (static_cast<uint64>(InstanceId) << 16) | NodeIndex; }
+
+	TMap<uint64, int32> NodeLookup;
+};
@@ -59,12 +59,34 @@ public:
 	/** Iterates through all functions executing them. */
 	static void ExecuteGraphFunctions(TArray<FSMExposedFunctionHandler>& GraphFunctions);
 	
-	/** Search up parents for a default sub objects for a template. */
+	/**
+	 * Search up parents for a default sub objects for a template.
+	 * The templates of each class are gathered once and looked up by name afterward.
+	 */
 	static UObject* FindTemplateFromInstance(USMInstance* Instance, const FName& TemplateName);
 
-	/** Find all reference templates from an instance. Nested children shouldn't be found after a compile or during run-time! */
+	/**
+	 * Find all reference templates from an instance. Nested children shouldn't be found after a compile or during run-time!
+	 * Class default objects read from the class template cache.
+	 */
 	static bool TryGetAllReferenceTemplatesFromInstance(USMInstance* Instance, TSet<USMInstance*>& TemplatesOut, bool bIncludeNested = false);
 
+	/** Clear cached templates. Call when a class has been recompiled or reloaded. Null clears every class. */
+	static void InvalidateTemplateCache(const UClass* Class = nullptr);
+
+	/** If the templates of the class are cached and were gathered from the current class default objects of the class and its parents. */
+	static bool IsTemplateCached(const UClass* Class);
+
+	/** Remove cached templates of garbage collected classes after each collection. Called by the module. */
+	static void RegisterTemplateCacheCleanup();
+	static void UnregisterTemplateCacheCleanup();
+
+	/**
+	 * If a class may implement a function declared on BaseClass. Native overrides can't be found through reflection
+	 * so any native class between the class and BaseClass is assumed to override it.
+	 */
+	static bool IsFunctionOverridden(const UClass* Class, const UClass* BaseClass, const FName& FunctionName);
+
 	/** Iterate properties of an instance finding all structs derived from the given type (such as FSMNode_Base). */
 	template<typename T>
 	static bool TryGetAllRuntimeNodesFromInstance(USMInstance* Instance, TSet<T*>& NodesOut)
@@ -34,3 +34,28 @@ void USMStateMachineTestComponent::ImportDeprecatedProperties_Public()
 {
 	ImportDeprecatedProperties();
 }
+
+bool USMStateMachineTestComponent::CanAcceptPredictedTransaction_Public(const FSMNetworkedTransaction& Transaction) const
+{
+	return CanAcceptPredictedTransaction(Transaction);
+}
+
+void USMStateMachineTestComponent::AddPendingPrediction_Public(const FSMNetworkedTransaction& Transaction)
+{
+	PendingPredictions.Add(Transaction);
+}
+
+void USMStateMachineTestComponent::RejectPredictedTransactions_Public(int32 PredictionKey, const TArray<FGuid>& AuthoritativeStates)
+{
+	CLIENT_RejectPredictedTransactions_Implementation(PredictionKey, AuthoritativeStates);
+}
+
+void USMStateMachineTestComponent::QueueTransactionsForBatch_Public(const TArray<FSMNetworkedTransaction>& Transactions)
+{
+	QueueTransactionsForBatch(Transactions);
+}
+
+void USMStateMachineTestComponent::FlushTransactionBatches_Public(UWorld* World)
+{
+	FlushTransactionBatches(World, LEVELTICK_All, 0.f);
+}
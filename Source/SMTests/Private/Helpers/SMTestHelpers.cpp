@@ -24,6 +24,7 @@
 #include "Graph/SMTransitionGraph.h"
 #include "Graph/SMGraph.h"
 #include "Graph/Nodes/SMGraphNode_StateMachineEntryNode.h"
+#include "Graph/Nodes/SMGraphK2Node_StateMachineNode.h"
 #include "Graph/Nodes/RootNodes/SMGraphK2Node_StateUpdateNode.h"
 #include "Graph/Nodes/RootNodes/SMGraphK2Node_StateEndNode.h"
 #include "Graph/Nodes/Helpers/SMGraphK2Node_StateReadNodes.h"
@@ -300,6 +301,44 @@ bool TestHelpers::TryCreateNewStateMachineAsset(FAutomationTestBase* Test, FAsse
 	return true;
 }
 
+USMGraph* TestHelpers::CreateLinearStateMachineAsset(FAutomationTestBase* Test, FAssetHandler& NewAsset, int32 NumStates, UEdGraphPin** LastStatePinOut,
+	UClass* StateClass, UClass* TransitionClass)
+{
+	if (!TryCreateNewStateMachineAsset(Test, NewAsset, false))
+	{
+		return nullptr;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	// Find root state machine.
+	USMGraphK2Node_StateMachineNode* RootStateMachineNode = FSMBlueprintEditorUtils::GetRootStateMachineNode(NewBP);
+
+	// Find the state machine graph.
+	USMGraph* StateMachineGraph = RootStateMachineNode->GetStateMachineGraph();
+
+	UEdGraphPin* LastStatePin = nullptr;
+	BuildLinearStateMachine(Test, StateMachineGraph, NumStates, &LastStatePin, StateClass, TransitionClass);
+
+	if (LastStatePinOut)
+	{
+		*LastStatePinOut = LastStatePin;
+	}
+
+	return StateMachineGraph;
+}
+
+bool TestHelpers::SaveAndCompileAsset(FAutomationTestBase* Test, FAssetHandler& NewAsset)
+{
+	if (!NewAsset.SaveAsset(Test))
+	{
+		return false;
+	}
+
+	FKismetEditorUtilities::CompileBlueprint(NewAsset.GetObjectAs<USMBlueprint>());
+	return true;
+}
+
 UK2Node_CallFunction* TestHelpers::CreateContextGetter(FAutomationTestBase* Test, UEdGraph* Graph, UEdGraphPin** ContextOutPin)
 {
 	UK2Node_CallFunction* GetContextNode = NewObject<UK2Node_CallFunction>(Graph);
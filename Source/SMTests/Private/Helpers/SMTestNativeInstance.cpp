@@ -0,0 +1,44 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "SMTestNativeInstance.h"
+
+USMTestNativeInstance::USMTestNativeInstance()
+{
+	RootStateMachineGuid = FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F01);
+	bCanAdvance = false;
+
+	State_A.SetNodeGuid(FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F0A));
+	State_A.SetOwnerNodeGuid(FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F01));
+	State_A.SetNodeName(TEXT("A"));
+	State_A.bIsRootNode = true;
+	State_B.SetNodeGuid(FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F0B));
+	State_B.SetOwnerNodeGuid(FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F01));
+	State_B.SetNodeName(TEXT("B"));
+	State_C.SetNodeGuid(FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F0C));
+	State_C.SetOwnerNodeGuid(FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F01));
+	State_C.SetNodeName(TEXT("C"));
+	Transition_A_to_B.bEvalIfNextStateActive = false;
+	Transition_A_to_B.FromGuid = FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F0A);
+	Transition_A_to_B.ToGuid = FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F0B);
+	Transition_A_to_B.GraphEvaluator.BoundFunction = FName(TEXT("Transition_A_to_B_Evaluate"));
+	Transition_A_to_B.SetNodeGuid(FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F1A));
+	Transition_A_to_B.SetOwnerNodeGuid(FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F01));
+	Transition_A_to_B.SetNodeName(TEXT("A to B"));
+	Transition_B_to_C.bEvalIfNextStateActive = false;
+	Transition_B_to_C.FromGuid = FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F0B);
+	Transition_B_to_C.ToGuid = FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F0C);
+	Transition_B_to_C.ConditionalEvaluationType = ESMConditionalEvaluationType::SM_AlwaysTrue;
+	Transition_B_to_C.GraphEvaluator.BoundFunction = FName(TEXT("Transition_B_to_C_Evaluate"));
+	Transition_B_to_C.SetNodeGuid(FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F1B));
+	Transition_B_to_C.SetOwnerNodeGuid(FGuid(0x5D0C8E41, 0x4A2B7F10, 0x9E3C6A52, 0x1B7D4F01));
+	Transition_B_to_C.SetNodeName(TEXT("B to C"));
+}
+
+void USMTestNativeInstance::Transition_A_to_B_Evaluate()
+{
+	Transition_A_to_B.bCanEnterTransition = bCanAdvance;
+}
+
+void USMTestNativeInstance::Transition_B_to_C_Evaluate()
+{
+	Transition_B_to_C.bCanEnterTransition = true;
+}
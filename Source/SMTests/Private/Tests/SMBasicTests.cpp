@@ -18,6 +18,10 @@
 #include "Graph/Nodes/SMGraphNode_TransitionEdge.h"
 #include "Graph/Nodes/SMGraphNode_StateMachineStateNode.h"
 #include "Graph/Nodes/SMGraphNode_ConduitNode.h"
+#include "SMTraceRecorder.h"
+#include "HAL/FileManager.h"
+#include "Misc/ScopeExit.h"
+#include "Async/ParallelFor.h"
 
 
 #if WITH_DEV_AUTOMATION_TESTS
@@ -430,6 +434,614 @@ IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStateNodeSingleTickTest, "SMTests.SingleTick",
 	return NewAsset.DeleteAsset(this);
 }
 
+/**
+ * Test transitions which pass on start are limited per update and continue on the next update.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMaxTransitionsPerUpdateTest, "SMTests.MaxTransitionsPerUpdate", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FMaxTransitionsPerUpdateTest::RunTest(const FString& Parameters)
+{
+	const int32 TotalStates = 10;
+	const int32 MaxTransitions = 3;
+
+	FAssetHandler NewAsset;
+	USMGraph* StateMachineGraph = TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, TotalStates);
+	if (!StateMachineGraph)
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	TArray<USMGraphNode_StateNodeBase*> StateNodes;
+	FSMBlueprintEditorUtils::GetAllNodesOfClassNested<USMGraphNode_StateNodeBase>(StateMachineGraph, StateNodes);
+
+	for (USMGraphNode_StateNodeBase* Node : StateNodes)
+	{
+		Node->GetNodeTemplateAs<USMStateInstance_Base>()->bEvalTransitionsOnStart = true;
+	}
+	
+	if (!TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	// Without a limit the whole chain is taken in one update.
+	{
+		USMTestContext* Context = NewObject<USMTestContext>();
+		USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+		
+		Instance->Start();
+		Instance->Update(0.f);
+		TestTrue("Unlimited chain reached end state", Instance->IsInEndState());
+		Instance->Shutdown();
+	}
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+	Instance->OnStateMachineTransitionTakenEvent.AddUniqueDynamic(Context, &USMTestContext::OnTransitionTaken);
+	Instance->SetMaxTransitionsPerUpdate(MaxTransitions);
+	
+	Instance->Start();
+
+	int32 Updates = 0;
+	while (!Instance->IsInEndState() && Updates < TotalStates)
+	{
+		const int32 TransitionsBefore = Context->TestTransitionsHit;
+		Instance->Update(0.f);
+		Updates++;
+		
+		TestTrue("Transitions limited per update", Context->TestTransitionsHit - TransitionsBefore <= MaxTransitions);
+	}
+
+	TestTrue("Limited chain reached end state", Instance->IsInEndState());
+	TestEqual("All transitions taken", Context->TestTransitionsHit, TotalStates - 1);
+	TestTrue("Chain continued over several updates", Updates > 1);
+
+	Instance->Shutdown();
+	
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Test tick LOD tiers disabling state update logic and tick transition evaluation.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTickLODTest, "SMTests.TickLOD", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FTickLODTest::RunTest(const FString& Parameters)
+{
+	const int32 TotalStates = 2;
+
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, TotalStates) || !TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+
+	FSMTickLODTier NearTier;
+	FSMTickLODTier FarTier;
+	FarTier.MinDistance = 1000.f;
+	FarTier.TickInterval = 1.f;
+	FarTier.bRunStateUpdateLogic = false;
+	FarTier.bEvaluateTransitionsOnTick = false;
+
+	// Out of order on purpose, tiers should be sorted.
+	Instance->SetTickLODTiers({ FarTier, NearTier });
+	TestEqual("Tiers sorted by distance", Instance->GetTickLODTiers()[1].MinDistance, FarTier.MinDistance);
+
+	Instance->Start();
+	const FGuid InitialStateGuid = Instance->GetSingleActiveStateGuid();
+
+	Instance->SetTickLOD(1);
+	TestEqual("LOD set", Instance->GetTickLOD(), 1);
+	TestEqual("LOD tick interval applied", Instance->GetTickInterval(), FarTier.TickInterval);
+
+	Instance->Update(1.f);
+	TestEqual("State update logic skipped", Context->GetUpdateInt(), 0);
+	TestEqual("Transition not evaluated on tick", Instance->GetSingleActiveStateGuid(), InitialStateGuid);
+	TestEqual("Time in state still recorded", Instance->GetSingleActiveState()->GetActiveTime(), 1.f);
+
+	Instance->SetTickLOD(INDEX_NONE);
+	TestEqual("LOD cleared", Instance->GetTickLOD(), (int32)INDEX_NONE);
+	TestEqual("Original tick interval restored", Instance->GetTickInterval(), 0.f);
+
+	Instance->Update(1.f);
+	TestNotEqual("Transition evaluated on tick", Instance->GetSingleActiveStateGuid(), InitialStateGuid);
+
+	Instance->Update(1.f);
+	TestEqual("State update logic run", Context->GetUpdateInt(), 1);
+
+	Instance->Shutdown();
+	
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Test fixed time step substeps and integer time in state.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFixedTimeStepTest, "SMTests.FixedTimeStep", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FFixedTimeStepTest::RunTest(const FString& Parameters)
+{
+	const int32 TotalStates = 2;
+
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, TotalStates) || !TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	Context->bCanTransition = false;
+	
+	USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+	Instance->SetUseFixedTimeStep(true, 0.25f);
+	Instance->Start();
+
+	FSMState_Base* State = Instance->GetSingleActiveState();
+
+	Instance->Update(0.1f);
+	TestEqual("Partial step not run", Instance->GetFixedStepFrame(), 0);
+	TestEqual("No time in state", State->GetActiveFixedSteps(), 0);
+
+	Instance->Update(0.4f);
+	TestEqual("Accumulated steps run", Instance->GetFixedStepFrame(), 2);
+	TestEqual("Steps in state", State->GetActiveFixedSteps(), 2);
+	TestEqual("Time in state derived from steps", State->GetActiveTime(), 0.5f);
+
+	// Substeps are capped and excess time discarded.
+	Instance->Update(10.f);
+	TestEqual("Substeps capped", Instance->GetFixedStepFrame(), 6);
+
+	Instance->AdvanceFixedSteps(3);
+	TestEqual("Manual steps run", Instance->GetFixedStepFrame(), 9);
+	TestEqual("Steps in state", State->GetActiveFixedSteps(), 9);
+
+	Context->bCanTransition = true;
+	Instance->AdvanceFixedSteps(1);
+	TestNotEqual("Transition taken on step", Instance->GetSingleActiveState(), State);
+
+	Instance->Shutdown();
+	
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Test rewinding to a recorded fixed step frame and resimulating.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRewindResimulateTest, "SMTests.RewindResimulate", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FRewindResimulateTest::RunTest(const FString& Parameters)
+{
+	const int32 TotalStates = 3;
+
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, TotalStates) || !TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+	Instance->SetUseFixedTimeStep(true, 0.1f);
+	Instance->SetRewindEnabled(true);
+	Instance->Start();
+
+	TArray<FGuid> StateAtFrame;
+	StateAtFrame.Add(Instance->GetSingleActiveStateGuid());
+	
+	Instance->AdvanceFixedSteps(1);
+	StateAtFrame.Add(Instance->GetSingleActiveStateGuid());
+	
+	Instance->AdvanceFixedSteps(1);
+	StateAtFrame.Add(Instance->GetSingleActiveStateGuid());
+	
+	TestEqual("All states entered", Context->GetEntryInt(), TotalStates);
+	TestTrue("In end state", Instance->IsInEndState());
+	const int32 EndHits = Context->GetEndInt();
+
+	TestFalse("Future frame can't be rewound", Instance->CanRewindTo(5));
+	TestTrue("Rewind to frame", Instance->RewindTo(1));
+	TestEqual("Frame restored", Instance->GetFixedStepFrame(), 1);
+	TestEqual("State restored", Instance->GetSingleActiveStateGuid(), StateAtFrame[1]);
+	TestFalse("No longer in end state", Instance->IsInEndState());
+	TestEqual("Begin logic not run on rewind", Context->GetEntryInt(), TotalStates);
+	TestFalse("Later frames invalidated", Instance->CanRewindTo(2));
+
+	Instance->Resimulate(1);
+	TestFalse("Resimulation finished", Instance->IsResimulating());
+	TestEqual("Resimulated frame", Instance->GetFixedStepFrame(), 2);
+	TestEqual("Resimulated state matches", Instance->GetSingleActiveStateGuid(), StateAtFrame[2]);
+	TestEqual("Begin logic not run during resimulation", Context->GetEntryInt(), TotalStates);
+	TestEqual("End logic not run during resimulation", Context->GetEndInt(), EndHits);
+
+	// Opt in to running the logic again.
+	Instance->SetRunStateLogicOnResimulate(true);
+	TestTrue("Rewind to frame again", Instance->RewindTo(1));
+	Instance->Resimulate(1);
+	TestEqual("Resimulated state matches with logic", Instance->GetSingleActiveStateGuid(), StateAtFrame[2]);
+	TestEqual("Begin logic run during resimulation when configured", Context->GetEntryInt(), TotalStates + 1);
+	TestEqual("End logic run during resimulation when configured", Context->GetEndInt(), EndHits + 1);
+
+	TestTrue("Rewind to start", Instance->RewindTo(0));
+	TestEqual("Initial state restored", Instance->GetSingleActiveStateGuid(), StateAtFrame[0]);
+
+	Instance->Shutdown();
+	
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Test native state change delegates receive the runtime nodes alongside the dynamic events.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNativeStateChangeEventsTest, "SMTests.NativeStateChangeEvents", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FNativeStateChangeEventsTest::RunTest(const FString& Parameters)
+{
+	const int32 TotalStates = 3;
+
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, TotalStates) || !TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	Context->bCanTransition = false;
+
+	USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+	Instance->OnStateMachineTransitionTakenEvent.AddUniqueDynamic(Context, &USMTestContext::OnTransitionTaken);
+	Instance->OnStateMachineStateChangedEvent.AddUniqueDynamic(Context, &USMTestContext::OnStateChanged);
+
+	int32 NativeStatesHit = 0;
+	int32 NativeTransitionsHit = 0;
+	FSMState_Base* LastToState = nullptr;
+	FSMState_Base* LastFromState = nullptr;
+	const FSMTransition* LastTransition = nullptr;
+
+	Instance->OnStateMachineStateChangedNative.AddLambda([&](USMInstance* InInstance, FSMState_Base* ToState, FSMState_Base* FromState)
+	{
+		TestEqual("Native state change instance", InInstance, Instance);
+		NativeStatesHit++;
+		LastToState = ToState;
+		LastFromState = FromState;
+	});
+
+	Instance->OnStateMachineTransitionTakenNative.AddLambda([&](USMInstance* InInstance, const FSMTransition& Transition)
+	{
+		TestEqual("Native transition instance", InInstance, Instance);
+		NativeTransitionsHit++;
+		LastTransition = &Transition;
+	});
+
+	Instance->Start();
+	FSMState_Base* FirstState = Instance->GetSingleActiveState();
+	TestEqual("Native state change on start", NativeStatesHit, Context->TestStatesHit);
+	TestEqual("Entered first state", LastToState, FirstState);
+	TestNull("No previous state", LastFromState);
+
+	Context->bCanTransition = true;
+	Instance->Update(0.f);
+	FSMState_Base* SecondState = Instance->GetSingleActiveState();
+	TestNotEqual("Transition taken", FirstState, SecondState);
+
+	TestEqual("Native state changes match dynamic events", NativeStatesHit, Context->TestStatesHit);
+	TestEqual("Native transitions match dynamic events", NativeTransitionsHit, Context->TestTransitionsHit);
+	TestEqual("Entered second state", LastToState, SecondState);
+	TestEqual("Left first state", LastFromState, FirstState);
+	TestTrue("Transition from first state", LastTransition && LastTransition->GetFromState() == FirstState);
+	TestTrue("Transition to second state", LastTransition && LastTransition->GetToState() == SecondState);
+
+	Instance->Shutdown();
+
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Test debug events are recorded for each consumer in the order nodes change.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDebugEventsTest, "SMTests.DebugEvents", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FDebugEventsTest::RunTest(const FString& Parameters)
+{
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, 2) || !TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	Context->bCanTransition = false;
+	
+	USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+
+	const int32 Consumer = 0;
+	const int32 OtherConsumer = 0;
+	
+	// Nothing is recorded without a consumer.
+	Instance->Start();
+	TestFalse("Not recording", Instance->GetDebugEventBuffer().HasConsumers());
+	TestEqual("No events recorded", Instance->GetDebugEventBuffer().Drain(&Consumer, [](const FSMDebugEvent&) {}), 0);
+	Instance->Stop();
+
+	// Such as a child blueprint editor and its parent's editor debugging the same instance.
+	TestTrue("Recording started", Instance->StartRecordingDebugEvents(&Consumer));
+	TestTrue("Second consumer recording", Instance->StartRecordingDebugEvents(&OtherConsumer));
+
+	Instance->Start();
+	FSMState_Base* FirstState = Instance->GetSingleActiveState();
+
+	Context->bCanTransition = true;
+	Instance->Update(0.f);
+	FSMState_Base* SecondState = Instance->GetSingleActiveState();
+	TestNotEqual("Transition taken", FirstState, SecondState);
+
+	TArray<FSMDebugEvent> Events;
+	Instance->GetDebugEventBuffer().Drain(&Consumer, [&](const FSMDebugEvent& Event)
+	{
+		Events.Add(Event);
+	});
+
+	auto FindEvent = [&](const FGuid& Guid, ESMDebugEventType Type)
+	{
+		return Events.IndexOfByPredicate([&](const FSMDebugEvent& Event)
+		{
+			return Event.NodeGuid == Guid && Event.Type == Type;
+		});
+	};
+
+	const int32 FirstEntered = FindEvent(FirstState->GetNodeGuid(), ESMDebugEventType::Entered);
+	const int32 FirstExited = FindEvent(FirstState->GetNodeGuid(), ESMDebugEventType::Exited);
+	const int32 SecondEntered = FindEvent(SecondState->GetNodeGuid(), ESMDebugEventType::Entered);
+	const int32 TransitionEvaluated = FindEvent(FirstState->GetOutgoingTransitions()[0]->GetNodeGuid(), ESMDebugEventType::Evaluated);
+	const int32 TransitionTaken = FindEvent(FirstState->GetOutgoingTransitions()[0]->GetNodeGuid(), ESMDebugEventType::Entered);
+
+	TestTrue("First state entered", FirstEntered != INDEX_NONE);
+	TestTrue("Transition evaluated after entering", TransitionEvaluated > FirstEntered);
+	TestTrue("Transition taken after evaluating", TransitionTaken > TransitionEvaluated);
+	TestTrue("First state exited", FirstExited > FirstEntered);
+	TestTrue("Second state entered", SecondEntered > FirstExited);
+	TestEqual("Path guid recorded", Events[FirstEntered].PathGuid, FirstState->GetGuid());
+
+	for (int32 Idx = 1; Idx < Events.Num(); ++Idx)
+	{
+		TestTrue("Events in time order", Events[Idx].Time >= Events[Idx - 1].Time);
+	}
+
+	// Each consumer reads independently.
+	TestEqual("Second consumer receives the same events", Instance->GetDebugEventBuffer().Drain(&OtherConsumer, [](const FSMDebugEvent&) {}), Events.Num());
+	TestEqual("Already drained", Instance->GetDebugEventBuffer().Drain(&Consumer, [](const FSMDebugEvent&) {}), 0);
+
+	// Falling behind only drops events for that consumer.
+	for (int32 Idx = 0; Idx < FSMDebugEventBuffer::DefaultCapacity + 1; ++Idx)
+	{
+		Instance->RecordDebugEvent(*SecondState, ESMDebugEventType::Evaluated);
+		if (Idx == 0)
+		{
+			Instance->GetDebugEventBuffer().Drain(&Consumer, [](const FSMDebugEvent&) {});
+		}
+	}
+	TestEqual("Lagging consumer receives a full buffer", Instance->GetDebugEventBuffer().Drain(&OtherConsumer, [](const FSMDebugEvent&) {}), (int32)FSMDebugEventBuffer::DefaultCapacity);
+	TestEqual("Lagging consumer dropped events", Instance->GetDebugEventBuffer().GetNumDropped(&OtherConsumer), 1u);
+	TestEqual("Other consumer receives the rest", Instance->GetDebugEventBuffer().Drain(&Consumer, [](const FSMDebugEvent&) {}), (int32)FSMDebugEventBuffer::DefaultCapacity);
+	TestEqual("Other consumer dropped nothing", Instance->GetDebugEventBuffer().GetNumDropped(&Consumer), 0u);
+
+	// Stopping one consumer doesn't affect the other.
+	Instance->StopRecordingDebugEvents(&Consumer);
+	TestFalse("First consumer stopped", Instance->IsRecordingDebugEventsFor(&Consumer));
+	TestTrue("Second consumer still recording", Instance->IsRecordingDebugEventsFor(&OtherConsumer));
+	
+	Instance->RecordDebugEvent(*SecondState, ESMDebugEventType::Evaluated);
+	TestEqual("No events after stopping", Instance->GetDebugEventBuffer().Drain(&Consumer, [](const FSMDebugEvent&) {}), 0);
+	TestEqual("Remaining consumer receives events", Instance->GetDebugEventBuffer().Drain(&OtherConsumer, [](const FSMDebugEvent&) {}), 1);
+
+	Instance->StopRecordingDebugEvents(&OtherConsumer);
+	Instance->Shutdown();
+	
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Test node activity inside a referenced state machine is recorded by the instance that owns the reference.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDebugEventsReferenceTest, "SMTests.DebugEventsReference", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FDebugEventsReferenceTest::RunTest(const FString& Parameters)
+{
+	FAssetHandler NewAsset;
+	UEdGraphPin* LastStatePin = nullptr;
+	USMGraph* StateMachineGraph = TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, 1, &LastStatePin);
+	if (!StateMachineGraph)
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	UEdGraphPin* LastNestedPin = nullptr;
+	USMGraphNode_StateMachineStateNode* NestedStateMachineNode = TestHelpers::BuildNestedStateMachine(this, StateMachineGraph, 2, &LastStatePin, &LastNestedPin);
+
+	USMBlueprint* NewReferencedBlueprint = FSMBlueprintEditorUtils::ConvertStateMachineToReference(NestedStateMachineNode, false, nullptr, nullptr);
+	if (!TestNotNull("New referenced blueprint created", NewReferencedBlueprint))
+	{
+		return false;
+	}
+	FKismetEditorUtilities::CompileBlueprint(NewReferencedBlueprint);
+
+	// Store handler information so we can delete the object.
+	FString ReferencedPath = NewReferencedBlueprint->GetPathName();
+	FAssetHandler ReferencedAsset(NewReferencedBlueprint->GetName(), USMBlueprint::StaticClass(), NewObject<USMBlueprintFactory>(), &ReferencedPath);
+	ReferencedAsset.Object = NewReferencedBlueprint;
+	ReferencedAsset.Package = FAssetData(NewReferencedBlueprint).GetPackage();
+
+	ON_SCOPE_EXIT
+	{
+		ReferencedAsset.DeleteAsset(this);
+	};
+	
+	if (!TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+
+	TArray<USMInstance*> References = Instance->GetAllReferencedInstances(true);
+	if (!TestEqual("One reference", References.Num(), 1))
+	{
+		return false;
+	}
+
+	const int32 Consumer = 0;
+	Instance->StartRecordingDebugEvents(&Consumer);
+	
+	TestHelpers::RunAllStateMachinesToCompletion(this, Instance, &Instance->GetRootStateMachine());
+
+	TSet<FGuid> RecordedGuids;
+	Instance->GetDebugEventBuffer().Drain(&Consumer, [&](const FSMDebugEvent& Event)
+	{
+		if (Event.Type == ESMDebugEventType::Entered)
+		{
+			RecordedGuids.Add(Event.NodeGuid);
+		}
+	});
+
+	for (const FSMState_Base* State : References[0]->GetRootStateMachine().GetStates())
+	{
+		TestTrue("Referenced state recorded by the owning instance", RecordedGuids.Contains(State->GetNodeGuid()));
+	}
+
+	Instance->StopRecordingDebugEvents(&Consumer);
+	Instance->Shutdown();
+	
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Test state machine activity is written to a trace file and read back in time order, including events recorded from other threads.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTraceRecorderTest, "SMTests.TraceRecorder", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FTraceRecorderTest::RunTest(const FString& Parameters)
+{
+	// Starting a recording would replace a trace the user started with -SMTrace or sm.Trace.Start.
+	if (FSMTraceRecorder::IsRecording())
+	{
+		AddInfo(FString::Printf(TEXT("Skipped, a state machine trace is already being recorded to %s."), *FSMTraceRecorder::Get().GetFilePath()));
+		return true;
+	}
+	
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, 2) || !TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	Context->bCanTransition = false;
+
+	USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+
+	const FString TracePath = FPaths::CreateTempFilename(*FPaths::ProjectIntermediateDir(), TEXT("SMTraceTest"), TEXT(".smtrace"));
+	if (!TestTrue("Recording started", FSMTraceRecorder::Get().StartRecording(TracePath)))
+	{
+		return NewAsset.DeleteAsset(this);
+	}
+
+	Instance->Start();
+	FSMState_Base* FirstState = Instance->GetSingleActiveState();
+
+	Context->bCanTransition = true;
+	Instance->Update(0.f);
+	FSMState_Base* SecondState = Instance->GetSingleActiveState();
+	Instance->Stop();
+
+	// Each thread records into its own buffer.
+	const int32 NumThreads = 4;
+	const int32 EventsPerThread = 100;
+	ParallelFor(NumThreads, [&](int32 ThreadIdx)
+	{
+		for (int32 Idx = 0; Idx < EventsPerThread; ++Idx)
+		{
+			FSMTraceRecorder::Get().RecordEvent(*SecondState, ESMTraceEventType::StateEntered);
+		}
+	});
+
+	FSMTraceRecorder::Get().StopRecording();
+	TestFalse("Recording stopped", FSMTraceRecorder::IsRecording());
+
+	FSMTrace Trace;
+	TestTrue("Trace loaded", Trace.LoadFromFile(TracePath));
+	IFileManager::Get().Delete(*TracePath);
+
+	if (!TestEqual("One instance recorded", Trace.Instances.Num(), 1))
+	{
+		return NewAsset.DeleteAsset(this);
+	}
+
+	TestEqual("Instance class recorded", Trace.Instances[0].ClassPath, NewBP->GeneratedClass->GetPathName());
+
+	auto FindEvent = [&](const FGuid& Guid, ESMTraceEventType Type)
+	{
+		return Trace.Events.IndexOfByPredicate([&](const FSMTraceEvent& Event)
+		{
+			const FSMTraceNode* Node = Trace.FindNode(Event.InstanceId, Event.NodeIndex);
+			return Node && Node->NodeGuid == Guid && Event.Type == Type;
+		});
+	};
+
+	const int32 FirstEntered = FindEvent(FirstState->GetNodeGuid(), ESMTraceEventType::StateEntered);
+	const int32 TransitionTaken = FindEvent(FirstState->GetOutgoingTransitions()[0]->GetNodeGuid(), ESMTraceEventType::TransitionTaken);
+	const int32 FirstExited = FindEvent(FirstState->GetNodeGuid(), ESMTraceEventType::StateExited);
+	const int32 SecondEntered = FindEvent(SecondState->GetNodeGuid(), ESMTraceEventType::StateEntered);
+
+	TestTrue("First state entered", FirstEntered != INDEX_NONE);
+	TestTrue("Transition taken", TransitionTaken != INDEX_NONE);
+	TestTrue("First state exited", FirstExited > FirstEntered);
+	TestTrue("Second state entered", SecondEntered > FirstExited);
+
+	for (int32 Idx = 1; Idx < Trace.Events.Num(); ++Idx)
+	{
+		TestTrue("Events in time order", Trace.Events[Idx].Time >= Trace.Events[Idx - 1].Time);
+	}
+
+	const int32 NumSecondEntered = Trace.Events.FilterByPredicate([&](const FSMTraceEvent& Event)
+	{
+		const FSMTraceNode* Node = Trace.FindNode(Event.InstanceId, Event.NodeIndex);
+		return Node && Node->NodeGuid == SecondState->GetNodeGuid() && Event.Type == ESMTraceEventType::StateEntered;
+	}).Num();
+	TestEqual("Events from all threads recorded", NumSecondEntered, NumThreads * EventsPerThread + 1);
+	TestEqual("No events dropped", FSMTraceRecorder::Get().GetNumEventsDropped(), 0ll);
+
+	Instance->Shutdown();
+
+	return NewAsset.DeleteAsset(this);
+}
+
 #endif
 
 #endif //WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
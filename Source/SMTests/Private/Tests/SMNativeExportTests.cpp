@@ -0,0 +1,227 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#include "Blueprints/SMBlueprint.h"
+#include "SMTestHelpers.h"
+#include "Utilities/SMBlueprintEditorUtils.h"
+#include "Utilities/SMNativeCodeGenerator.h"
+#include "SMTestContext.h"
+#include "SMTestNativeInstance.h"
+#include "SMUtils.h"
+#include "Graph/SMGraph.h"
+#include "Graph/SMTransitionGraph.h"
+#include "Graph/Nodes/SMGraphNode_StateNode.h"
+#include "Graph/Nodes/SMGraphNode_StateMachineEntryNode.h"
+#include "Graph/Nodes/SMGraphNode_TransitionEdge.h"
+
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#if PLATFORM_DESKTOP
+
+/**
+ * Export a state machine to native code and check the generated initialization against the compiled nodes.
+ * USMTestNativeInstance is written in the same form and is run next to the blueprint.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNativeExportTest, "SMTests.NativeExport", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FNativeExportTest::RunTest(const FString& Parameters)
+{
+	FAssetHandler NewAsset;
+	USMGraph* StateMachineGraph = TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, 0);
+	if (!StateMachineGraph)
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	const FName VarName = "bCanAdvance";
+	{
+		FEdGraphPinType VarType;
+		VarType.PinCategory = UEdGraphSchema_K2::PC_Boolean;
+		FBlueprintEditorUtils::AddMemberVariable(NewBP, VarName, VarType, "False");
+	}
+
+	// A -> B when bCanAdvance, B -> C always. States have no logic.
+	TArray<USMGraphNode_StateNode*> States;
+	UEdGraphPin* FromPin = StateMachineGraph->GetEntryNode()->GetOutputPin();
+	for (const TCHAR* StateName : { TEXT("A"), TEXT("B"), TEXT("C") })
+	{
+		USMGraphNode_StateNode* State = TestHelpers::CreateNewNode<USMGraphNode_StateNode>(this, StateMachineGraph, FromPin);
+		State->GetBoundGraph()->Rename(StateName, nullptr, REN_DontCreateRedirectors);
+		States.Add(State);
+		FromPin = State->GetOutputPin();
+	}
+
+	{
+		USMTransitionGraph* TransitionGraph = CastChecked<USMGraphNode_TransitionEdge>(States[1]->GetInputPin()->LinkedTo[0]->GetOwningNode())->GetTransitionGraph();
+		FProperty* VarProperty = FSMBlueprintEditorUtils::GetPropertyForVariable(NewBP, VarName);
+		FSMBlueprintEditorUtils::PlacePropertyOnGraph(TransitionGraph, VarProperty, TransitionGraph->ResultNode->GetTransitionEvaluationPin(), nullptr);
+	}
+	{
+		USMTransitionGraph* TransitionGraph = CastChecked<USMGraphNode_TransitionEdge>(States[2]->GetInputPin()->LinkedTo[0]->GetOwningNode())->GetTransitionGraph();
+		TransitionGraph->GetSchema()->TrySetDefaultValue(*TransitionGraph->ResultNode->GetTransitionEvaluationPin(), "True");
+	}
+
+	if (!TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	auto GuidToCpp = [](const FGuid& Guid)
+	{
+		return FString::Printf(TEXT("FGuid(0x%08X, 0x%08X, 0x%08X, 0x%08X)"), Guid.A, Guid.B, Guid.C, Guid.D);
+	};
+
+	// Generate and check the conditions were converted.
+	{
+		FSMNativeCodeGenerator::FOptions Options;
+		Options.ClassName = TEXT("SMTestNativeInstance");
+
+		FSMNativeCodeGenerator::FResult Result;
+		FString Error;
+		TestTrue("Blueprint exported", FSMNativeCodeGenerator::Generate(NewBP, Options, Result, Error));
+		TestEqual("All nodes exported", Result.NumNodes, 5);
+		TestEqual("Both conditions native", Result.NumNativeConditions, 2);
+		TestEqual("Nothing left to blueprints", Result.BlueprintFunctions.Num(), 0);
+		TestTrue("Variable exported", Result.HeaderText.Contains(TEXT("bool bCanAdvance;")));
+		TestTrue("Variable condition", Result.SourceText.Contains(TEXT("Transition_A_to_B.bCanEnterTransition = bCanAdvance;")));
+		TestTrue("Constant condition", Result.SourceText.Contains(TEXT("Transition_B_to_C.bCanEnterTransition = true;")));
+
+		// Nodes are initialized with plain assignments matching the compiled nodes.
+		TestFalse("No text import", Result.SourceText.Contains(TEXT("ImportText")));
+		TestFalse("No class loading", Result.SourceText.Contains(TEXT("TryLoadClass")));
+		TestFalse("Default node classes left to initialization", Result.SourceText.Contains(TEXT("SetNodeInstanceClass")));
+		TestTrue("Concrete class", Result.HeaderText.Contains(TEXT("\nUCLASS(Blueprintable)\n")));
+
+		const FGuid RootGuid = CastChecked<USMInstance>(NewBP->GeneratedClass->GetDefaultObject())->RootStateMachineGuid;
+		TArray<FString> ExpectedLines =
+		{
+			FString::Printf(TEXT("\tRootStateMachineGuid = %s;\n"), *GuidToCpp(RootGuid)),
+			TEXT("\tState_A.bIsRootNode = true;\n"),
+			TEXT("\tTransition_A_to_B.GraphEvaluator.BoundFunction = FName(TEXT(\"Transition_A_to_B_Evaluate\"));\n"),
+			TEXT("\tTransition_B_to_C.ConditionalEvaluationType = ESMConditionalEvaluationType::SM_AlwaysTrue;\n")
+		};
+
+		for (int32 Idx = 0; Idx < States.Num(); ++Idx)
+		{
+			const FString MemberName = FString::Printf(TEXT("State_%s"), *States[Idx]->GetStateName());
+			const FSMNode_Base* RuntimeNode = States[Idx]->FindRuntimeNode();
+			ExpectedLines.Add(FString::Printf(TEXT("\t%s.SetNodeGuid(%s);\n"), *MemberName, *GuidToCpp(RuntimeNode->GetNodeGuid())));
+			ExpectedLines.Add(FString::Printf(TEXT("\t%s.SetOwnerNodeGuid(%s);\n"), *MemberName, *GuidToCpp(RootGuid)));
+			ExpectedLines.Add(FString::Printf(TEXT("\t%s.SetNodeName(TEXT(\"%s\"));\n"), *MemberName, *States[Idx]->GetStateName()));
+
+			if (Idx > 0)
+			{
+				const FString TransitionName = FString::Printf(TEXT("Transition_%s_to_%s"), *States[Idx - 1]->GetStateName(), *States[Idx]->GetStateName());
+				ExpectedLines.Add(FString::Printf(TEXT("\t%s.FromGuid = %s;\n"), *TransitionName, *GuidToCpp(States[Idx - 1]->FindRuntimeNode()->GetNodeGuid())));
+				ExpectedLines.Add(FString::Printf(TEXT("\t%s.ToGuid = %s;\n"), *TransitionName, *GuidToCpp(RuntimeNode->GetNodeGuid())));
+			}
+		}
+
+		for (const FString& Line : ExpectedLines)
+		{
+			TestTrue(FString::Printf(TEXT("Generated %s"), *Line.TrimStartAndEnd()), Result.SourceText.Contains(Line));
+		}
+	}
+
+	// Run the blueprint and the native class side by side.
+	USMTestContext* Context = NewObject<USMTestContext>();
+	USMInstance* BlueprintInstance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+	USMInstance* NativeInstance = USMBlueprintUtils::CreateStateMachineInstance(USMTestNativeInstance::StaticClass(), Context);
+	TestTrue("Native instance initialized", NativeInstance && NativeInstance->IsInitialized());
+	if (!NativeInstance)
+	{
+		return NewAsset.DeleteAsset(this);
+	}
+
+	TestEqual("Same states", NativeInstance->GetRootStateMachine().GetStates().Num(), BlueprintInstance->GetRootStateMachine().GetStates().Num());
+	TestEqual("Same transitions", NativeInstance->GetRootStateMachine().GetTransitions().Num(), BlueprintInstance->GetRootStateMachine().GetTransitions().Num());
+
+	auto SetCanAdvance = [&](USMInstance* Instance, bool bValue)
+	{
+		FBoolProperty* Property = FindFProperty<FBoolProperty>(Instance->GetClass(), VarName);
+		TestNotNull("Variable found", Property);
+		Property->SetPropertyValue_InContainer(Instance, bValue);
+	};
+
+	auto RunSteps = [&](USMInstance* Instance, TArray<FString>& OutActiveStates)
+	{
+		Instance->Start();
+		OutActiveStates.Add(Instance->GetSingleActiveState()->GetNodeName());
+
+		Instance->Update(0.f);
+		OutActiveStates.Add(Instance->GetSingleActiveState()->GetNodeName());
+
+		SetCanAdvance(Instance, true);
+		Instance->Update(0.f);
+		OutActiveStates.Add(Instance->GetSingleActiveState()->GetNodeName());
+
+		Instance->Update(0.f);
+		OutActiveStates.Add(Instance->GetSingleActiveState()->GetNodeName());
+
+		TestTrue("Reached end state", Instance->IsInEndState());
+		Instance->Shutdown();
+	};
+
+	TArray<FString> BlueprintStates;
+	TArray<FString> NativeStates;
+	RunSteps(BlueprintInstance, BlueprintStates);
+	RunSteps(NativeInstance, NativeStates);
+
+	TestEqual("Blueprint ran as expected", BlueprintStates, TArray<FString>({ TEXT("A"), TEXT("A"), TEXT("B"), TEXT("C") }));
+	TestEqual("Native class matches the blueprint", NativeStates, BlueprintStates);
+
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Graphs which can't be converted fail the export unless they are allowed as blueprint events of an abstract class.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNativeExportUnconvertedGraphsTest, "SMTests.NativeExportUnconvertedGraphs", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FNativeExportUnconvertedGraphsTest::RunTest(const FString& Parameters)
+{
+	// States and transitions call into the context.
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, 2) || !TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	FSMNativeCodeGenerator::FOptions Options;
+	Options.ClassName = TEXT("SMTestUnconvertedInstance");
+
+	{
+		FSMNativeCodeGenerator::FResult Result;
+		FString Error;
+		TestFalse("Export refused", FSMNativeCodeGenerator::Generate(NewBP, Options, Result, Error));
+		TestTrue("Reason reported", Error.Contains(TEXT("can't be converted")));
+		TestTrue("Graphs named", Error.Contains(TEXT("GraphEvaluator")));
+		TestTrue("Nothing generated", Result.HeaderText.IsEmpty() && Result.SourceText.IsEmpty());
+	}
+
+	{
+		Options.bAllowBlueprintImplementedGraphs = true;
+
+		FSMNativeCodeGenerator::FResult Result;
+		FString Error;
+		TestTrue("Export allowed", FSMNativeCodeGenerator::Generate(NewBP, Options, Result, Error));
+		TestTrue("Graphs left to a blueprint subclass", Result.BlueprintFunctions.Num() > 0);
+		TestTrue("Abstract class", Result.HeaderText.Contains(TEXT("\nUCLASS(Abstract, Blueprintable)\n")));
+
+		for (const FString& Function : Result.BlueprintFunctions)
+		{
+			TestTrue(FString::Printf(TEXT("Event %s declared"), *Function), Result.HeaderText.Contains(Function + TEXT("();")));
+		}
+	}
+
+	return NewAsset.DeleteAsset(this);
+}
+
+#endif
+
+#endif //WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -13,6 +13,9 @@
 #include "Graph/Nodes/SMGraphNode_TransitionEdge.h"
 #include "Graph/Nodes/SMGraphNode_StateMachineStateNode.h"
 #include "Graph/Nodes/SMGraphNode_ConduitNode.h"
+#include "SMNodeStructInstance.h"
+#include "SMUtils.h"
+#include "Misc/ScopeExit.h"
 
 
 #if WITH_DEV_AUTOMATION_TESTS
@@ -461,6 +464,199 @@ IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStateMachineClassInstanceReferenceTest, "SMTes
 	return true;
 }
 
+/** Counts callbacks for FNodeStructInstanceTest. */
+struct FSMStateTestStruct : public FSMNodeStructInstance
+{
+	static int32 NumBegun;
+	static int32 NumUpdated;
+	static int32 NumEnded;
+	static int32 NumDestroyed;
+	static int32 NumConstructed;
+
+	FSMStateTestStruct() { NumConstructed++; }
+	virtual ~FSMStateTestStruct() override { NumDestroyed++; }
+	virtual void OnStateBegin(FSMState_Base& State) override { NumBegun++; }
+	virtual void OnStateUpdate(FSMState_Base& State, float DeltaSeconds) override { NumUpdated++; }
+	virtual void OnStateEnd(FSMState_Base& State) override { NumEnded++; }
+};
+
+int32 FSMStateTestStruct::NumBegun = 0;
+int32 FSMStateTestStruct::NumUpdated = 0;
+int32 FSMStateTestStruct::NumEnded = 0;
+int32 FSMStateTestStruct::NumDestroyed = 0;
+int32 FSMStateTestStruct::NumConstructed = 0;
+
+/**
+ * Run a state machine with node classes registered to native struct instances.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNodeStructInstanceTest, "SMTests.NodeStructInstance", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FNodeStructInstanceTest::RunTest(const FString& Parameters)
+{
+	// Total states to test.
+	const int32 TotalStates = 3;
+
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, TotalStates, nullptr, USMStateTestStructInstance::StaticClass()))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	FSMNodeStructRegistry::Register<FSMStateTestStruct>(USMStateTestStructInstance::StaticClass());
+	ON_SCOPE_EXIT
+	{
+		FSMNodeStructRegistry::Unregister(USMStateTestStructInstance::StaticClass());
+	};
+	FSMStateTestStruct::NumBegun = FSMStateTestStruct::NumUpdated = FSMStateTestStruct::NumEnded = FSMStateTestStruct::NumDestroyed = 0;
+	
+	int32 EntryHits, UpdateHits, EndHits;
+	USMInstance* Instance = TestHelpers::RunStateMachineToCompletion(this, NewBP, EntryHits, UpdateHits, EndHits, 1000, false);
+
+	TestEqual("Every state began", FSMStateTestStruct::NumBegun, TotalStates);
+	TestTrue("States updated", FSMStateTestStruct::NumUpdated > 0);
+	TestEqual("Every state but the end state ended", FSMStateTestStruct::NumEnded, TotalStates - 1);
+
+	FSMState_Base* ActiveState = Instance->GetRootStateMachine().GetSingleActiveState();
+	TestNotNull("Struct instance created", ActiveState->GetNodeStructInstance());
+	TestNull("Node instance not created", ActiveState->GetNodeInstance());
+
+	Instance->Shutdown();
+	TestEqual("Struct instances destroyed on shutdown", FSMStateTestStruct::NumDestroyed, TotalStates);
+	TestNull("Struct instance released on shutdown", ActiveState->GetNodeStructInstance());
+	
+	FSMNodeStructRegistry::Unregister(USMStateTestStructInstance::StaticClass());
+
+	// Without registration the class is created as a node instance again.
+	Instance = TestHelpers::RunStateMachineToCompletion(this, NewBP, EntryHits, UpdateHits, EndHits, 1000, false, true, false);
+	ActiveState = Instance->GetRootStateMachine().GetSingleActiveState();
+	TestNull("Struct instance not created", ActiveState->GetNodeStructInstance());
+	TestNotNull("Node instance created", Cast<USMStateTestStructInstance>(ActiveState->GetNodeInstance()));
+	Instance->Shutdown();
+	
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Initialize, shutdown and initialize an instance again, checking runtime containers are sized once and struct instances are released.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInstanceContainerLifetimeTest, "SMTests.InstanceContainerLifetime", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FInstanceContainerLifetimeTest::RunTest(const FString& Parameters)
+{
+	// Total states to test.
+	const int32 TotalStates = 3;
+	const int32 TotalTransitions = TotalStates - 1;
+
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, TotalStates, nullptr, USMStateTestStructInstance::StaticClass())
+		|| !TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	FSMNodeStructRegistry::Register<FSMStateTestStruct>(USMStateTestStructInstance::StaticClass());
+	ON_SCOPE_EXIT
+	{
+		FSMNodeStructRegistry::Unregister(USMStateTestStructInstance::StaticClass());
+	};
+	FSMStateTestStruct::NumConstructed = FSMStateTestStruct::NumDestroyed = 0;
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+
+	for (int32 Pass = 0; Pass < 2; ++Pass)
+	{
+		if (Pass > 0)
+		{
+			Instance->Initialize(Context);
+		}
+
+		const FSMStateMachine& RootStateMachine = Instance->GetRootStateMachine();
+		TestEqual("States added once", RootStateMachine.GetStates().Num(), TotalStates);
+		TestEqual("States allocated once", RootStateMachine.GetStates().Max(), TotalStates);
+		TestEqual("Transitions allocated once", RootStateMachine.GetTransitions().Max(), TotalTransitions);
+
+		const FSMState_Base* FirstState = RootStateMachine.GetStates()[0];
+		TestEqual("Outgoing transitions allocated once", FirstState->GetOutgoingTransitions().Max(), FirstState->GetOutgoingTransitions().Num());
+		
+		// States, transitions and the root.
+		TestEqual("Node map built", Instance->GetNodeMap().Num(), TotalStates + TotalTransitions + 1);
+		TestEqual("Struct instances constructed", FSMStateTestStruct::NumConstructed, TotalStates * (Pass + 1));
+
+		Instance->Start();
+		TestNotNull("Struct instance active", Instance->GetSingleActiveState()->GetNodeStructInstance());
+		
+		Instance->Shutdown();
+		TestEqual("Node map emptied", Instance->GetNodeMap().Num(), 0);
+		TestEqual("Struct instances destroyed", FSMStateTestStruct::NumDestroyed, TotalStates * (Pass + 1));
+	}
+	
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Check the class template cache is rebuilt from the new class default object after a recompile.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTemplateCacheRecompileTest, "SMTests.TemplateCacheRecompile", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FTemplateCacheRecompileTest::RunTest(const FString& Parameters)
+{
+	FAssetHandler NewAsset;
+	UEdGraphPin* LastStatePin = nullptr;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, 1, &LastStatePin, USMStateTestInstance::StaticClass()))
+	{
+		return false;
+	}
+
+	if (!TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+	UClass* GeneratedClass = NewBP->GetGeneratedClass();
+
+	UObject* OriginalTemplate = nullptr;
+	{
+		USMTestContext* Context = NewObject<USMTestContext>();
+		USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+		TestTrue("Templates cached after the instance initialized", USMUtils::IsTemplateCached(GeneratedClass));
+
+		FSMState_Base* State = Instance->GetRootStateMachine().GetSingleInitialState();
+		OriginalTemplate = USMUtils::FindTemplateFromInstance(Instance, State->GetTemplateName());
+		TestTrue("Template found", OriginalTemplate && OriginalTemplate->GetClass() == USMStateTestInstance::StaticClass());
+		Instance->Shutdown();
+	}
+
+	USMGraphNode_StateNodeBase* StateNode = CastChecked<USMGraphNode_StateNodeBase>(LastStatePin->GetOwningNode());
+	StateNode->SetNodeClass(USMStateTestInstance2::StaticClass());
+	FKismetEditorUtilities::CompileBlueprint(NewBP);
+	GeneratedClass = NewBP->GetGeneratedClass();
+	TestFalse("Templates of the previous class default object not used", USMUtils::IsTemplateCached(GeneratedClass));
+
+	{
+		USMTestContext* Context = NewObject<USMTestContext>();
+		USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+		TestTrue("Templates cached again", USMUtils::IsTemplateCached(GeneratedClass));
+
+		FSMState_Base* State = Instance->GetRootStateMachine().GetSingleInitialState();
+		UObject* RecompiledTemplate = USMUtils::FindTemplateFromInstance(Instance, State->GetTemplateName());
+		TestNotEqual("Previous template not returned", RecompiledTemplate, OriginalTemplate);
+		TestTrue("Recompiled template found", RecompiledTemplate && RecompiledTemplate->GetClass() == USMStateTestInstance2::StaticClass());
+		TestTrue("Node instance created from the recompiled template", Cast<USMStateTestInstance2>(State->GetNodeInstance()) != nullptr);
+		Instance->Shutdown();
+	}
+
+	return NewAsset.DeleteAsset(this);
+}
+
 #endif
 
 #endif //WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
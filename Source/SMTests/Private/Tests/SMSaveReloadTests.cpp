@@ -268,6 +268,12 @@ bool TestSaveStateMachineState(FAutomationTestBase* Test, bool bCreateReferences
 
 			Test->TestEqual("All nested references found", AllReferences.Num(), bReuseReferences ? GeneratedReferenceClasses.Num() : TotalReferences);
 
+			// References are created before their owner is assigned its own owner.
+			for (USMInstance* Ref : AllReferences)
+			{
+				Test->TestEqual("Nested reference finds master owner", Ref->GetMasterReferenceOwner(), StateMachineInstance);
+			}
+
 			AllReferences = StateMachineInstance->GetAllReferencedInstances(false);
 			Test->TestEqual("Direct references", AllReferences.Num(), bReuseReferences ? 1 : 2);
 
@@ -3,10 +3,12 @@
 #include "SMTestHelpers.h"
 #include "Factory/SMBlueprintFactory.h"
 #include "Utilities/SMBlueprintEditorUtils.h"
+#include "Config/SMProjectEditorSettings.h"
 #include "SMTestContext.h"
 #include "EdGraph/EdGraph.h"
 #include "Graph/SMConduitGraph.h"
 #include "Kismet2/KismetEditorUtilities.h"
+#include "Kismet2/CompilerResultsLog.h"
 #include "Graph/SMGraph.h"
 #include "Graph/SMStateGraph.h"
 #include "Graph/Nodes/RootNodes/SMGraphK2Node_StateMachineSelectNode.h"
@@ -20,6 +22,7 @@
 #include "Graph/Nodes/RootNodes/SMGraphK2Node_TransitionInitializedNode.h"
 #include "Graph/Nodes/RootNodes/SMGraphK2Node_TransitionShutdownNode.h"
 #include "Graph/Nodes/RootNodes/SMGraphK2Node_TransitionEnteredNode.h"
+#include "Misc/ScopeExit.h"
 
 
 #if WITH_DEV_AUTOMATION_TESTS
@@ -216,7 +219,15 @@ IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConduitTest, "SMTests.Conduit", EAutomationTes
 	Graph = CastChecked<USMConduitGraph>(NextConduitNode->GetBoundGraph());
 	CanEvalPin = Graph->ResultNode->GetInputPin();
 	CanEvalPin->DefaultValue = "True";
-	TestHelpers::RunStateMachineToCompletion(this, NewBP, EntryHits, UpdateHits, EndHits, MaxIterations, true, true);
+	Instance = TestHelpers::RunStateMachineToCompletion(this, NewBP, EntryHits, UpdateHits, EndHits, MaxIterations, true, true);
+
+	// Constant conduits don't need their graph and the chain through both conduits is cached on the first state.
+	{
+		FSMState_Base* InitialState = Instance->GetRootStateMachine().GetSingleInitialState();
+		FSMConduit* FirstConduit = (FSMConduit*)InitialState->GetOutgoingTransitions()[0]->GetToState();
+		TestEqual("Conduit evaluation type is always true", FirstConduit->ConditionalEvaluationType, ESMConditionalEvaluationType::SM_AlwaysTrue);
+		TestEqual("Transition chain includes both conduits", InitialState->GetAllTransitionChains().Num(), 3);
+	}
 
 	// Test with evaluation disabled.
 	NextConduitNode->GetNodeTemplateAs<USMConduitInstance>()->bCanEvaluate = false;
@@ -461,6 +472,111 @@ bool FAnyStateTest::RunTest(const FString& Parameters)
 	return true;
 }
 
+/**
+ * Compile Any State transitions as global transitions evaluated by the state machine instead of copies per state.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAnyStateGlobalTransitionsTest, "SMTests.AnyStateGlobalTransitions", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+bool FAnyStateGlobalTransitionsTest::RunTest(const FString& Parameters)
+{
+	FAssetHandler NewAsset;
+	UEdGraphPin* LastStatePin = nullptr;
+	USMGraph* StateMachineGraph = TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, 2, &LastStatePin);
+	if (!StateMachineGraph)
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	USMGraphNode_StateNodeBase* LastNormalState = CastChecked<USMGraphNode_StateNodeBase>(LastStatePin->GetOwningNode());
+	LastNormalState->GetNodeTemplateAs<USMStateInstance_Base>()->bExcludeFromAnyState = false;
+	
+	FGraphNodeCreator<USMGraphNode_AnyStateNode> AnyStateNodeCreator(*StateMachineGraph);
+	USMGraphNode_AnyStateNode* AnyState = AnyStateNodeCreator.CreateNode();
+	AnyStateNodeCreator.Finalize();
+
+	const FString AnyStateTargetName = "AnyState_Target";
+	{
+		UEdGraphPin* InputPin = AnyState->GetOutputPin();
+		TestHelpers::BuildLinearStateMachine(this, StateMachineGraph, 1, &InputPin);
+		AnyState->GetNextNode()->GetBoundGraph()->Rename(*AnyStateTargetName, nullptr, REN_DontCreateRedirectors);
+	}
+
+	USMGraphNode_TransitionEdge* TransitionEdge = AnyState->GetNextTransition();
+	TransitionEdge->GetNodeTemplateAs<USMTransitionInstance>()->PriorityOrder = 1;
+
+	USMProjectEditorSettings* ProjectEditorSettings = FSMBlueprintEditorUtils::GetMutableProjectEditorSettings();
+	const bool bOriginalCompileAnyStateAsGlobalTransitions = ProjectEditorSettings->bCompileAnyStateAsGlobalTransitions;
+	ON_SCOPE_EXIT
+	{
+		ProjectEditorSettings->bCompileAnyStateAsGlobalTransitions = bOriginalCompileAnyStateAsGlobalTransitions;
+	};
+
+	int32 CopiedTransitions = 0;
+	{
+		ProjectEditorSettings->bCompileAnyStateAsGlobalTransitions = false;
+		if (!TestHelpers::SaveAndCompileAsset(this, NewAsset))
+		{
+			return false;
+		}
+
+		USMTestContext* Context = NewObject<USMTestContext>();
+		USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+		CopiedTransitions = Instance->GetRootStateMachine().GetTransitions().Num();
+		TestEqual("No global transitions", Instance->GetRootStateMachine().GetGlobalTransitions().Num(), 0);
+		Instance->Shutdown();
+	}
+
+	ProjectEditorSettings->bCompileAnyStateAsGlobalTransitions = true;
+	
+	{
+		FKismetEditorUtilities::CompileBlueprint(NewBP);
+		USMTestContext* Context = NewObject<USMTestContext>();
+		USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+
+		// The linear transition and a single shared Any State transition.
+		TestEqual("Global transition compiled once", Instance->GetRootStateMachine().GetGlobalTransitions().Num(), 1);
+		TestEqual("Only one runtime Any State transition", Instance->GetRootStateMachine().GetTransitions().Num(), 2);
+		TestTrue("Fewer transitions than copying per state", Instance->GetRootStateMachine().GetTransitions().Num() < CopiedTransitions);
+		TestEqual("Global transition registered with the initial state", Instance->GetRootStateMachine().GetSingleInitialState()->GetGlobalTransitions().Num(), 1);
+
+		Instance->Start();
+		TestEqual("State machine still in initial state", Instance->GetRootStateMachine().GetSingleActiveState(), Instance->GetRootStateMachine().GetSingleInitialState());
+
+		// The state's own transition has a higher priority.
+		Instance->Update();
+		TestNotEqual("Any state transition not called", Instance->GetRootStateMachine().GetSingleActiveState()->GetNodeName(), AnyStateTargetName);
+		TestFalse("Not considered end state", Instance->IsInEndState());
+
+		// Only the global transition is left.
+		Instance->Update();
+		TestEqual("Any state transition called", Instance->GetRootStateMachine().GetSingleActiveState()->GetNodeName(), AnyStateTargetName);
+		
+		Instance->Shutdown();
+	}
+
+	TransitionEdge->GetNodeTemplateAs<USMTransitionInstance>()->PriorityOrder = -1;
+	
+	{
+		FKismetEditorUtilities::CompileBlueprint(NewBP);
+		USMTestContext* Context = NewObject<USMTestContext>();
+		USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+
+		Instance->Start();
+		TestEqual("State machine still in initial state", Instance->GetRootStateMachine().GetSingleActiveState(), Instance->GetRootStateMachine().GetSingleInitialState());
+
+		// The global transition is evaluated before the state's own transition.
+		Instance->Update();
+		TestEqual("Any state transition called", Instance->GetRootStateMachine().GetSingleActiveState()->GetNodeName(), AnyStateTargetName);
+
+		Instance->Shutdown();
+	}
+
+	return NewAsset.DeleteAsset(this);
+}
+
 /**
  * Run multiple states in parallel.
  */
@@ -669,6 +785,197 @@ IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParallelStatesTest, "SMTests.ParallelStates",
 	return NewAsset.DeleteAsset(this);
 }
 
+/**
+ * Check the active state set iterates parallel states in the order the TSet it replaced did.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParallelStatesOrderTest, "SMTests.ParallelStatesOrder", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FParallelStatesOrderTest::RunTest(const FString& Parameters)
+{
+	FAssetHandler NewAsset;
+	if (!TestHelpers::TryCreateNewStateMachineAsset(this, NewAsset, false))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+	USMGraph* StateMachineGraph = FSMBlueprintEditorUtils::GetRootStateMachineNode(NewBP)->GetStateMachineGraph();
+
+	// A -> (B, C, D) -> (...) Parallel
+	TArray<UEdGraphPin*> LastStatePins;
+	TestHelpers::BuildBranchingStateMachine(this, StateMachineGraph, 3, 3, true, &LastStatePins, true);
+
+	int32 EntryHits = 0; int32 UpdateHits = 0; int32 EndHits = 0;
+	USMInstance* Instance = TestHelpers::RunStateMachineToCompletion(this, NewBP, EntryHits, UpdateHits, EndHits, 1000, false);
+
+	const TArray<FSMState_Base*>& States = Instance->GetRootStateMachine().GetStates();
+	if (!TestTrue("Enough states to test", States.Num() > 4))
+	{
+		return false;
+	}
+
+	FSMStateSet StateSet;
+	StateSet.Init(States.Num());
+	TSet<FSMState_Base*> ExpectedSet;
+
+	// A state of another state machine has no index in this one.
+	FSMState ForeignState;
+
+	auto TestOrder = [&](const TCHAR* What)
+	{
+		TestEqual(FString::Printf(TEXT("%s: count matches TSet"), What), StateSet.Num(), ExpectedSet.Num());
+		TestTrue(FString::Printf(TEXT("%s: order matches TSet"), What), StateSet.Array() == ExpectedSet.Array());
+	};
+
+	for (int32 Idx = 0; Idx < States.Num(); ++Idx)
+	{
+		StateSet.Add(States[Idx], Idx);
+		ExpectedSet.Add(States[Idx]);
+	}
+	StateSet.Add(&ForeignState, INDEX_NONE);
+	ExpectedSet.Add(&ForeignState);
+	TestOrder(TEXT("Added"));
+
+	for (int32 Idx = 0; Idx < States.Num(); Idx += 2)
+	{
+		StateSet.Remove(States[Idx], Idx);
+		ExpectedSet.Remove(States[Idx]);
+	}
+	StateSet.Remove(&ForeignState, INDEX_NONE);
+	ExpectedSet.Remove(&ForeignState);
+	TestOrder(TEXT("Removed"));
+
+	// Freed slots are reused most recent first.
+	for (int32 Idx = States.Num() - 1; Idx >= 0; --Idx)
+	{
+		StateSet.Add(States[Idx], Idx);
+		ExpectedSet.Add(States[Idx]);
+	}
+	TestOrder(TEXT("Re-added"));
+
+	StateSet.Reset();
+	ExpectedSet.Reset();
+	TestOrder(TEXT("Reset"));
+	for (int32 Idx = 0; Idx < States.Num(); ++Idx)
+	{
+		TestFalse("State not a member after reset", StateSet.Contains(States[Idx], Idx));
+	}
+
+	StateSet.Add(States[2], 2);
+	ExpectedSet.Add(States[2]);
+	StateSet.Add(States[0], 0);
+	ExpectedSet.Add(States[0]);
+	TestOrder(TEXT("Added after reset"));
+
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Test unreachable states are found at compile time, warned about and optionally removed.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnreachableStatesTest, "SMTests.UnreachableStates", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FUnreachableStatesTest::RunTest(const FString& Parameters)
+{
+	const int32 ReachableStates = 2;
+	
+	FAssetHandler NewAsset;
+	USMGraph* StateMachineGraph = TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, ReachableStates);
+	if (!StateMachineGraph)
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	// A state with no input transitions leading to another state.
+	FGraphNodeCreator<USMGraphNode_StateNode> StateNodeCreator(*StateMachineGraph);
+	USMGraphNode_StateNode* UnreachableState = StateNodeCreator.CreateNode();
+	StateNodeCreator.Finalize();
+
+	const int32 UnreachableStates = 2;
+	UEdGraphPin* UnreachablePin = UnreachableState->GetOutputPin();
+	TestHelpers::BuildLinearStateMachine(this, StateMachineGraph, UnreachableStates - 1, &UnreachablePin);
+
+	USMProjectEditorSettings* ProjectEditorSettings = FSMBlueprintEditorUtils::GetMutableProjectEditorSettings();
+	const bool bOriginalWarnOnUnreachableStates = ProjectEditorSettings->bWarnOnUnreachableStates;
+	const bool bOriginalStripUnreachableStates = ProjectEditorSettings->bStripUnreachableStates;
+	ON_SCOPE_EXIT
+	{
+		ProjectEditorSettings->bWarnOnUnreachableStates = bOriginalWarnOnUnreachableStates;
+		ProjectEditorSettings->bStripUnreachableStates = bOriginalStripUnreachableStates;
+	};
+
+	// The warnings may also be written to the log.
+	AddExpectedError(TEXT("can never be reached from an entry state"), EAutomationExpectedErrorFlags::Contains, 0);
+	
+	auto CompileAndCountUnreachableWarnings = [&]()
+	{
+		FCompilerResultsLog Results;
+		FKismetEditorUtilities::CompileBlueprint(NewBP, EBlueprintCompileOptions::None, &Results);
+
+		int32 NumWarnings = 0;
+		for (const TSharedRef<FTokenizedMessage>& Message : Results.Messages)
+		{
+			if (Message->GetSeverity() == EMessageSeverity::Warning && Message->ToText().ToString().Contains(TEXT("can never be reached from an entry state")))
+			{
+				NumWarnings++;
+			}
+		}
+
+		return NumWarnings;
+	};
+
+	if (!NewAsset.SaveAsset(this))
+	{
+		return false;
+	}
+	
+	{
+		ProjectEditorSettings->bWarnOnUnreachableStates = false;
+		ProjectEditorSettings->bStripUnreachableStates = false;
+		TestEqual("No warnings when disabled", CompileAndCountUnreachableWarnings(), 0);
+
+		USMTestContext* Context = NewObject<USMTestContext>();
+		USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+		TestEqual("Unreachable states kept", Instance->GetRootStateMachine().GetStates().Num(), ReachableStates + UnreachableStates);
+		Instance->Shutdown();
+	}
+
+	{
+		ProjectEditorSettings->bWarnOnUnreachableStates = true;
+		TestEqual("Warned about each unreachable state", CompileAndCountUnreachableWarnings(), UnreachableStates);
+
+		USMTestContext* Context = NewObject<USMTestContext>();
+		USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+		TestEqual("Warning alone keeps unreachable states", Instance->GetRootStateMachine().GetStates().Num(), ReachableStates + UnreachableStates);
+		Instance->Shutdown();
+	}
+
+	{
+		ProjectEditorSettings->bStripUnreachableStates = true;
+		TestEqual("Warned about each removed state", CompileAndCountUnreachableWarnings(), UnreachableStates);
+
+		USMTestContext* Context = NewObject<USMTestContext>();
+		USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+		TestEqual("Unreachable states removed", Instance->GetRootStateMachine().GetStates().Num(), ReachableStates);
+		TestEqual("Unreachable transitions removed", Instance->GetRootStateMachine().GetTransitions().Num(), ReachableStates - 1);
+
+		// The editor graph is unchanged.
+		TestTrue("Editor graph keeps unreachable state", StateMachineGraph->Nodes.Contains(UnreachableState));
+
+		Instance->Start();
+		Context->bCanTransition = true;
+		Instance->Update(0.f);
+		TestTrue("Reached end state", Instance->IsInEndState());
+		Instance->Shutdown();
+	}
+
+	return NewAsset.DeleteAsset(this);
+}
+
 #endif
 
 #endif //WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -20,6 +20,9 @@
 #include "Graph/Nodes/RootNodes/SMGraphK2Node_TransitionPostEvaluateNode.h"
 #include "Graph/Nodes/RootNodes/SMGraphK2Node_TransitionEnteredNode.h"
 #include "Graph/Nodes/Helpers/SMGraphK2Node_FunctionNodes.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Misc/ScopeExit.h"
 
 
 #if WITH_DEV_AUTOMATION_TESTS
@@ -457,6 +460,71 @@ bool FTransitionEventAutoBindContextTest::RunTest(const FString& Parameters)
 	return true;
 }
 
+/**
+ * Check auto-bound transition events compiled as persistent bindings bind once for the life of the instance.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransitionEventPersistentBindingTest, "SMTests.TransitionEventsPersistentBinding", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FTransitionEventPersistentBindingTest::RunTest(const FString& Parameters)
+{
+	FAssetHandler NewAsset;
+	UEdGraphPin* LastStatePin = nullptr;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, 2, &LastStatePin))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	USMGraphNode_TransitionEdge* TransitionEdge =
+		CastChecked<USMGraphNode_TransitionEdge>(Cast<USMGraphNode_StateNode>(LastStatePin->GetOwningNode())->GetInputPin()->LinkedTo[0]->GetOwningNode());
+	TransitionEdge->GetNodeTemplateAs<USMTransitionInstance>()->bCanEvaluate = false;
+
+	TransitionEdge->DelegateOwnerInstance = ESMDelegateOwner::SMDO_Context;
+	TransitionEdge->DelegateOwnerClass = USMTestContext::StaticClass();
+	TransitionEdge->DelegatePropertyName = GET_MEMBER_NAME_CHECKED(USMTestContext, TransitionEvent);
+	TransitionEdge->InitTransitionDelegate();
+
+	USMProjectEditorSettings* ProjectEditorSettings = FSMBlueprintEditorUtils::GetMutableProjectEditorSettings();
+	const bool bOriginalPersistentBindings = ProjectEditorSettings->bPersistentTransitionEventBindings;
+	ON_SCOPE_EXIT
+	{
+		ProjectEditorSettings->bPersistentTransitionEventBindings = bOriginalPersistentBindings;
+	};
+
+	ProjectEditorSettings->bPersistentTransitionEventBindings = true;
+	if (!TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	USMInstance* Instance = TestHelpers::CreateNewStateMachineInstanceFromBP(this, NewBP, Context);
+	TestTrue("Event bound when the instance initialized", Context->TransitionEvent.IsBound());
+
+	// Shouldn't cause evaluation since the owning state isn't active.
+	Context->TransitionEvent.Broadcast();
+
+	Instance->Start();
+	Instance->Update(0.f);
+	TestEqual("State machine still in initial state", Instance->GetRootStateMachine().GetSingleActiveState(), Instance->GetRootStateMachine().GetSingleInitialState());
+	TestTrue("Event still bound after the state started", Context->TransitionEvent.IsBound());
+
+	// Should cause evaluation.
+	Context->TransitionEvent.Broadcast();
+
+	TestNotEqual("State machine switched states", Instance->GetRootStateMachine().GetSingleActiveState(), Instance->GetRootStateMachine().GetSingleInitialState());
+	TestTrue("State machine now in end state.", Instance->IsInEndState());
+	TestTrue("Event still bound after the state ended", Context->TransitionEvent.IsBound());
+
+	Instance->Shutdown();
+	TestFalse("State Machine should have stopped", Instance->IsActive());
+	TestFalse("Event unbound when the instance shutdown", Context->TransitionEvent.IsBound());
+
+	return NewAsset.DeleteAsset(this);
+}
+
 /**
  * Check transition optimization type is correct.
  */
@@ -560,6 +628,241 @@ IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransitionOptimizationTest, "SMTests.Transitio
 	return true;
 }
 
+/**
+ * Validate predicted transitions on the server and roll back a rejected prediction on the client.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPredictedTransitionTest, "SMTests.PredictedTransition", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FPredictedTransitionTest::RunTest(const FString& Parameters)
+{
+	// Total states to test.
+	const int32 TotalStates = 3;
+
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, TotalStates) || !TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	Context->bCanTransition = false;
+	
+	USMStateMachineTestComponent* Component = NewObject<USMStateMachineTestComponent>(Context);
+	Component->SetStateMachineClass(NewBP->GetGeneratedClass());
+	Component->Initialize(Context);
+	Component->Start();
+
+	USMInstance* Instance = Component->GetInstance();
+	if (!TestNotNull("Instance created", Instance))
+	{
+		return false;
+	}
+
+	FSMStateMachine& RootStateMachine = Instance->GetRootStateMachine();
+	FSMState_Base* FirstState = RootStateMachine.GetSingleActiveState();
+	FSMTransition* FirstTransition = FirstState->GetOutgoingTransitions()[0];
+	FSMTransition* SecondTransition = FirstTransition->GetToState()->GetOutgoingTransitions()[0];
+
+	FSMNetworkedTransaction FirstPrediction(RootStateMachine.GetGuid(), FirstTransition->GetGuid());
+	FirstPrediction.PredictionKey = 1;
+	FSMNetworkedTransaction SecondPrediction(RootStateMachine.GetGuid(), SecondTransition->GetGuid());
+	SecondPrediction.PredictionKey = 2;
+
+	// Server validation only checks authoritative state and never runs the condition.
+	TestTrue("Prediction accepted without running the server's condition", Component->CanAcceptPredictedTransaction_Public(FirstPrediction));
+	TestFalse("Prediction rejected when the from state isn't active", Component->CanAcceptPredictedTransaction_Public(SecondPrediction));
+	
+	FirstTransition->bAlwaysFalse = true;
+	TestFalse("Prediction rejected when the transition can never be taken", Component->CanAcceptPredictedTransaction_Public(FirstPrediction));
+	FirstTransition->bAlwaysFalse = false;
+
+	FSMNetworkedTransaction ReceivedPrediction(RootStateMachine.GetGuid(), FirstTransition->GetGuid());
+	ReceivedPrediction.PredictionKey = 1;
+	RootStateMachine.GetPreviousTransactions().Add(ReceivedPrediction.TransactionGuid, FPlatformTime::Seconds());
+	TestFalse("Prediction rejected when already received", Component->CanAcceptPredictedTransaction_Public(ReceivedPrediction));
+	
+	Context->bCanTransition = true;
+
+	// Client mispredicts both transitions.
+	Component->AddPendingPrediction_Public(FirstPrediction);
+	Component->AddPendingPrediction_Public(SecondPrediction);
+	Instance->Update(0.f);
+	TestNotEqual("Client moved past the first state", Instance->GetSingleActiveStateGuid(), FirstState->GetGuid());
+
+	// Server rejects the first, the client returns to the server's state.
+	Context->bCanTransition = false;
+	Component->RejectPredictedTransactions_Public(FirstPrediction.PredictionKey, { FirstState->GetGuid() });
+	TestEqual("Rejected predictions removed", Component->GetNumPendingPredictions(), 0);
+	TestEqual("Client rolled back to the server's state", Instance->GetSingleActiveStateGuid(), FirstState->GetGuid());
+	TestEqual("Only the server's state is active", Instance->GetAllActiveStateGuidsCopy().Num(), 1);
+
+	Component->Shutdown();
+	
+	return NewAsset.DeleteAsset(this);
+}
+
+/**
+ * Check the previous transaction history detects duplicates, expires entries and never drops an unexpired entry when full.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransactionHistoryTest, "SMTests.TransactionHistory", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FTransactionHistoryTest::RunTest(const FString& Parameters)
+{
+	const double Timeout = 2.0;
+	
+	FSMNetworkedTransactionHistory History;
+	History.SetCapacity(2);
+
+	// Duplicates.
+	const FGuid First = FGuid::NewGuid();
+	History.Add(First, 0.0);
+	TestTrue("Recorded transaction found", History.Contains(First));
+	TestFalse("Unknown transaction not found", History.Contains(FGuid::NewGuid()));
+	History.Add(First, 0.0);
+	TestEqual("Recording a transaction twice keeps one entry", History.Num(), 1);
+
+	// Expiry.
+	History.RemoveExpired(1.0, Timeout);
+	TestTrue("Transaction kept inside the timeout", History.Contains(First));
+	History.RemoveExpired(2.0, Timeout);
+	TestFalse("Transaction removed once expired", History.Contains(First));
+	TestEqual("History empty", History.Num(), 0);
+
+	// Overflow with nothing expired.
+	AddExpectedError(TEXT("Previous transaction history grew"), EAutomationExpectedErrorFlags::Contains, 0);
+	TArray<FGuid> Transactions;
+	for (int32 Idx = 0; Idx < 5; ++Idx)
+	{
+		Transactions.Add(FGuid::NewGuid());
+		History.Add(Transactions.Last(), 3.0);
+	}
+
+	TestEqual("Every transaction kept", History.Num(), Transactions.Num());
+	TestTrue("Buffer grew", History.GetCapacity() >= Transactions.Num());
+	for (const FGuid& Transaction : Transactions)
+	{
+		TestTrue("Unexpired transaction still detected as a duplicate", History.Contains(Transaction));
+	}
+
+	// Overflow with the oldest expired overwrites it instead of growing.
+	const int32 Capacity = History.GetCapacity();
+	while (History.Num() < Capacity)
+	{
+		Transactions.Add(FGuid::NewGuid());
+		History.Add(Transactions.Last(), 3.0);
+	}
+	
+	const FGuid Latest = FGuid::NewGuid();
+	History.Add(Latest, 3.0 + Timeout);
+	TestEqual("Capacity unchanged when the oldest expired", History.GetCapacity(), Capacity);
+	TestFalse("Expired transaction overwritten", History.Contains(Transactions[0]));
+	TestTrue("Newest transaction recorded", History.Contains(Latest));
+	
+	return true;
+}
+
+/**
+ * Check batched client transactions are kept per world, dropped without a server connection and released on world cleanup.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransactionBatchPerWorldTest, "SMTests.TransactionBatchPerWorld", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FTransactionBatchPerWorldTest::RunTest(const FString& Parameters)
+{
+	UWorld* FirstWorld = UWorld::CreateWorld(EWorldType::Game, false);
+	UWorld* SecondWorld = UWorld::CreateWorld(EWorldType::Game, false);
+	bool bSecondWorldDestroyed = false;
+	ON_SCOPE_EXIT
+	{
+		FirstWorld->DestroyWorld(false);
+		if (!bSecondWorldDestroyed)
+		{
+			SecondWorld->DestroyWorld(false);
+		}
+	};
+
+	auto CreateBatchingComponent = [](UWorld* World)
+	{
+		AActor* Owner = World->SpawnActor<AActor>();
+		USMStateMachineTestComponent* Component = NewObject<USMStateMachineTestComponent>(Owner);
+		Component->bBatchClientTransactions = true;
+		Component->RegisterComponent();
+		return Component;
+	};
+
+	USMStateMachineTestComponent* FirstComponent = CreateBatchingComponent(FirstWorld);
+	USMStateMachineTestComponent* SecondComponent = CreateBatchingComponent(SecondWorld);
+
+	const FSMNetworkedTransaction Transaction(FGuid::NewGuid(), FGuid::NewGuid());
+	FirstComponent->QueueTransactionsForBatch_Public({ Transaction });
+	SecondComponent->QueueTransactionsForBatch_Public({ Transaction });
+
+	TestEqual("First world has one pending component", USMStateMachineComponent::GetNumComponentsPendingBatch(FirstWorld), 1);
+	TestEqual("Second world has one pending component", USMStateMachineComponent::GetNumComponentsPendingBatch(SecondWorld), 1);
+
+	// Neither world has a server connection so flushing drops the queue instead of sending it.
+	USMStateMachineTestComponent::FlushTransactionBatches_Public(FirstWorld);
+	TestEqual("First world batch released", USMStateMachineComponent::GetNumComponentsPendingBatch(FirstWorld), 0);
+	TestEqual("First world transactions dropped", FirstComponent->GetNumQueuedBatchTransactions(), 0);
+	TestEqual("Second world batch untouched", USMStateMachineComponent::GetNumComponentsPendingBatch(SecondWorld), 1);
+	TestEqual("Second world transactions untouched", SecondComponent->GetNumQueuedBatchTransactions(), 1);
+
+	SecondWorld->DestroyWorld(false);
+	bSecondWorldDestroyed = true;
+	TestEqual("Second world batch released on cleanup", USMStateMachineComponent::GetNumComponentsPendingBatch(SecondWorld), 0);
+
+	return true;
+}
+
+/**
+ * Check the component only ticks while its instance is running when nothing overrides Tick.
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FComponentTickEnabledTest, "SMTests.ComponentTickEnabled", EAutomationTestFlags::ApplicationContextMask |
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+	bool FComponentTickEnabledTest::RunTest(const FString& Parameters)
+{
+	// Total states to test.
+	const int32 TotalStates = 2;
+
+	FAssetHandler NewAsset;
+	if (!TestHelpers::CreateLinearStateMachineAsset(this, NewAsset, TotalStates) || !TestHelpers::SaveAndCompileAsset(this, NewAsset))
+	{
+		return false;
+	}
+
+	USMBlueprint* NewBP = NewAsset.GetObjectAs<USMBlueprint>();
+
+	USMTestContext* Context = NewObject<USMTestContext>();
+	USMStateMachineTestComponent* Component = NewObject<USMStateMachineTestComponent>(Context);
+	Component->SetStateMachineClass(NewBP->GetGeneratedClass());
+	Component->Initialize(Context);
+
+	if (!TestNotNull("Instance created", Component->GetInstance()))
+	{
+		return false;
+	}
+
+	TestFalse("Tick disabled before start", Component->IsComponentTickEnabled());
+
+	Component->Start();
+	TestTrue("Tick enabled on start", Component->IsComponentTickEnabled());
+
+	Component->Stop();
+	TestFalse("Tick disabled on stop", Component->IsComponentTickEnabled());
+
+	Component->Start();
+	TestTrue("Tick enabled on restart", Component->IsComponentTickEnabled());
+
+	Component->Stop();
+
+	return NewAsset.DeleteAsset(this);
+}
+
 #endif
 
 #endif //WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file
@@ -170,6 +170,14 @@ public:
 	GENERATED_BODY()
 };
 
+/** Only assigned to nodes. Node struct tests register a native struct in its place. */
+UCLASS(Blueprintable)
+class USMStateTestStructInstance : public USMStateInstance
+{
+public:
+	GENERATED_BODY()
+};
+
 UCLASS(Blueprintable)
 class USMStateMachineTestInstance : public USMStateMachineInstance
 {
@@ -221,4 +229,12 @@ public:
 	void SetTickInterval(bool bAllowOverride, float TickInterval);
 
 	void ImportDeprecatedProperties_Public();
+
+	bool CanAcceptPredictedTransaction_Public(const FSMNetworkedTransaction& Transaction) const;
+	void AddPendingPrediction_Public(const FSMNetworkedTransaction& Transaction);
+	void RejectPredictedTransactions_Public(int32 PredictionKey, const TArray<FGuid>& AuthoritativeStates);
+	int32 GetNumPendingPredictions() const { return PendingPredictions.Num(); }
+	void QueueTransactionsForBatch_Public(const TArray<FSMNetworkedTransaction>& Transactions);
+	int32 GetNumQueuedBatchTransactions() const { return QueuedBatchTransactions.Num(); }
+	static void FlushTransactionBatches_Public(UWorld* World);
 };
\ No newline at end of file
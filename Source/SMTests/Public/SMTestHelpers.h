@@ -89,6 +89,13 @@ namespace TestHelpers
 	FAssetHandler ConstructNewStateMachineAsset();
 	bool TryCreateNewStateMachineAsset(FAutomationTestBase* Test, FAssetHandler& NewAsset, bool Save = false);
 
+	/** Create a new state machine asset and build a linear state machine in its root graph. Returns the root state machine graph or nullptr on failure. */
+	USMGraph* CreateLinearStateMachineAsset(FAutomationTestBase* Test, FAssetHandler& NewAsset, int32 NumStates, UEdGraphPin** LastStatePinOut = nullptr,
+		UClass* StateClass = nullptr, UClass* TransitionClass = nullptr);
+
+	/** Save the asset and compile its blueprint. */
+	bool SaveAndCompileAsset(FAutomationTestBase* Test, FAssetHandler& NewAsset);
+
 #pragma region Node Helpers
 
 	/** Creates a context getter for SMInstance within the given graph. */
@@ -0,0 +1,47 @@
+// Copyright Recursoft LLC 2019-2020. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SMInstance.h"
+#include "SMState.h"
+#include "SMTransition.h"
+#include "SMTestNativeInstance.generated.h"
+
+/**
+ * Hand written in the form FSMNativeCodeGenerator emits for the state machine built by SMTests.NativeExport.
+ * Runs next to that blueprint to check an exported class behaves the same. Update it when the generator output changes.
+ */
+UCLASS(Blueprintable)
+class USMTestNativeInstance : public USMInstance
+{
+	GENERATED_BODY()
+
+public:
+	USMTestNativeInstance();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "State Machine")
+	bool bCanAdvance;
+
+protected:
+	UFUNCTION()
+	void Transition_A_to_B_Evaluate();
+
+	UFUNCTION()
+	void Transition_B_to_C_Evaluate();
+
+private:
+	UPROPERTY()
+	FSMState State_A;
+
+	UPROPERTY()
+	FSMState State_B;
+
+	UPROPERTY()
+	FSMState State_C;
+
+	UPROPERTY()
+	FSMTransition Transition_A_to_B;
+
+	UPROPERTY()
+	FSMTransition Transition_B_to_C;
+};